@@ -8,12 +8,44 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <sybdb.h>
 
 #include "FreeTDSWrapper.h"
 
-static char lastErrorMessage[1024] = "";
-static char lastServerMessage[1024] = "";
+// Errors raised before a connection has its state (during login) land here. A
+// login runs start to finish on one thread, so keeping these per thread gives
+// each concurrent login its own error text.
+static _Thread_local char lastErrorMessage[1024] = "";
+static _Thread_local char lastServerMessage[1024] = "";
+
+// Per-connection state, attached with dbsetuserdata.
+typedef struct {
+    atomic_int cancelRequested;
+    char lastError[1024];         // latest DB-Library error on this connection
+    char lastServerMessage[1024]; // latest server error (severity >= 11) on this connection
+    int inResultSet; // fetchNextRow is part way through a result set
+    int captureMessages; // collect informational messages into captured
+    char* captured;      // NUL-terminated "msgno\ttext" records
+    size_t capturedLength;
+    size_t capturedCapacity;
+    TdsMessageSink messageSink; // receives every server message, or NULL
+    void* messageContext;
+    TdsColumnInfo* schema; // layout of the latest result set, see resultSchema
+    int schemaColumns;
+    int schemaCapacity;
+    int resultSetOrdinal;
+} ConnectionState;
+
+static ConnectionState* connectionState(DBPROCESS* dbproc) {
+    return (ConnectionState*)dbgetuserdata(dbproc);
+}
+
+static void deliverMessage(DBPROCESS* dbproc, DBINT msgno, int msgstate, int severity,
+                           const char* msgtext, const char* procname, int line);
 
 // Message handler to capture detailed SQL Server error messages.
 static int messageHandler(DBPROCESS *dbproc, DBINT msgno, int msgstate, int severity,
@@ -21,14 +53,21 @@ static int messageHandler(DBPROCESS *dbproc, DBINT msgno, int msgstate, int seve
     // Severity >= 11 means an actual error (not informational).
     // Store in a separate buffer so errorHandler can't overwrite it.
     if (severity >= 11) {
-        snprintf(lastServerMessage, sizeof(lastServerMessage),
+        ConnectionState* state = dbproc != NULL ? connectionState(dbproc) : NULL;
+        char* buffer = state != NULL ? state->lastServerMessage : lastServerMessage;
+        snprintf(buffer, sizeof(lastServerMessage),
                  "Msg %ld, Level %d, State %d, Line %d: %s",
                  (long)msgno, severity, msgstate, line, msgtext);
     }
+    if (dbproc != NULL) {
+        deliverMessage(dbproc, msgno, msgstate, severity, msgtext, procname, line);
+    }
     return 0;
 }
 static int errorHandler(DBPROCESS *dbproc, int severity, int dberr, int oserr, char *dberrstr, char *oserrstr) {
-    snprintf(lastErrorMessage, sizeof(lastErrorMessage), "DB-Lib error %d (severity %d): %s [%s]", dberr, severity, dberrstr, oserrstr ? oserrstr : "no os error");
+    ConnectionState* state = dbproc != NULL ? connectionState(dbproc) : NULL;
+    char* buffer = state != NULL ? state->lastError : lastErrorMessage;
+    snprintf(buffer, sizeof(lastErrorMessage), "DB-Lib error %d (severity %d): %s [%s]", dberr, severity, dberrstr, oserrstr ? oserrstr : "no os error");
     return INT_CANCEL;
 }
 
@@ -40,35 +79,181 @@ const char* getLastTdsErrorMessage(void) {
     return lastErrorMessage;
 }
 
+const char* getConnectionErrorMessage(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state == NULL) return getLastTdsErrorMessage();
+    if (state->lastServerMessage[0] != '\0') { return state->lastServerMessage; }
+    return state->lastError;
+}
+
+// Record an error the wrapper itself detected, such as a cancelled fetch.
+static void setConnectionError(DBPROCESS* dbproc, const char* message) {
+    ConnectionState* state = connectionState(dbproc);
+    char* buffer = state != NULL ? state->lastError : lastErrorMessage;
+    snprintf(buffer, sizeof(lastErrorMessage), "%s", message);
+}
+
+static void clearConnectionErrors(ConnectionState* state) {
+    state->lastServerMessage[0] = '\0';
+    state->lastError[0] = '\0';
+}
+
+static void captureMessage(ConnectionState* state, DBINT msgno, const char* msgtext) {
+    char number[24];
+    int numberLength = snprintf(number, sizeof number, "%ld\t", (long)msgno);
+    size_t textLength = msgtext ? strlen(msgtext) : 0;
+    size_t needed = state->capturedLength + (size_t)numberLength + textLength + 1;
+    if (needed > state->capturedCapacity) {
+        size_t capacity = state->capturedCapacity ? state->capturedCapacity : 1024;
+        while (capacity < needed) capacity *= 2;
+        char* grown = realloc(state->captured, capacity);
+        if (grown == NULL) return;
+        state->captured = grown;
+        state->capturedCapacity = capacity;
+    }
+    char* end = state->captured + state->capturedLength;
+    memcpy(end, number, (size_t)numberLength);
+    if (textLength) memcpy(end + numberLength, msgtext, textLength);
+    end[numberLength + textLength] = '\0';
+    state->capturedLength = needed;
+}
+
+static void deliverMessage(DBPROCESS* dbproc, DBINT msgno, int msgstate, int severity,
+                           const char* msgtext, const char* procname, int line) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state == NULL) return;
+    if (severity < 11 && state->captureMessages) {
+        captureMessage(state, msgno, msgtext);
+    }
+    if (state->messageSink != NULL) {
+        TdsServerMessage message = {
+            .number = (long)msgno,
+            .severity = severity,
+            .state = msgstate,
+            .line = line,
+            .text = msgtext,
+            .procedure = procname,
+        };
+        state->messageSink(state->messageContext, &message);
+    }
+}
+
+void setMessageSink(DBPROCESS* dbproc, TdsMessageSink sink, void* context) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state == NULL) return;
+    state->messageSink = sink;
+    state->messageContext = context;
+}
+
+void setMessageCapture(DBPROCESS* dbproc, int enabled) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state == NULL) return;
+    state->captureMessages = enabled;
+    state->capturedLength = 0;
+    if (!enabled) {
+        free(state->captured);
+        state->captured = NULL;
+        state->capturedCapacity = 0;
+    }
+}
+
+const char* capturedMessages(DBPROCESS* dbproc, size_t* length) {
+    ConnectionState* state = connectionState(dbproc);
+    *length = state != NULL ? state->capturedLength : 0;
+    return state != NULL ? state->captured : NULL;
+}
+
+// DB-Library polls this about once a second while waiting on the server.
+static int checkInterrupt(void* dbproc) {
+    ConnectionState* state = connectionState((DBPROCESS*)dbproc);
+    return state != NULL && atomic_load(&state->cancelRequested);
+}
+
+static int handleInterrupt(void* dbproc) {
+    return INT_CANCEL;
+}
+
+void requestCancel(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state != NULL) atomic_store(&state->cancelRequested, 1);
+}
+
+void clearCancelRequest(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state != NULL) atomic_store(&state->cancelRequested, 0);
+}
+
+int isCancelRequested(DBPROCESS* dbproc) {
+    return checkInterrupt(dbproc);
+}
+
 const char* getDBVersion(void) {
     return dbversion();
 }
 
+static pthread_once_t libraryOnce = PTHREAD_ONCE_INIT;
+static int libraryStatus = -1;
+
+// dbinit and the handlers are process-wide; set them up once.
+static void setUpLibrary(void) {
+    if (dbinit() == FAIL) return;
+    dberrhandle(errorHandler);
+    dbmsghandle(messageHandler);
+    libraryStatus = 0;
+}
+
 // Initialize DB-Library
 int initializeDBLibrary(void) {
-    return dbinit() == SUCCEED ? 0 : -1;
+    pthread_once(&libraryOnce, setUpLibrary);
+    return libraryStatus;
+}
+
+// dbsetlogintime is process-wide too, and dbopen reads it. Logins with the timeout
+// currently set share the read lock and proceed in parallel; one that needs a
+// different timeout waits for them before changing it.
+static pthread_rwlock_t loginTimeoutLock = PTHREAD_RWLOCK_INITIALIZER;
+static int loginTimeout = -1;
+
+static void lockLoginTimeout(int timeout) {
+    while (1) {
+        pthread_rwlock_rdlock(&loginTimeoutLock);
+        if (loginTimeout == timeout) return;
+        pthread_rwlock_unlock(&loginTimeoutLock);
+        pthread_rwlock_wrlock(&loginTimeoutLock);
+        if (loginTimeout != timeout) {
+            dbsetlogintime(timeout);
+            loginTimeout = timeout;
+        }
+        pthread_rwlock_unlock(&loginTimeoutLock);
+    }
 }
 
 // Connect to the database
-DBPROCESS* connectToDatabase(const char* server, const char* user, const char* password, const char* database, const int timeout) {
+DBPROCESS* connectToDatabase(const char* server, const char* user, const char* password, const char* database, const int timeout, const char* charset) {
     LOGINREC *login;
     DBPROCESS *dbproc;
 
     lastServerMessage[0] = '\0';
     lastErrorMessage[0] = '\0';
-    dbinit();
+    if (initializeDBLibrary() != 0) {
+        return NULL;
+    }
     login = dblogin();
     if (login == NULL) {
         return NULL;
     }
-    dbsetlogintime(timeout);
-    
+
     DBSETLUSER(login, user);
     DBSETLPWD(login, password);
     DBSETLAPP(login, "FreeTDSWrapper");
-    dberrhandle(errorHandler);
-    dbmsghandle(messageHandler);
+    // Ask the server to send text in the client charset. When it already matches
+    // the server's charset FreeTDS copies bytes through without iconv.
+    if (charset != NULL && charset[0] != '\0') {
+        DBSETLCHARSET(login, charset);
+    }
+    lockLoginTimeout(timeout);
     dbproc = dbopen(login, server);
+    pthread_rwlock_unlock(&loginTimeoutLock);
     dbloginfree(login);
     if (dbproc == NULL) {
         return NULL;
@@ -77,13 +262,25 @@ DBPROCESS* connectToDatabase(const char* server, const char* user, const char* p
         dbclose(dbproc);
         return NULL;
     }
+    ConnectionState* state = calloc(1, sizeof(ConnectionState));
+    if (state == NULL) {
+        dbclose(dbproc);
+        return NULL;
+    }
+    dbsetuserdata(dbproc, (BYTE*)state);
+    dbsetinterrupt(dbproc, checkInterrupt, handleInterrupt);
     return dbproc;
 }
 
 // Execute a query
 int executeQuery(DBPROCESS* dbproc, const char* query) {
-    lastServerMessage[0] = '\0';
-    lastErrorMessage[0] = '\0';
+    ConnectionState* state = connectionState(dbproc);
+    if (state != NULL) {
+        clearConnectionErrors(state);
+        state->inResultSet = 0;
+        state->schemaColumns = 0;
+        state->resultSetOrdinal = 0;
+    }
     if (dbcmd(dbproc, query) == FAIL) {
         return -1;
     }
@@ -93,6 +290,254 @@ int executeQuery(DBPROCESS* dbproc, const char* query) {
     return 0;
 }
 
+// Allocate the per-column arrays of a row. Returns -1 (with nothing left allocated)
+// on failure.
+static int allocateRow(RowData* row, int ncols) {
+    size_t slots = ncols > 0 ? (size_t)ncols : 1;
+    row->columnCount = ncols;
+    row->columnNames = malloc(slots * sizeof(char*));
+    row->columnValues = malloc(slots * sizeof(char*));
+    row->columnTypes = malloc(slots * sizeof(int));
+    row->columnLengths = malloc(slots * sizeof(int));
+    row->nullBitmap = calloc((slots + 7) / 8, 1);
+    if (!row->columnNames || !row->columnValues || !row->columnTypes
+        || !row->columnLengths || !row->nullBitmap) {
+        free(row->columnNames);
+        free(row->columnValues);
+        free(row->columnTypes);
+        free(row->columnLengths);
+        free(row->nullBitmap);
+        return -1;
+    }
+    return 0;
+}
+
+// Render a date or time value as the text the Swift decoders parse: "YYYY-MM-DD",
+// "HH:MM:SS", "YYYY-MM-DD HH:MM" (smalldatetime), "YYYY-MM-DD HH:MM:SS.fffffff" in
+// 100ns ticks (datetime, datetime2) or "YYYY-MM-DD HH:MM:SS +hh:mm" (datetimeoffset,
+// in its own offset). Returns the length, or -1 if the value is malformed.
+static int formatTemporal(int type, const BYTE* data, int length, char* out, size_t size) {
+    const long long ticksPerDay = 864000000000LL;
+    long long days;  // since 1900-01-01
+    long long ticks; // 100ns since midnight
+    int offset = 0;  // minutes east of UTC
+    switch (type) {
+        case SYBDATETIME: {
+            DBDATETIME v;
+            if (length < (int)sizeof v) return -1;
+            memcpy(&v, data, sizeof v);
+            days = v.dtdays;
+            // dttime counts 1/300 s; round to milliseconds as the server does.
+            ticks = ((long long)v.dttime * 10 + 1) / 3 * 10000;
+            break;
+        }
+        case SYBDATETIME4: {
+            DBDATETIME4 v;
+            if (length < (int)sizeof v) return -1;
+            memcpy(&v, data, sizeof v);
+            days = v.days;
+            ticks = (long long)v.minutes * 600000000LL;
+            break;
+        }
+        case SYBMSDATE:
+        case SYBMSTIME:
+        case SYBMSDATETIME2:
+        case SYBMSDATETIMEOFFSET: {
+            DBDATETIMEALL v;
+            if (length < (int)sizeof v) return -1;
+            memcpy(&v, data, sizeof v);
+            days = v.date;
+            ticks = (long long)v.time;
+            if (type == SYBMSDATETIMEOFFSET) {
+                // The value arrives in UTC; show it at its own offset.
+                offset = v.offset;
+                ticks += (long long)offset * 600000000LL;
+                long long shift = ticks >= 0 ? ticks / ticksPerDay : -((-ticks + ticksPerDay - 1) / ticksPerDay);
+                days += shift;
+                ticks -= shift * ticksPerDay;
+            }
+            break;
+        }
+        default:
+            return -1;
+    }
+    if (ticks < 0 || ticks >= ticksPerDay) return -1;
+
+    // Civil date from days since 1970-01-01 (Howard Hinnant's algorithm).
+    long long z = days - 25567 + 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    long long dayOfEra = z - era * 146097;
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long long mp = (5 * dayOfYear + 2) / 153;
+    int day = (int)(dayOfYear - (153 * mp + 2) / 5 + 1);
+    int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int year = (int)(yearOfEra + era * 400 + (month <= 2));
+
+    long long seconds = ticks / 10000000;
+    int hour = (int)(seconds / 3600), minute = (int)(seconds / 60 % 60), second = (int)(seconds % 60);
+    int fraction = (int)(ticks % 10000000);
+
+    int n;
+    switch (type) {
+        case SYBMSDATE:
+            n = snprintf(out, size, "%04d-%02d-%02d", year, month, day);
+            break;
+        case SYBMSTIME:
+            n = snprintf(out, size, "%02d:%02d:%02d", hour, minute, second);
+            break;
+        case SYBDATETIME4:
+            n = snprintf(out, size, "%04d-%02d-%02d %02d:%02d", year, month, day, hour, minute);
+            break;
+        case SYBMSDATETIMEOFFSET: {
+            int magnitude = offset < 0 ? -offset : offset;
+            n = snprintf(out, size, "%04d-%02d-%02d %02d:%02d:%02d %c%02d:%02d", year, month, day,
+                         hour, minute, second, offset < 0 ? '-' : '+', magnitude / 60, magnitude % 60);
+            break;
+        }
+        default:
+            n = snprintf(out, size, "%04d-%02d-%02d %02d:%02d:%02d.%07d", year, month, day,
+                         hour, minute, second, fraction);
+            break;
+    }
+    return n >= 0 && (size_t)n < size ? n : -1;
+}
+
+// Store one cell. data == NULL is SQL NULL: flag it and leave the value unallocated.
+// Numeric columns are rendered as text; everything else keeps its raw bytes, so
+// binary values may contain NULs and the length is authoritative. Decimal and money
+// values go through dbconvert, which writes every digit of the value's own scale;
+// dates and times are written by formatTemporal.
+static void fillCell(DBPROCESS* dbproc, RowData* row, int index, const char* name, int type,
+                     const BYTE* data, int dataLength) {
+    char* value;
+    int valueLength = 0;
+
+    row->columnNames[index] = name ? strdup(name) : NULL;
+    row->columnTypes[index] = type;
+    if (data == NULL) {
+        row->nullBitmap[index >> 3] |= (unsigned char)(1u << (index & 7));
+        value = NULL;
+    } else if (dataLength > 0) {
+        char number[64];
+        int n = -1;
+        switch (type) {
+            case SYBINT1: { DBTINYINT v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%u", (unsigned)v); break; }
+            case SYBINT2: { DBSMALLINT v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%d", (int)v); break; }
+            case SYBINT4: { DBINT v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%d", (int)v); break; }
+            case SYBINT8: { DBBIGINT v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%lld", (long long)v); break; }
+            case SYBFLT8: { DBFLT8 v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%.17g", v); break; }
+            case SYBREAL: { DBREAL v; memcpy(&v, data, sizeof v); n = snprintf(number, sizeof number, "%.9g", (double)v); break; }
+            case SYBDECIMAL:
+            case SYBNUMERIC:
+            case SYBMONEY:
+            case SYBMONEY4:
+                n = dbconvert(dbproc, type, data, dataLength, SYBCHAR, (BYTE*)number, (DBINT)sizeof number - 1);
+                if (n > (int)sizeof number - 1) n = -1;
+                break;
+            case SYBDATETIME:
+            case SYBDATETIME4:
+            case SYBMSDATE:
+            case SYBMSTIME:
+            case SYBMSDATETIME2:
+            case SYBMSDATETIMEOFFSET:
+                n = formatTemporal(type, data, dataLength, number, sizeof number);
+                break;
+            default: break;
+        }
+        const void* source = n >= 0 ? (const void*)number : (const void*)data;
+        valueLength = n >= 0 ? n : dataLength;
+        value = malloc(valueLength + 1);
+        if (value) {
+            memcpy(value, source, valueLength);
+            value[valueLength] = '\0';
+        } else {
+            valueLength = 0;
+        }
+    } else {
+        value = strdup("");
+    }
+    row->columnValues[index] = value;
+    row->columnLengths[index] = valueLength;
+}
+
+// Copy the current row of the active result set into row. Column names are only
+// copied when withNames is set; otherwise they are left NULL.
+static int readCurrentRow(DBPROCESS* dbproc, RowData* row, int ncols, int withNames) {
+    if (allocateRow(row, ncols) != 0) return -1;
+    for (int i = 1; i <= ncols; i++) {
+        fillCell(dbproc, row, i - 1, withNames ? dbcolname(dbproc, i) : NULL, dbcoltype(dbproc, i),
+                 dbdata(dbproc, i), dbdatlen(dbproc, i));
+    }
+    return 0;
+}
+
+// Append the current row of the active result set to *rows, growing it as needed.
+static int appendCurrentRow(DBPROCESS* dbproc, RowData** rows, int* allocated, int* count, int ncols, int withNames) {
+    if (*count >= *allocated) {
+        int new_alloc = *allocated == 0 ? 4 : *allocated * 2;
+        RowData* temp = realloc(*rows, new_alloc * sizeof(RowData));
+        if (temp == NULL) return -1;
+        *rows = temp;
+        *allocated = new_alloc;
+    }
+    if (readCurrentRow(dbproc, &(*rows)[*count], ncols, withNames) != 0) return -1;
+    (*count)++;
+    return 0;
+}
+
+static void describeColumnAt(DBPROCESS* dbproc, int column, TdsColumnInfo* info) {
+    memset(info, 0, sizeof *info);
+    const char* name = dbcolname(dbproc, column);
+    snprintf(info->name, sizeof info->name, "%s", name ? name : "");
+    info->type = dbcoltype(dbproc, column);
+    info->userType = dbcolutype(dbproc, column);
+    info->maxLength = dbcollen(dbproc, column);
+    DBTYPEINFO* typeinfo = dbcoltypeinfo(dbproc, column);
+    if (typeinfo != NULL) {
+        info->precision = typeinfo->precision;
+        info->scale = typeinfo->scale;
+    }
+    DBCOL col;
+    memset(&col, 0, sizeof col);
+    col.SizeOfStruct = sizeof col;
+    info->nullable = 1;
+    if (dbcolinfo(dbproc, CI_REGULAR, column, 0, &col) == SUCCEED) {
+        info->nullable = col.Null != FALSE;
+        info->identity = col.Identity != FALSE;
+        info->variableLength = col.VarLength != FALSE;
+        info->updatable = col.Updatable == TRUE;
+    }
+}
+
+int describeResultSet(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
+    int ncols = dbnumcols(dbproc);
+    if (state == NULL || ncols < 0) return -1;
+    if (ncols > state->schemaCapacity) {
+        TdsColumnInfo* grown = realloc(state->schema, (size_t)ncols * sizeof(TdsColumnInfo));
+        if (grown == NULL) return -1;
+        state->schema = grown;
+        state->schemaCapacity = ncols;
+    }
+    for (int i = 1; i <= ncols; i++) {
+        describeColumnAt(dbproc, i, &state->schema[i - 1]);
+    }
+    state->schemaColumns = ncols;
+    return ncols;
+}
+
+const TdsColumnInfo* resultSchema(DBPROCESS* dbproc, int* columnCount) {
+    ConnectionState* state = connectionState(dbproc);
+    *columnCount = state != NULL ? state->schemaColumns : 0;
+    return state != NULL ? state->schema : NULL;
+}
+
+int resultSetOrdinal(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
+    return state != NULL ? state->resultSetOrdinal : 0;
+}
+
 // Fetch results
 // Function to fetch results and return an array of RowData
 RowData* fetchResultsWithType(DBPROCESS* dbproc, int* rowCount) {
@@ -104,66 +549,36 @@ RowData* fetchResultsWithType(DBPROCESS* dbproc, int* rowCount) {
     while ((result_code = dbresults(dbproc)) != NO_MORE_RESULTS) {
         if (result_code != SUCCEED) continue;
         int ncols = dbnumcols(dbproc);
-        
-        while (dbnextrow(dbproc) != NO_MORE_ROWS) {
-            // Expand the rows array as needed
-            if (current_row >= rows_allocated) {
-                int new_alloc = rows_allocated == 0 ? 4 : rows_allocated * 2;
-                RowData* temp = realloc(rows, new_alloc * sizeof(RowData));
-                if (temp == NULL) {
-                    freeFetchedResults(rows, current_row);
-                    *rowCount = 0;
-                    return NULL;
+        int firstInSet = current_row;
+
+        int row_code;
+        while ((row_code = dbnextrow(dbproc)) != NO_MORE_ROWS) {
+            if (row_code == FAIL) {
+                dbcancel(dbproc);
+                // Keep the server or DB-Lib message if one explains the failure.
+                if (getConnectionErrorMessage(dbproc)[0] == '\0') {
+                    setConnectionError(dbproc, "Fetching a row failed");
                 }
-                rows = temp;
-                rows_allocated = new_alloc;
+                freeFetchedResults(rows, current_row);
+                *rowCount = 0;
+                return NULL;
             }
-
-            // Populate this row
-            rows[current_row].columnCount = ncols;
-            rows[current_row].columnNames = malloc(ncols * sizeof(char*));
-            rows[current_row].columnValues = malloc(ncols * sizeof(char*));
-            rows[current_row].columnTypes = malloc(ncols * sizeof(int));
-            if (!rows[current_row].columnNames || !rows[current_row].columnValues || !rows[current_row].columnTypes) {
+            if (isCancelRequested(dbproc)) {
+                dbcancel(dbproc);
+                setConnectionError(dbproc, "Query cancelled");
                 freeFetchedResults(rows, current_row);
                 *rowCount = 0;
                 return NULL;
             }
-
-            for (int i = 1; i <= ncols; i++) {
-                const char* colName = dbcolname(dbproc, i);
-                int colType = dbcoltype(dbproc, i);
-                rows[current_row].columnNames[i - 1] = strdup(colName ? colName : "");
-                rows[current_row].columnTypes[i - 1] = colType;
-
-                BYTE* data = dbdata(dbproc, i);
-                int dataLength = dbdatlen(dbproc, i);
-                char* value;
-                if (data && dataLength > 0) {
-                    value = malloc(dataLength + 1);
-                    if (value) {
-                        memcpy(value, data, dataLength);
-                        value[dataLength] = '\0';
-                        switch (colType) {
-                            case SYBINT1:
-                            case SYBINT2:
-                            case SYBINT4:
-                                snprintf(value, dataLength + 1, "%d", *(int*)data);
-                                break;
-                            case SYBFLT8:
-                            case SYBREAL:
-                                snprintf(value, dataLength + 1, "%f", *(double*)data);
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                } else {
-                    value = strdup("");
-                }
-                rows[current_row].columnValues[i - 1] = value;
+            // Names travel on the first row of each result set only. The schema
+            // is that of the first result set to return a row.
+            if (current_row == 0) describeResultSet(dbproc);
+            if (appendCurrentRow(dbproc, &rows, &rows_allocated, &current_row, ncols,
+                                 current_row == firstInSet) != 0) {
+                freeFetchedResults(rows, current_row);
+                *rowCount = 0;
+                return NULL;
             }
-            current_row++;
         }
     }
 
@@ -176,23 +591,757 @@ RowData* fetchResultsWithType(DBPROCESS* dbproc, int* rowCount) {
     return rows;
 }
 
+int fetchNextRow(DBPROCESS* dbproc, RowData* row) {
+    ConnectionState* state = connectionState(dbproc);
+    int inResultSet = state != NULL && state->inResultSet;
+
+    while (1) {
+        if (!inResultSet) {
+            int result_code = dbresults(dbproc);
+            if (result_code == NO_MORE_RESULTS) return 0;
+            if (result_code == FAIL) return -1;
+            inResultSet = 1;
+            if (state != NULL) {
+                state->inResultSet = 1;
+                state->resultSetOrdinal++;
+            }
+            describeResultSet(dbproc);
+        }
+        int row_code = dbnextrow(dbproc);
+        if (row_code == NO_MORE_ROWS) {
+            inResultSet = 0;
+            if (state != NULL) state->inResultSet = 0;
+            continue;
+        }
+        if (row_code == FAIL || isCancelRequested(dbproc)) {
+            dbcancel(dbproc);
+            if (row_code != FAIL) {
+                setConnectionError(dbproc, "Query cancelled");
+            }
+            if (state != NULL) state->inResultSet = 0;
+            return -1;
+        }
+        if (readCurrentRow(dbproc, row, dbnumcols(dbproc), 0) != 0) {
+            dbcancel(dbproc);
+            if (state != NULL) state->inResultSet = 0;
+            return -1;
+        }
+        return 1;
+    }
+}
+
+int setRowBuffering(DBPROCESS* dbproc, int rows) {
+    if (rows <= 0) {
+        return dbclropt(dbproc, DBBUFFER, NULL) == SUCCEED ? 0 : -1;
+    }
+    char count[16];
+    snprintf(count, sizeof count, "%d", rows);
+    return dbsetopt(dbproc, DBBUFFER, count, 0) == SUCCEED ? 0 : -1;
+}
+
+int openBufferedResults(DBPROCESS* dbproc) {
+    int result_code;
+    while ((result_code = dbresults(dbproc)) != NO_MORE_RESULTS) {
+        if (result_code == FAIL) return -1;
+        int ncols = dbnumcols(dbproc);
+        if (ncols > 0) return ncols;
+    }
+    return 0;
+}
+
+int bufferRowsThrough(DBPROCESS* dbproc, int rowNumber) {
+    int last = dblastrow(dbproc);
+    if (last >= rowNumber) return 1;
+    // Continue from the newest buffered row, not from wherever dbgetrow left off.
+    if (last > 0 && dbgetrow(dbproc, last) != REG_ROW) return -1;
+
+    while (last < rowNumber) {
+        int row_code = dbnextrow(dbproc);
+        if (row_code == BUF_FULL) {
+            dbclrbuf(dbproc, 1);
+            continue;
+        }
+        if (row_code == NO_MORE_ROWS) return 0;
+        if (row_code == FAIL || isCancelRequested(dbproc)) {
+            if (row_code != FAIL) {
+                setConnectionError(dbproc, "Query cancelled");
+            }
+            dbcancel(dbproc);
+            return -1;
+        }
+        last = dblastrow(dbproc);
+    }
+    return 1;
+}
+
+void bufferedRowRange(DBPROCESS* dbproc, int* first, int* last) {
+    *first = dbfirstrow(dbproc);
+    *last = dblastrow(dbproc);
+}
+
+int readBufferedCell(DBPROCESS* dbproc, int rowNumber, int column, RowData* cell) {
+    if (column < 1 || column > dbnumcols(dbproc)) return -1;
+    if (dbgetrow(dbproc, rowNumber) != REG_ROW) return -1;
+    if (allocateRow(cell, 1) != 0) return -1;
+    fillCell(dbproc, cell, 0, dbcolname(dbproc, column), dbcoltype(dbproc, column),
+             dbdata(dbproc, column), dbdatlen(dbproc, column));
+    return 0;
+}
+
+int executeProcedure(DBPROCESS* dbproc, const char* name, const TdsRpcParam* params, int paramCount) {
+    ConnectionState* state = connectionState(dbproc);
+    if (state != NULL) clearConnectionErrors(state);
+    if (dbrpcinit(dbproc, name, 0) == FAIL) {
+        return -1;
+    }
+    for (int i = 0; i < paramCount; i++) {
+        const TdsRpcParam* p = &params[i];
+        BYTE status = p->isOutput ? DBRPCRETURN : 0;
+        if (dbrpcparam(dbproc, p->name, status, p->type, p->maxLength,
+                       p->value ? p->length : 0, (BYTE*)p->value) == FAIL) {
+            return -1;
+        }
+    }
+    if (dbrpcsend(dbproc) == FAIL || dbsqlok(dbproc) == FAIL) {
+        return -1;
+    }
+    return 0;
+}
+
+int fetchNextResultSet(DBPROCESS* dbproc, RowData** rows, int* rowCount) {
+    int result_code;
+    *rows = NULL;
+    *rowCount = 0;
+    while ((result_code = dbresults(dbproc)) != NO_MORE_RESULTS) {
+        if (result_code == FAIL) return -1;
+        int ncols = dbnumcols(dbproc);
+        if (ncols <= 0) continue;
+        describeResultSet(dbproc);
+
+        int allocated = 0;
+        int row_code;
+        while ((row_code = dbnextrow(dbproc)) != NO_MORE_ROWS) {
+            if (row_code == FAIL) {
+                dbcancel(dbproc);
+                freeFetchedResults(*rows, *rowCount);
+                *rows = NULL;
+                *rowCount = 0;
+                return -1;
+            }
+            if (isCancelRequested(dbproc)) {
+                dbcancel(dbproc);
+                setConnectionError(dbproc, "Query cancelled");
+                freeFetchedResults(*rows, *rowCount);
+                *rows = NULL;
+                *rowCount = 0;
+                return -1;
+            }
+            if (appendCurrentRow(dbproc, rows, &allocated, rowCount, ncols, *rowCount == 0) != 0) {
+                freeFetchedResults(*rows, *rowCount);
+                *rows = NULL;
+                *rowCount = 0;
+                return -1;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Read and discard every pending result. Returns -1 if the server reported a failure.
+static int drainResults(DBPROCESS* dbproc) {
+    int result_code;
+    while ((result_code = dbresults(dbproc)) != NO_MORE_RESULTS) {
+        if (result_code == FAIL) return -1;
+        int row_code;
+        while ((row_code = dbnextrow(dbproc)) != NO_MORE_ROWS) {
+            if (row_code == FAIL) return -1;
+        }
+    }
+    return 0;
+}
+
+int resetSession(DBPROCESS* dbproc, const char* database) {
+    // sp_reset_connection is only callable as an RPC. It drops temp tables, rolls
+    // back open transactions, restores SET options and switches to the login's
+    // default database.
+    if (executeProcedure(dbproc, "sp_reset_connection", NULL, 0) != 0 || drainResults(dbproc) != 0) {
+        // Temp tables and SET options may have survived, so the session is not
+        // clean. Still roll back open transactions before reporting the failure,
+        // so that no locks stay held until the caller closes the connection.
+        dbcancel(dbproc);
+        if (executeQuery(dbproc, "IF @@TRANCOUNT > 0 ROLLBACK TRANSACTION") != 0
+            || drainResults(dbproc) != 0) {
+            dbcancel(dbproc);
+        }
+        setConnectionError(dbproc, "sp_reset_connection failed; the session was not reset");
+        return -1;
+    }
+    if (database != NULL && database[0] != '\0' && dbuse(dbproc, database) == FAIL) {
+        return -1;
+    }
+    return 0;
+}
+
+int getReturnStatus(DBPROCESS* dbproc, int* status) {
+    if (!dbhasretstat(dbproc)) return 0;
+    *status = dbretstatus(dbproc);
+    return 1;
+}
+
+RowData* fetchOutputParameters(DBPROCESS* dbproc) {
+    int count = dbnumrets(dbproc);
+    RowData* row = malloc(sizeof(RowData));
+    if (row == NULL) return NULL;
+    if (allocateRow(row, count > 0 ? count : 0) != 0) {
+        free(row);
+        return NULL;
+    }
+    for (int i = 1; i <= count; i++) {
+        fillCell(dbproc, row, i - 1, dbretname(dbproc, i), dbrettype(dbproc, i), dbretdata(dbproc, i), dbretlen(dbproc, i));
+    }
+    return row;
+}
+
+
+void freeRowContents(RowData* row) {
+    for (int j = 0; j < row->columnCount; j++) {
+        free(row->columnNames[j]);
+        free(row->columnValues[j]);
+    }
+    free(row->columnNames);
+    free(row->columnValues);
+    free(row->columnTypes);
+    free(row->columnLengths);
+    free(row->nullBitmap);
+    memset(row, 0, sizeof(RowData));
+}
 
 //Function to free the allocated memory for fetched results
 void freeFetchedResults(RowData* rows, int rowCount) {
     for (int i = 0; i < rowCount; i++) {
-        for (int j = 0; j < rows[i].columnCount; j++) {
-            free(rows[i].columnNames[j]);
-            free(rows[i].columnValues[j]);
-        }
-        free(rows[i].columnNames);
-        free(rows[i].columnValues);
-        free(rows[i].columnTypes);
+        freeRowContents(&rows[i]);
     }
     free(rows);
 }
 
-// Close the connection
+int isConnectionDead(DBPROCESS* dbproc) {
+    return dbproc == NULL || dbdead(dbproc);
+}
+
+// Close the connection. Other connections stay open, so DB-Library itself is not
+// shut down here.
 void closeConnection(DBPROCESS* dbproc) {
+    ConnectionState* state = connectionState(dbproc);
     dbclose(dbproc);
-    dbexit();
+    if (state != NULL) {
+        free(state->captured);
+        free(state->schema);
+    }
+    free(state);
+}
+
+// MARK: - Streaming export
+
+// Output chunk. With a sink, full chunks are handed to it; without one (the
+// export cursor) the chunk grows to hold whatever is written.
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    TdsExportSink sink;
+    void* context;
+    int failed;
+} ExportBuffer;
+
+static int exportGrow(ExportBuffer* out, size_t needed) {
+    size_t capacity = out->capacity * 2;
+    if (capacity < out->length + needed) capacity = out->length + needed;
+    char* grown = realloc(out->data, capacity);
+    if (grown == NULL) {
+        out->failed = 1;
+        return -1;
+    }
+    out->data = grown;
+    out->capacity = capacity;
+    return 0;
+}
+
+static void exportFlush(ExportBuffer* out) {
+    if (out->sink == NULL) return;
+    if (out->length > 0 && !out->failed) {
+        if (out->sink(out->context, out->data, out->length) != 0) {
+            out->failed = 1;
+        }
+    }
+    out->length = 0;
+}
+
+static void exportWrite(ExportBuffer* out, const char* bytes, size_t length) {
+    if (out->failed) return;
+    if (out->length + length > out->capacity && out->sink == NULL) {
+        if (exportGrow(out, length) != 0) return;
+    } else if (out->length + length > out->capacity) {
+        exportFlush(out);
+        if (length > out->capacity) {
+            // Oversized cell: hand it to the sink directly instead of growing the chunk.
+            if (!out->failed && out->sink(out->context, bytes, length) != 0) {
+                out->failed = 1;
+            }
+            return;
+        }
+    }
+    memcpy(out->data + out->length, bytes, length);
+    out->length += length;
+}
+
+static void exportPutc(ExportBuffer* out, char c) {
+    if (out->length == out->capacity) {
+        if (out->sink == NULL) exportGrow(out, 1);
+        else exportFlush(out);
+    }
+    if (!out->failed) out->data[out->length++] = c;
+}
+
+// Write bytes as a CSV field, quoting only when the field contains a delimiter,
+// quote or line break (RFC 4180).
+static void exportCSVField(ExportBuffer* out, const char* bytes, size_t length) {
+    size_t i;
+    for (i = 0; i < length; i++) {
+        char c = bytes[i];
+        if (c == ',' || c == '"' || c == '\r' || c == '\n') break;
+    }
+    if (i == length) {
+        exportWrite(out, bytes, length);
+        return;
+    }
+    exportPutc(out, '"');
+    size_t start = 0;
+    for (i = 0; i < length; i++) {
+        if (bytes[i] == '"') {
+            exportWrite(out, bytes + start, i - start + 1);
+            exportPutc(out, '"');
+            start = i + 1;
+        }
+    }
+    exportWrite(out, bytes + start, length - start);
+    exportPutc(out, '"');
+}
+
+// Write bytes as a quoted JSON string. Non-ASCII UTF-8 passes through untouched.
+static void exportJSONString(ExportBuffer* out, const char* bytes, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    exportPutc(out, '"');
+    size_t start = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        exportWrite(out, bytes + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"':  exportWrite(out, "\\\"", 2); break;
+            case '\\': exportWrite(out, "\\\\", 2); break;
+            case '\n': exportWrite(out, "\\n", 2); break;
+            case '\r': exportWrite(out, "\\r", 2); break;
+            case '\t': exportWrite(out, "\\t", 2); break;
+            default: {
+                char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                exportWrite(out, escape, sizeof(escape));
+            }
+        }
+    }
+    exportWrite(out, bytes + start, length - start);
+    exportPutc(out, '"');
+}
+
+static void exportHex(ExportBuffer* out, const BYTE* bytes, size_t length) {
+    static const char hex[] = "0123456789ABCDEF";
+    exportWrite(out, "0x", 2);
+    for (size_t i = 0; i < length; i++) {
+        exportPutc(out, hex[bytes[i] >> 4]);
+        exportPutc(out, hex[bytes[i] & 0xF]);
+    }
+}
+
+static void exportBase64(ExportBuffer* out, const BYTE* bytes, size_t length) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    exportPutc(out, '"');
+    size_t i = 0;
+    for (; i + 2 < length; i += 3) {
+        unsigned v = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+        char quad[4] = { table[(v >> 18) & 63], table[(v >> 12) & 63], table[(v >> 6) & 63], table[v & 63] };
+        exportWrite(out, quad, 4);
+    }
+    if (i < length) {
+        unsigned v = bytes[i] << 16;
+        if (i + 1 < length) v |= bytes[i + 1] << 8;
+        char quad[4] = { table[(v >> 18) & 63], table[(v >> 12) & 63],
+                         i + 1 < length ? table[(v >> 6) & 63] : '=', '=' };
+        exportWrite(out, quad, 4);
+    }
+    exportPutc(out, '"');
+}
+
+// 241 is xml, which DB-Library hands over as text in the client charset.
+static int isTextType(int type) {
+    return type == SYBCHAR || type == SYBVARCHAR || type == SYBTEXT || type == SYBNTEXT
+        || type == SYBNVARCHAR || type == 167 || type == 175 || type == 231 || type == 239
+        || type == 241;
+}
+
+static int isBinaryType(int type) {
+    return type == SYBBINARY || type == SYBVARBINARY || type == SYBIMAGE
+        || type == 165 || type == 173 || type == 240;
+}
+
+static int isNumericType(int type) {
+    return type == SYBDECIMAL || type == SYBNUMERIC || type == SYBMONEY || type == SYBMONEY4;
+}
+
+// Format a single cell. Integer, float and bit columns are formatted from their
+// native representation; other non-text types go through dbconvert to text.
+static void exportCell(ExportBuffer* out, DBPROCESS* dbproc, int format, int type,
+                       const BYTE* data, int length) {
+    char text[256];
+    int n = -1;
+
+    int json = format != TDS_EXPORT_CSV;
+
+    if (data == NULL) {
+        if (json) exportWrite(out, "null", 4);
+        return;
+    }
+    if (isTextType(type)) {
+        if (json) {
+            exportJSONString(out, (const char*)data, length);
+        } else {
+            exportCSVField(out, (const char*)data, length);
+        }
+        return;
+    }
+    if (isBinaryType(type)) {
+        if (json) {
+            exportBase64(out, data, length);
+        } else {
+            exportHex(out, data, length);
+        }
+        return;
+    }
+
+    switch (type) {
+        case SYBINT1: { DBTINYINT v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%u", (unsigned)v); break; }
+        case SYBINT2: { DBSMALLINT v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%d", (int)v); break; }
+        case SYBINT4: { DBINT v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%d", (int)v); break; }
+        case SYBINT8: { DBBIGINT v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%lld", (long long)v); break; }
+        case SYBFLT8: { DBFLT8 v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%.17g", v); break; }
+        case SYBREAL: { DBREAL v; memcpy(&v, data, sizeof v); n = snprintf(text, sizeof text, "%.9g", (double)v); break; }
+        case SYBBIT:
+        case SYBBITN:
+            if (json) {
+                exportWrite(out, data[0] ? "true" : "false", data[0] ? 4 : 5);
+            } else {
+                exportPutc(out, data[0] ? '1' : '0');
+            }
+            return;
+        default:
+            // Bound the conversion by the buffer: dbconvert blank-pads up to destlen and
+            // returns the converted length, or -1 (written as null) if it does not fit.
+            n = dbconvert(dbproc, type, data, length, SYBCHAR, (BYTE*)text, (DBINT)sizeof text - 1);
+            if (n > (int)sizeof text - 1) n = -1;
+            if (n >= 0) text[n] = '\0';
+            if (json && !isNumericType(type)) {
+                if (n < 0) { exportWrite(out, "null", 4); return; }
+                exportJSONString(out, text, n);
+                return;
+            }
+            if (format == TDS_EXPORT_CSV) {
+                if (n > 0) exportCSVField(out, text, n);
+                return;
+            }
+            break;
+    }
+    if (n < 0) {
+        if (json) exportWrite(out, "null", 4);
+        return;
+    }
+    exportWrite(out, text, n);
+}
+
+struct TdsExportCursor {
+    DBPROCESS* dbproc;
+    int format;
+    size_t chunkSize;
+    ExportBuffer out;
+    // Pre-escaped column keys (JSON) or header fields (CSV) of the current set.
+    char** keys;
+    size_t* keyLengths;
+    // Layout of the current set; points into the connection's schema.
+    const TdsColumnInfo* columns;
+    int ncols;
+    int started;
+    int exported;
+    int inResultSet;
+    int done;
+    long long rows;
+};
+
+static void exportReleaseColumns(TdsExportCursor* cursor) {
+    if (cursor->keys != NULL) {
+        for (int i = 0; i < cursor->ncols; i++) free(cursor->keys[i]);
+    }
+    free(cursor->keys);
+    free(cursor->keyLengths);
+    cursor->keys = NULL;
+    cursor->keyLengths = NULL;
+    cursor->columns = NULL;
+    cursor->ncols = 0;
+}
+
+// Describe the current result set into the connection's schema and escape its
+// column names once, for every row.
+static int exportDescribeColumns(TdsExportCursor* cursor) {
+    DBPROCESS* dbproc = cursor->dbproc;
+    int json = cursor->format != TDS_EXPORT_CSV;
+    int ncols = describeResultSet(dbproc);
+    if (ncols < 0) return -1;
+    cursor->columns = connectionState(dbproc)->schema;
+    cursor->keys = calloc(ncols, sizeof(char*));
+    cursor->keyLengths = calloc(ncols, sizeof(size_t));
+    cursor->ncols = ncols;
+    if (!cursor->keys || !cursor->keyLengths) return -1;
+
+    ExportBuffer names = { 0 };
+    for (int i = 1; i <= ncols; i++) {
+        const char* colName = cursor->columns[i - 1].name;
+        size_t nameLength = strlen(colName);
+        // Worst case every byte becomes a 6-byte \u escape, plus quotes, colon and comma.
+        names.capacity = nameLength * 6 + 4;
+        names.data = malloc(names.capacity);
+        names.length = 0;
+        if (names.data == NULL) continue;
+        if (json) {
+            names.data[names.length++] = i == 1 ? '{' : ',';
+            exportJSONString(&names, colName, nameLength);
+            names.data[names.length++] = ':';
+        } else {
+            if (i > 1) names.data[names.length++] = ',';
+            exportCSVField(&names, colName, nameLength);
+        }
+        cursor->keys[i - 1] = names.data;
+        cursor->keyLengths[i - 1] = names.length;
+    }
+    return 0;
+}
+
+TdsExportCursor* openExport(DBPROCESS* dbproc, int format, size_t chunkSize) {
+    TdsExportCursor* cursor = calloc(1, sizeof(TdsExportCursor));
+    if (cursor == NULL) return NULL;
+    cursor->dbproc = dbproc;
+    cursor->format = format;
+    cursor->chunkSize = chunkSize > 0 ? chunkSize : 1 << 20;
+    cursor->out.capacity = cursor->chunkSize;
+    cursor->out.data = malloc(cursor->out.capacity);
+    if (cursor->out.data == NULL) {
+        free(cursor);
+        return NULL;
+    }
+    return cursor;
+}
+
+int exportNextChunk(TdsExportCursor* cursor, const char** bytes, size_t* length) {
+    DBPROCESS* dbproc = cursor->dbproc;
+    ExportBuffer* out = &cursor->out;
+    int format = cursor->format;
+    int json = format != TDS_EXPORT_CSV;
+
+    *bytes = NULL;
+    *length = 0;
+    out->length = 0;
+    if (cursor->done) return 0;
+    if (!cursor->started) {
+        cursor->started = 1;
+        if (format == TDS_EXPORT_JSON) exportPutc(out, '[');
+    }
+
+    // Whole rows are written until the chunk is full, so a chunk can run past
+    // chunkSize by up to one row.
+    while (out->length < cursor->chunkSize && !out->failed) {
+        if (!cursor->inResultSet) {
+            RETCODE result_code = dbresults(dbproc);
+            if (result_code == NO_MORE_RESULTS) {
+                if (format == TDS_EXPORT_JSON) exportPutc(out, ']');
+                cursor->done = 1;
+                break;
+            }
+            if (result_code == FAIL) {
+                cursor->done = 1;
+                return -1;
+            }
+            int ncols = dbnumcols(dbproc);
+            if (ncols <= 0) continue;
+            if (cursor->exported) {
+                // Only the first row-returning result set is exported; drain the rest.
+                dbcanquery(dbproc);
+                continue;
+            }
+            cursor->exported = 1;
+            cursor->inResultSet = 1;
+            if (exportDescribeColumns(cursor) != 0) {
+                cursor->done = 1;
+                dbcancel(dbproc);
+                return -1;
+            }
+            if (format == TDS_EXPORT_CSV) {
+                for (int i = 0; i < cursor->ncols; i++) {
+                    if (cursor->keys[i]) exportWrite(out, cursor->keys[i], cursor->keyLengths[i]);
+                }
+                exportWrite(out, "\r\n", 2);
+            }
+        }
+
+        if (isCancelRequested(dbproc)) {
+            setConnectionError(dbproc, "Query cancelled");
+            cursor->done = 1;
+            dbcancel(dbproc);
+            return -1;
+        }
+        int row_code = dbnextrow(dbproc);
+        if (row_code == NO_MORE_ROWS) {
+            cursor->inResultSet = 0;
+            exportReleaseColumns(cursor);
+            continue;
+        }
+        if (row_code == FAIL) {
+            cursor->done = 1;
+            dbcancel(dbproc);
+            return -1;
+        }
+        if (format == TDS_EXPORT_JSON && cursor->rows > 0) exportPutc(out, ',');
+        for (int i = 1; i <= cursor->ncols; i++) {
+            if (json) {
+                if (cursor->keys[i - 1]) exportWrite(out, cursor->keys[i - 1], cursor->keyLengths[i - 1]);
+            } else if (i > 1) {
+                exportPutc(out, ',');
+            }
+            exportCell(out, dbproc, format, cursor->columns[i - 1].type, dbdata(dbproc, i), dbdatlen(dbproc, i));
+        }
+        if (format == TDS_EXPORT_NDJSON) {
+            exportWrite(out, "}\n", 2);
+        } else if (format == TDS_EXPORT_JSON) {
+            exportPutc(out, '}');
+        } else {
+            exportWrite(out, "\r\n", 2);
+        }
+        cursor->rows++;
+    }
+    if (out->failed) {
+        cursor->done = 1;
+        dbcancel(dbproc);
+        return -1;
+    }
+
+    *bytes = out->data;
+    *length = out->length;
+    return out->length > 0 ? 1 : 0;
+}
+
+long long exportedRowCount(const TdsExportCursor* cursor) {
+    return cursor->rows;
+}
+
+void closeExport(TdsExportCursor* cursor) {
+    if (cursor == NULL) return;
+    // Leave the connection ready for the next command if the export stopped early.
+    if (!cursor->done) dbcancel(cursor->dbproc);
+    exportReleaseColumns(cursor);
+    free(cursor->out.data);
+    free(cursor);
+}
+
+long long exportResults(DBPROCESS* dbproc, int format, TdsExportSink sink, void* context, size_t chunkSize) {
+    TdsExportCursor* cursor = openExport(dbproc, format, chunkSize);
+    if (cursor == NULL) {
+        dbcancel(dbproc);
+        return -1;
+    }
+    const char* bytes;
+    size_t length;
+    int status;
+    while ((status = exportNextChunk(cursor, &bytes, &length)) > 0) {
+        if (sink(context, bytes, length) != 0) {
+            status = -1;
+            break;
+        }
+    }
+    long long rows = status < 0 ? -1 : exportedRowCount(cursor);
+    closeExport(cursor);
+    return rows;
+}
+
+static int fileDescriptorSink(void* context, const char* bytes, size_t length) {
+    int fd = *(int*)context;
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+long long exportResultsToFileDescriptor(DBPROCESS* dbproc, int format, int fd, size_t chunkSize) {
+    return exportResults(dbproc, format, fileDescriptorSink, &fd, chunkSize);
+}
+
+// MARK: - FOR JSON / FOR XML documents
+
+int nextDocumentChunk(DBPROCESS* dbproc, const char** bytes, int* length) {
+    ConnectionState* state = connectionState(dbproc);
+    *bytes = NULL;
+    *length = 0;
+    if (state == NULL) return -1;
+
+    while (1) {
+        if (!state->inResultSet) {
+            int result_code = dbresults(dbproc);
+            if (result_code == NO_MORE_RESULTS) return 0;
+            if (result_code == FAIL) return -1;
+            int ncols = describeResultSet(dbproc);
+            if (ncols == 0) continue;
+            if (ncols != 1 || !isTextType(state->schema[0].type)) {
+                setConnectionError(dbproc, "Expected a single text column of FOR JSON or FOR XML output");
+                dbcancel(dbproc);
+                return -1;
+            }
+            state->inResultSet = 1;
+        }
+        int row_code = dbnextrow(dbproc);
+        if (row_code == NO_MORE_ROWS) {
+            // The document is the first row-returning result set; drain the rest
+            // so that errors raised after it are still reported.
+            state->inResultSet = 0;
+            int result_code;
+            while ((result_code = dbresults(dbproc)) != NO_MORE_RESULTS) {
+                if (result_code == FAIL) return -1;
+                dbcanquery(dbproc);
+            }
+            return 0;
+        }
+        if (row_code == FAIL || isCancelRequested(dbproc)) {
+            dbcancel(dbproc);
+            if (row_code != FAIL) {
+                setConnectionError(dbproc, "Query cancelled");
+            }
+            state->inResultSet = 0;
+            return -1;
+        }
+        BYTE* data = dbdata(dbproc, 1);
+        if (data == NULL) continue;
+        *bytes = (const char*)data;
+        *length = dbdatlen(dbproc, 1);
+        return 1;
+    }
 }
@@ -8,10 +8,16 @@
 #ifndef FreeTDSWrapper_h
 #define FreeTDSWrapper_h
 
+#include <stddef.h>
 #include <sybdb.h>
 
-// Retrieve the most recent error or message text from the TDS library.
+// Retrieve the most recent error or message text from the TDS library that was
+// not tied to an open connection, such as a failed login. Kept per thread, so read
+// it on the thread that called connectToDatabase.
 const char* getLastTdsErrorMessage(void);
+// The most recent server error, or else DB-Library error, on dbproc. Cleared when
+// the connection starts a new command.
+const char* getConnectionErrorMessage(DBPROCESS* dbproc);
 //#include "/opt/homebrew/include/sybdb.h"
 
 // Structure to hold a single row's data
@@ -19,17 +25,173 @@ typedef struct {
     char **columnNames;
     char **columnValues;
     int *columnTypes; // Array to hold column data types (e.g., integers representing SYBINT, SYBREAL, etc.)
+    int *columnLengths; // Byte length of each value (values are also NUL-terminated, but binary data may contain NULs)
+    unsigned char *nullBitmap; // Bit (j % 8) of byte (j / 8) is set when column j is NULL; its value pointer is NULL
     int columnCount;
 } RowData;
 
 
 const char* getDBVersion(void);
 int initializeDBLibrary(void);
-DBPROCESS* connectToDatabase(const char* server, const char* user, const char* password, const char* database, const int timeout);
+// charset may be NULL to keep the freetds.conf default client charset.
+DBPROCESS* connectToDatabase(const char* server, const char* user, const char* password, const char* database, const int timeout, const char* charset);
 int executeQuery(DBPROCESS* dbproc, const char* query);
+// Fetch every row of the pending query. Only the first row of each result set
+// carries column names.
 RowData* fetchResultsWithType(DBPROCESS* dbproc, int* rowCount);
 void freeFetchedResults(RowData* rows, int rowCount);
+// Row-at-a-time fetch for streaming. Read the next row of the pending query into
+// *row, moving on to later result sets as each one ends. Returns 1 when a row was
+// read, 0 when none remain, -1 on failure or cancellation (the rest of the command
+// is then cancelled). Column names are not copied into the row: take them from
+// resultSchema, which is refreshed whenever resultSetOrdinal changes. Release the
+// row with freeRowContents before reusing it.
+int fetchNextRow(DBPROCESS* dbproc, RowData* row);
+
+// Layout of one result column, read once per result set.
+typedef struct {
+    char name[MAXCOLNAMELEN + 2];
+    int type;           // SYB* type code, as in RowData.columnTypes
+    int userType;       // server user type (dbcolutype)
+    int maxLength;      // longest value in bytes (dbcollen)
+    int precision;      // decimal and numeric columns (dbcoltypeinfo)
+    int scale;
+    int nullable;
+    int identity;
+    int variableLength;
+    int updatable;
+} TdsColumnInfo;
+
+// Record the layout of the current result set. fetchResultsWithType (for the
+// first result set that returns a row), fetchNextRow and fetchNextResultSet do
+// this themselves. Returns the column count, or -1 on failure.
+int describeResultSet(DBPROCESS* dbproc);
+// The most recently recorded layout, *columnCount entries long. Owned by the
+// session; valid until the next fetch or query.
+const TdsColumnInfo* resultSchema(DBPROCESS* dbproc, int* columnCount);
+// How many result sets fetchNextRow has entered since the query started.
+int resultSetOrdinal(DBPROCESS* dbproc);
+void freeRowContents(RowData* row);
 void closeConnection(DBPROCESS* dbproc);
+// Non-zero once DB-Library has seen the session fail (dbdead). Only I/O on the
+// session updates it.
+int isConnectionDead(DBPROCESS* dbproc);
+
+// Cancellation of the in-flight command. requestCancel may be called from any thread;
+// DB-Library then cancels the command at its next wait on the server, and the fetch
+// loops stop between rows. Clear the request before starting a new command.
+void requestCancel(DBPROCESS* dbproc);
+void clearCancelRequest(DBPROCESS* dbproc);
+int isCancelRequested(DBPROCESS* dbproc);
+
+// A message sent by the server: PRINT output, RAISERROR, errors and statistics.
+// The strings are only valid during the sink call.
+typedef struct {
+    long number;
+    int severity;
+    int state;
+    int line;
+    const char* text;
+    const char* procedure; // NULL or empty outside a procedure
+} TdsServerMessage;
+
+// Receives each server message on the thread running the command, while the
+// command is in progress. It must not call back into DB-Library.
+typedef void (*TdsMessageSink)(void* context, const TdsServerMessage* message);
+
+// Deliver every message sent on this session to sink (NULL to stop).
+void setMessageSink(DBPROCESS* dbproc, TdsMessageSink sink, void* context);
+
+// Collect the informational messages (severity below 11, e.g. SET STATISTICS
+// output) the server sends on this session. Either call discards what was
+// collected before; disabling also frees the buffer.
+void setMessageCapture(DBPROCESS* dbproc, int enabled);
+// The messages collected since capture was enabled, as NUL-terminated
+// "msgno\ttext" records taking *length bytes in all. Owned by the session and
+// valid until the next setMessageCapture call.
+const char* capturedMessages(DBPROCESS* dbproc, size_t* length);
+
+// DB-Library row buffering (DBBUFFER) for random access to a window of rows.
+// Enable with setRowBuffering before executeQuery and disable (rows = 0) once the
+// results are done. Row numbers are 1-based positions in the result set.
+int setRowBuffering(DBPROCESS* dbproc, int rows);
+// Move to the first row-returning result set. Returns its column count, 0 when
+// there is none, -1 on failure.
+int openBufferedResults(DBPROCESS* dbproc);
+// Read ahead until rowNumber is buffered, dropping the oldest rows when the buffer
+// is full. Returns 1 when it is buffered, 0 when the result set ends first, -1 on
+// failure or cancellation.
+int bufferRowsThrough(DBPROCESS* dbproc, int rowNumber);
+// Row numbers of the oldest and newest buffered rows (0 when empty).
+void bufferedRowRange(DBPROCESS* dbproc, int* first, int* last);
+// Copy one cell (column is 1-based) of a buffered row into a single-column row.
+// Returns -1 if the row is no longer buffered. Free with freeRowContents.
+int readBufferedCell(DBPROCESS* dbproc, int rowNumber, int column, RowData* cell);
+
+// One stored procedure parameter for executeProcedure.
+typedef struct {
+    const char* name;   // including the leading '@'
+    int type;           // SYB* type code of value
+    int isOutput;       // non-zero to send as an OUTPUT parameter
+    int maxLength;      // -1 for fixed-length types, else the longest value the output may return
+    const void* value;  // NULL sends SQL NULL
+    int length;         // byte length of value
+} TdsRpcParam;
+
+// Send an RPC call for the stored procedure name. Returns 0 on success, -1 on failure.
+int executeProcedure(DBPROCESS* dbproc, const char* name, const TdsRpcParam* params, int paramCount);
+// Fetch the next row-returning result set of the pending command into *rows (which
+// may be NULL when the set is empty). Only the first row carries column names. Returns 1 when a result set was read, 0 when
+// none remain, -1 on failure. Free *rows with freeFetchedResults.
+int fetchNextResultSet(DBPROCESS* dbproc, RowData** rows, int* rowCount);
+// Once all results are consumed: store the procedure return status and return 1,
+// or return 0 when the server sent none.
+int getReturnStatus(DBPROCESS* dbproc, int* status);
+// Once all results are consumed: the output parameters as a single row, named by
+// parameter. Free with freeFetchedResults(row, 1).
+RowData* fetchOutputParameters(DBPROCESS* dbproc);
+
+// Restore the session to its post-login state (sp_reset_connection) and switch to
+// database. Returns 0 on success, -1 on failure. When the server refuses the reset,
+// open transactions are still rolled back, but -1 is returned because other
+// session state may remain; the connection should then be closed.
+int resetSession(DBPROCESS* dbproc, const char* database);
+
+// Streaming export formats for exportResults.
+typedef enum {
+    TDS_EXPORT_CSV = 0,     // RFC 4180, CRLF line endings, header row first
+    TDS_EXPORT_NDJSON = 1,  // one JSON object per line
+    TDS_EXPORT_JSON = 2     // one JSON array of objects
+} TdsExportFormat;
+
+// Receives a chunk of formatted output. Return 0 to continue, non-zero to abort.
+typedef int (*TdsExportSink)(void* context, const char* bytes, size_t length);
+
+// Format the first row-returning result set of the pending query straight from
+// the DB-Library row buffers, handing output to sink in chunks of chunkSize bytes.
+// Returns the number of rows written, or -1 on failure.
+long long exportResults(DBPROCESS* dbproc, int format, TdsExportSink sink, void* context, size_t chunkSize);
+long long exportResultsToFileDescriptor(DBPROCESS* dbproc, int format, int fd, size_t chunkSize);
+
+// Pull-style export of the same output, for consumers that cannot take chunks
+// from a callback. Each exportNextChunk call writes whole rows until at least
+// chunkSize bytes are ready and points *bytes at them; the bytes stay valid
+// until the next call. Returns 1 for a chunk, 0 at the end, -1 on failure or
+// cancellation. closeExport cancels the rest of the command if the export did
+// not reach the end.
+typedef struct TdsExportCursor TdsExportCursor;
+TdsExportCursor* openExport(DBPROCESS* dbproc, int format, size_t chunkSize);
+int exportNextChunk(TdsExportCursor* cursor, const char** bytes, size_t* length);
+long long exportedRowCount(const TdsExportCursor* cursor);
+void closeExport(TdsExportCursor* cursor);
+
+// Read FOR JSON / FOR XML output, which the server splits over the rows of a
+// single text column. Points *bytes at the next row's text, in the client
+// charset, straight from the DB-Library row buffer; it stays valid until the
+// next call. NULL rows are skipped. Returns 1 for a chunk, 0 once the first
+// row-returning result set has ended (later ones are discarded), or -1 on
+// failure, cancellation or when the result is not a single text column.
+int nextDocumentChunk(DBPROCESS* dbproc, const char** bytes, int* length);
 
 
 #endif /* FreeTDSWrapper_h */
@@ -0,0 +1,304 @@
+//
+//  ArrowColumnBuilder.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+/// Arrow buffers for one column of a record batch, filled a cell at a time
+/// straight from fetched `RowData`, without decoding cells to `SQLDataType`.
+///
+/// The cell layout follows the shim's `fillCell`: numbers, decimals, money and
+/// dates arrive as text, binary and `uniqueidentifier` values as raw bytes and
+/// text in the client charset. A cell that does not parse as the column's type
+/// is written as null.
+struct ArrowColumnBuilder {
+    let type: ArrowType
+    /// DB-Library type code of the column.
+    let typeCode: Int
+    private let encoding: String.Encoding
+    private(set) var count = 0
+    private var nullCount = 0
+    private var validity: [UInt8] = []
+    /// Int32 offsets, for `utf8` and `binary`.
+    private var offsets: [UInt8] = []
+    /// Values, or packed bits for `bool`.
+    private var data: [UInt8] = []
+
+    init(column: ResultSchema.Column, encoding: String.Encoding, capacity: Int) {
+        self.type = column.arrowType
+        self.typeCode = column.typeCode
+        self.encoding = encoding
+        validity.reserveCapacity((capacity + 7) / 8)
+        if isVariableWidth {
+            offsets.reserveCapacity((capacity + 1) * 4)
+            appendLittleEndian(Int32(0), to: &offsets)
+        } else {
+            data.reserveCapacity(capacity * max(type.byteWidth, 1))
+        }
+    }
+
+    private var isVariableWidth: Bool {
+        type == .utf8 || type == .binary
+    }
+
+    /// Append column `j` of `row`.
+    mutating func append(_ row: RowData, at j: Int) {
+        if count & 7 == 0 {
+            validity.append(0)
+            if type == .bool { data.append(0) }
+        }
+        var valid = false
+        if j < Int(row.columnCount), !row.isNull(at: j), let value = row.columnValues?[j] {
+            let cell = UnsafeRawBufferPointer(start: value, count: Int(row.columnLengths?[j] ?? 0))
+            valid = encode(cell, row: row, at: j)
+        }
+        if valid {
+            validity[count >> 3] |= 1 << UInt8(count & 7)
+        } else {
+            nullCount += 1
+            if !isVariableWidth, type != .bool {
+                data.append(contentsOf: repeatElement(0, count: type.byteWidth))
+            }
+        }
+        if isVariableWidth {
+            appendLittleEndian(Int32(truncatingIfNeeded: data.count), to: &offsets)
+        }
+        count += 1
+    }
+
+    /// Hand over the buffers of the rows appended so far and start a new batch.
+    mutating func finish() -> ArrowEncodedColumn {
+        let buffers = isVariableWidth ? [validity, offsets, data] : [validity, data]
+        let column = ArrowEncodedColumn(length: count, nullCount: nullCount, buffers: buffers)
+        count = 0
+        nullCount = 0
+        validity.removeAll(keepingCapacity: true)
+        offsets.removeAll(keepingCapacity: true)
+        data.removeAll(keepingCapacity: true)
+        if isVariableWidth {
+            appendLittleEndian(Int32(0), to: &offsets)
+        }
+        return column
+    }
+
+    /// Write the value of `cell`, or nothing and return `false` if it does not
+    /// parse as `type`.
+    private mutating func encode(_ cell: UnsafeRawBufferPointer, row: RowData, at j: Int) -> Bool {
+        var scanner = CellScanner(cell)
+        switch type {
+        case .int(let bits, let signed):
+            guard let v = scanner.integer(), scanner.isAtEnd else { return false }
+            switch (bits, signed) {
+            case (8, false):
+                guard let x = UInt8(exactly: v) else { return false }
+                appendLittleEndian(x, to: &data)
+            case (16, _):
+                guard let x = Int16(exactly: v) else { return false }
+                appendLittleEndian(x, to: &data)
+            case (32, _):
+                guard let x = Int32(exactly: v) else { return false }
+                appendLittleEndian(x, to: &data)
+            default:
+                appendLittleEndian(v, to: &data)
+            }
+        case .float, .double:
+            // Cells are NUL-terminated, so strtod stops at the end of the value.
+            guard let start = cell.baseAddress?.assumingMemoryBound(to: CChar.self) else { return false }
+            var end: UnsafeMutablePointer<CChar>?
+            let v = strtod(start, &end)
+            guard let end, UnsafePointer(end) != start else { return false }
+            if type == .float {
+                appendLittleEndian(Float(v).bitPattern, to: &data)
+            } else {
+                appendLittleEndian(v.bitPattern, to: &data)
+            }
+        case .bool:
+            guard let byte = cell.first else { return false }
+            if byte != 0 && byte != UInt8(ascii: "0") {
+                data[count >> 3] |= 1 << UInt8(count & 7)
+            }
+        case .decimal128(_, let scale):
+            guard let v = scanner.scaledDecimal(scale: scale), scanner.isAtEnd else { return false }
+            appendLittleEndian(v, to: &data)
+        case .date32:
+            guard let date = scanner.date(), scanner.isAtEnd else { return false }
+            appendLittleEndian(Int32(date.daysSinceUnixEpoch), to: &data)
+        case .time32Seconds:
+            guard let seconds = scanner.timeOfDay(), scanner.isAtEnd else { return false }
+            appendLittleEndian(Int32(seconds / 10_000_000), to: &data)
+        case .timestampMicros(let timezone):
+            guard let date = scanner.date(), scanner.skip(" "), let ticks = scanner.timeOfDay()
+            else { return false }
+            var micros = Int64(date.daysSinceUnixEpoch) * 86_400_000_000 + ticks / 10
+            if timezone != nil {
+                guard scanner.skip(" "), let offset = scanner.offsetMinutes() else { return false }
+                micros -= Int64(offset) * 60_000_000
+            }
+            guard scanner.isAtEnd else { return false }
+            appendLittleEndian(micros, to: &data)
+        case .fixedSizeBinary(16):
+            if cell.count == 16, let base = cell.baseAddress {
+                withUnsafeBytes(of: decodeUniqueIdentifier(base).uuid) { data.append(contentsOf: $0) }
+            } else if let uuid = UUID(uuidString: String(decoding: cell, as: UTF8.self)) {
+                withUnsafeBytes(of: uuid.uuid) { data.append(contentsOf: $0) }
+            } else {
+                return false
+            }
+        case .binary:
+            data.append(contentsOf: cell)
+        case .utf8:
+            if encoding == .utf8, Self.isText(typeCode) {
+                data.append(contentsOf: cell)
+            } else {
+                // Other charsets and non-text columns go through their decoded text.
+                guard let value = row.value(at: j, encoding: encoding),
+                      let bytes = ArrowEncodedColumn.variableBytes(value, as: .utf8)
+                else { return false }
+                data.append(contentsOf: bytes)
+            }
+        case .fixedSizeBinary:
+            return false
+        }
+        return true
+    }
+
+    private static func isText(_ typeCode: Int) -> Bool {
+        switch typeCode {
+        case SYBCHAR, SYBVARCHAR, SYBNVARCHAR, SYBTEXT, 99, 239, 241: return true
+        default: return false
+        }
+    }
+}
+
+/// Reads the numbers and separators of a cell the shim rendered as text.
+private struct CellScanner {
+    private let bytes: UnsafeRawBufferPointer
+    private var position = 0
+
+    init(_ bytes: UnsafeRawBufferPointer) {
+        self.bytes = bytes
+    }
+
+    var isAtEnd: Bool { position >= bytes.count }
+
+    mutating func skip(_ character: Unicode.Scalar) -> Bool {
+        guard !isAtEnd, bytes[position] == UInt8(ascii: character) else { return false }
+        position += 1
+        return true
+    }
+
+    /// A run of decimal digits and how many there were, or `nil` if there are
+    /// none or the value does not fit in `UInt64`.
+    mutating func digits() -> (value: UInt64, count: Int)? {
+        var value: UInt64 = 0
+        var count = 0
+        while !isAtEnd, (UInt8(ascii: "0")...UInt8(ascii: "9")).contains(bytes[position]) {
+            let (times10, o1) = value.multipliedReportingOverflow(by: 10)
+            let (next, o2) = times10.addingReportingOverflow(UInt64(bytes[position] - UInt8(ascii: "0")))
+            guard !o1, !o2 else { return nil }
+            value = next
+            count += 1
+            position += 1
+        }
+        return count > 0 ? (value, count) : nil
+    }
+
+    private mutating func number() -> Int? {
+        digits().flatMap { Int(exactly: $0.value) }
+    }
+
+    mutating func integer() -> Int64? {
+        let negative = skip("-")
+        guard let magnitude = digits()?.value else { return nil }
+        if negative {
+            guard magnitude <= UInt64(Int64.max) + 1 else { return nil }
+            return Int64(truncatingIfNeeded: 0 &- magnitude)
+        }
+        return Int64(exactly: magnitude)
+    }
+
+    /// `[-]digits[.digits]` as a count of `10^-scale`, rounding half away from
+    /// zero past `scale` digits.
+    mutating func scaledDecimal(scale: Int) -> Int128? {
+        let negative = skip("-")
+        var magnitude: UInt128 = 0
+        var sawDigit = false
+        var fractionDigits = 0
+        var roundUp = false
+        var inFraction = false
+        while !isAtEnd {
+            let byte = bytes[position]
+            if byte == UInt8(ascii: "."), !inFraction {
+                inFraction = true
+                position += 1
+                continue
+            }
+            guard (UInt8(ascii: "0")...UInt8(ascii: "9")).contains(byte) else { break }
+            position += 1
+            sawDigit = true
+            let digit = UInt128(byte - UInt8(ascii: "0"))
+            if inFraction {
+                fractionDigits += 1
+                if fractionDigits > scale {
+                    // Only the first dropped digit decides the rounding.
+                    if fractionDigits == scale + 1 { roundUp = digit >= 5 }
+                    continue
+                }
+            }
+            let (times10, o1) = magnitude.multipliedReportingOverflow(by: 10)
+            let (next, o2) = times10.addingReportingOverflow(digit)
+            guard !o1, !o2 else { return nil }
+            magnitude = next
+        }
+        guard sawDigit else { return nil }
+        for _ in min(fractionDigits, scale)..<scale {
+            let (next, overflow) = magnitude.multipliedReportingOverflow(by: 10)
+            guard !overflow else { return nil }
+            magnitude = next
+        }
+        if roundUp { magnitude += 1 }
+        guard magnitude <= UInt128(Int128.max) else { return nil }
+        return negative ? -Int128(magnitude) : Int128(magnitude)
+    }
+
+    /// `YYYY-MM-DD`.
+    mutating func date() -> TDSDate? {
+        guard let year = number(), skip("-"), let month = number(), skip("-"), let day = number()
+        else { return nil }
+        return TDSDate(day: day, month: month, year: year)
+    }
+
+    /// `HH:MM[:SS[.fraction]]` as 100ns ticks since midnight.
+    mutating func timeOfDay() -> Int64? {
+        guard let hour = number(), skip(":"), let minute = number() else { return nil }
+        var second = 0
+        var ticks: Int64 = 0
+        if skip(":") {
+            guard let s = number() else { return nil }
+            second = s
+            if skip(".") {
+                guard let fraction = digits(), fraction.count <= 7 else { return nil }
+                ticks = Int64(fraction.value)
+                for _ in fraction.count..<7 { ticks *= 10 }
+            }
+        }
+        return Int64(hour * 3600 + minute * 60 + second) * 10_000_000 + ticks
+    }
+
+    /// `+hh:mm` or `-hh:mm` as minutes east of UTC.
+    mutating func offsetMinutes() -> Int? {
+        let negative: Bool
+        if skip("-") {
+            negative = true
+        } else if skip("+") {
+            negative = false
+        } else {
+            return nil
+        }
+        guard let hours = number(), skip(":"), let minutes = number() else { return nil }
+        let offset = hours * 60 + minutes
+        return negative ? -offset : offset
+    }
+}
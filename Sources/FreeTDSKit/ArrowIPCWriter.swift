@@ -0,0 +1,700 @@
+//
+//  ArrowIPCWriter.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+/// Arrow IPC container layouts.
+public enum ArrowIPCFormat: Sendable {
+    /// The streaming format: schema message, record batches, end-of-stream marker.
+    case stream
+    /// The random-access file format (`.arrow`): magic, stream body and a footer.
+    case file
+}
+
+// MARK: - Arrow types
+
+/// The Arrow logical types result columns are mapped onto.
+enum ArrowType: Equatable {
+    case bool
+    case int(bitWidth: Int, signed: Bool)
+    case float
+    case double
+    case decimal128(precision: Int, scale: Int)
+    case date32
+    case time32Seconds
+    case timestampMicros(timezone: String?)
+    case fixedSizeBinary(Int)
+    case binary
+    case utf8
+
+    /// `Type` union discriminator from Schema.fbs.
+    var unionType: UInt8 {
+        switch self {
+        case .int: return 2
+        case .float, .double: return 3
+        case .binary: return 4
+        case .utf8: return 5
+        case .bool: return 6
+        case .decimal128: return 7
+        case .date32: return 8
+        case .time32Seconds: return 9
+        case .timestampMicros: return 10
+        case .fixedSizeBinary: return 15
+        }
+    }
+
+    /// Byte width of one value for fixed-width layouts.
+    var byteWidth: Int {
+        switch self {
+        case .int(let bits, _): return bits / 8
+        case .float, .date32, .time32Seconds: return 4
+        case .double, .timestampMicros: return 8
+        case .decimal128: return 16
+        case .fixedSizeBinary(let width): return width
+        case .bool, .binary, .utf8: return 0
+        }
+    }
+
+    /// Pick an Arrow type from the first non-null value of a column. Decimal
+    /// columns take the widest scale seen; all-null columns become nullable utf8.
+    init(inferringFrom values: [SQLDataType]) {
+        var decimalScale: Int? = nil
+        for value in values {
+            switch value {
+            case .null: continue
+            case .decimal(let d), .numeric(let d):
+                decimalScale = max(decimalScale ?? 0, min(max(-d.exponent, 0), 38))
+                continue
+            case .money:
+                decimalScale = max(decimalScale ?? 0, 4)
+                continue
+            default:
+                break
+            }
+            if decimalScale != nil { continue }
+            switch value {
+            case .tinyInt: self = .int(bitWidth: 8, signed: false)
+            case .smallInt: self = .int(bitWidth: 16, signed: true)
+            case .integer: self = .int(bitWidth: 32, signed: true)
+            case .bigInt: self = .int(bitWidth: 64, signed: true)
+            case .float, .real: self = .float
+            case .double: self = .double
+            case .bit: self = .bool
+            case .date: self = .date32
+            case .time: self = .time32Seconds
+            case .datetime, .smalldatetime, .datetime2: self = .timestampMicros(timezone: nil)
+            case .datetimeoffset: self = .timestampMicros(timezone: "UTC")
+            case .uniqueidentifier: self = .fixedSizeBinary(16)
+            case .binary, .varbinary: self = .binary
+            default: self = .utf8
+            }
+            return
+        }
+        if let scale = decimalScale {
+            self = .decimal128(precision: 38, scale: scale)
+        } else {
+            self = .utf8
+        }
+    }
+}
+
+// MARK: - Column encoding
+
+/// Arrow buffers for one column of one record batch.
+struct ArrowEncodedColumn {
+    var length: Int
+    var nullCount: Int
+    var buffers: [[UInt8]]
+
+    /// Build the validity bitmap and value (and, for variable-width types, offset)
+    /// buffers for `values`. Values that do not fit `type` are written as nulls.
+    init(_ values: [SQLDataType], as type: ArrowType) {
+        let count = values.count
+        var validity = [UInt8](repeating: 0, count: (count + 7) / 8)
+        var nullCount = 0
+
+        switch type {
+        case .utf8, .binary:
+            var offsets: [UInt8] = []
+            offsets.reserveCapacity((count + 1) * 4)
+            var data: [UInt8] = []
+            appendLittleEndian(Int32(0), to: &offsets)
+            for (i, value) in values.enumerated() {
+                if let bytes = ArrowEncodedColumn.variableBytes(value, as: type) {
+                    validity[i >> 3] |= 1 << UInt8(i & 7)
+                    data.append(contentsOf: bytes)
+                } else {
+                    nullCount += 1
+                }
+                appendLittleEndian(Int32(truncatingIfNeeded: data.count), to: &offsets)
+            }
+            self.buffers = [validity, offsets, data]
+
+        case .bool:
+            var bits = [UInt8](repeating: 0, count: (count + 7) / 8)
+            for (i, value) in values.enumerated() {
+                if case .bit(let b) = value {
+                    validity[i >> 3] |= 1 << UInt8(i & 7)
+                    if b { bits[i >> 3] |= 1 << UInt8(i & 7) }
+                } else {
+                    nullCount += 1
+                }
+            }
+            self.buffers = [validity, bits]
+
+        default:
+            let width = type.byteWidth
+            var data: [UInt8] = []
+            data.reserveCapacity(count * width)
+            for (i, value) in values.enumerated() {
+                let before = data.count
+                ArrowEncodedColumn.appendFixed(value, as: type, to: &data)
+                if data.count == before {
+                    data.append(contentsOf: repeatElement(0, count: width))
+                    nullCount += 1
+                } else {
+                    validity[i >> 3] |= 1 << UInt8(i & 7)
+                }
+            }
+            self.buffers = [validity, data]
+        }
+
+        self.length = count
+        self.nullCount = nullCount
+        if nullCount == 0 {
+            // A zero-length validity buffer means "all valid".
+            self.buffers[0] = []
+        }
+    }
+
+    /// Wrap buffers built elsewhere; `buffers[0]` is the validity bitmap.
+    init(length: Int, nullCount: Int, buffers: [[UInt8]]) {
+        self.length = length
+        self.nullCount = nullCount
+        self.buffers = buffers
+        if nullCount == 0, !buffers.isEmpty {
+            self.buffers[0] = []
+        }
+    }
+
+    static func variableBytes(_ value: SQLDataType, as type: ArrowType) -> [UInt8]? {
+        switch (type, value) {
+        case (_, .null):
+            return nil
+        case (.binary, .binary(let d)), (.binary, .varbinary(let d)):
+            return [UInt8](d)
+        case (.binary, _):
+            return nil
+        case (_, .char(let s)), (_, .varchar(let s)), (_, .nchar(let s)),
+            (_, .nvarchar(let s)), (_, .text(let s)):
+            return Array(s.utf8)
+        case (_, .spatial(let wkt)):
+            return Array(wkt.value.utf8)
+        default:
+            // Mixed-type column: fall back to the textual rendering.
+            return Array(SQLResult.Value(column: "", raw: value).description.utf8)
+        }
+    }
+
+    /// Append the little-endian representation of `value`, or nothing when it does not fit `type`.
+    private static func appendFixed(_ value: SQLDataType, as type: ArrowType, to data: inout [UInt8]) {
+        switch type {
+        case .int(let bits, let signed):
+            guard let v = value.arrowInt64 else { return }
+            switch (bits, signed) {
+            case (8, false): if let x = UInt8(exactly: v) { appendLittleEndian(x, to: &data) }
+            case (16, _): if let x = Int16(exactly: v) { appendLittleEndian(x, to: &data) }
+            case (32, _): if let x = Int32(exactly: v) { appendLittleEndian(x, to: &data) }
+            default: appendLittleEndian(v, to: &data)
+            }
+        case .float:
+            guard let f = value.float else { return }
+            appendLittleEndian(f.bitPattern, to: &data)
+        case .double:
+            guard let d = value.double else { return }
+            appendLittleEndian(d.bitPattern, to: &data)
+        case .decimal128(_, let scale):
+            guard let d = value.decimal, let scaled = d.scaledInt128(scale: scale) else { return }
+            appendLittleEndian(scaled, to: &data)
+        case .date32:
+            guard let date = value.date else { return }
+            appendLittleEndian(Int32(date.daysSinceUnixEpoch), to: &data)
+        case .time32Seconds:
+            guard let t = value.time else { return }
+            appendLittleEndian(Int32(t.hour * 3600 + t.minute * 60 + t.second), to: &data)
+        case .timestampMicros(let timezone):
+            if timezone != nil, let dto = value.dateTimeOffset {
+                appendLittleEndian(dto.utcMicrosecondsSinceEpoch, to: &data)
+            } else if timezone == nil, let dt = value.dateTime {
+                appendLittleEndian(dt.microsecondsSinceEpoch, to: &data)
+            }
+        case .fixedSizeBinary(16):
+            guard let uuid = value.uuid else { return }
+            withUnsafeBytes(of: uuid.uuid) { data.append(contentsOf: $0) }
+        default:
+            return
+        }
+    }
+}
+
+@inline(__always)
+func appendLittleEndian<T: FixedWidthInteger>(_ value: T, to bytes: inout [UInt8]) {
+    for i in 0..<MemoryLayout<T>.size {
+        bytes.append(UInt8(truncatingIfNeeded: value >> (i * 8)))
+    }
+}
+
+extension SQLDataType {
+    /// Any integer case widened to `Int64`.
+    fileprivate var arrowInt64: Int64? {
+        switch self {
+        case .tinyInt(let v): return Int64(v)
+        case .smallInt(let v): return Int64(v)
+        case .integer(let v): return Int64(v)
+        case .bigInt(let v): return v
+        default: return nil
+        }
+    }
+}
+
+extension TDSDate {
+    /// Days since 1970-01-01 in the proleptic Gregorian calendar.
+    var daysSinceUnixEpoch: Int {
+        let y = month <= 2 ? year - 1 : year
+        let era = (y >= 0 ? y : y - 399) / 400
+        let yearOfEra = y - era * 400
+        let dayOfYear = (153 * ((month + 9) % 12) + 2) / 5 + day - 1
+        let dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear
+        return era * 146_097 + dayOfEra - 719_468
+    }
+}
+
+extension TDSDateTime {
+    /// Microseconds since the Unix epoch. `fractionalSecond` is read as
+    /// 100ns ticks, the `datetime2(7)` default precision.
+    var microsecondsSinceEpoch: Int64 {
+        let seconds = Int64(date.daysSinceUnixEpoch) * 86_400
+            + Int64(hour * 3600 + minute * 60 + second)
+        return seconds * 1_000_000 + Int64(fractionalSecond / 10)
+    }
+}
+
+extension TDSDateTimeOffset {
+    /// Microseconds since the Unix epoch, normalized to UTC.
+    var utcMicrosecondsSinceEpoch: Int64 {
+        let seconds = Int64(date.daysSinceUnixEpoch) * 86_400
+            + Int64(time.hour * 3600 + time.minute * 60 + time.second)
+            - Int64(offset * 60)
+        return seconds * 1_000_000 + Int64(fractionalSecond / 10)
+    }
+}
+
+extension Decimal {
+    /// `self × 10^scale` rounded to an integer, or nil when it does not fit in 128 bits.
+    func scaledInt128(scale: Int) -> Int128? {
+        var value = self
+        var scaled = Decimal()
+        guard NSDecimalMultiplyByPowerOf10(&scaled, &value, Int16(scale), .plain) == .noError
+        else { return nil }
+        let integral = scaled.rounded(scale: 0)
+
+        var magnitude: UInt128 = 0
+        let length = Int(integral._length)
+        withUnsafeBytes(of: integral._mantissa) { raw in
+            let words = raw.bindMemory(to: UInt16.self)
+            for i in stride(from: length - 1, through: 0, by: -1) {
+                magnitude = magnitude << 16 | UInt128(words[i])
+            }
+        }
+        var exponent = Int(integral._exponent)
+        while exponent > 0 {
+            let (product, overflow) = magnitude.multipliedReportingOverflow(by: 10)
+            if overflow { return nil }
+            magnitude = product
+            exponent -= 1
+        }
+        guard magnitude <= UInt128(Int128.max) else { return nil }
+        return integral._isNegative != 0 ? -Int128(magnitude) : Int128(magnitude)
+    }
+}
+
+// MARK: - IPC writer
+
+/// Writes Arrow IPC messages into an output buffer that callers drain to
+/// their sink (file handle or in-memory `Data`) between record batches.
+struct ArrowIPCWriter {
+    private static let magic: [UInt8] = Array("ARROW1".utf8)
+    private static let continuation: UInt32 = 0xFFFF_FFFF
+    private static let metadataVersionV5: Int16 = 4
+
+    struct Field {
+        var name: String
+        var type: ArrowType
+    }
+
+    struct Block {
+        var offset: Int
+        var metadataLength: Int
+        var bodyLength: Int
+    }
+
+    let format: ArrowIPCFormat
+    private(set) var fields: [Field]? = nil
+    private(set) var rowCount = 0
+    private var output: [UInt8] = []
+    private var position = 0
+    private var blocks: [Block] = []
+
+    init(format: ArrowIPCFormat) {
+        self.format = format
+    }
+
+    /// Hand over bytes written since the last call.
+    mutating func drain() -> Data {
+        defer { output.removeAll(keepingCapacity: true) }
+        return Data(output)
+    }
+
+    /// Append one record batch of column-major values. The first batch fixes the
+    /// schema: a column takes its entry in `types` when there is one, otherwise a
+    /// type inferred from its values.
+    mutating func write(columns names: [String], values: [[SQLDataType]], types: [ArrowType?] = []) {
+        if fields == nil {
+            let chosen = zip(names, values).enumerated().map { j, column in
+                let known = types.indices.contains(j) ? types[j] : nil
+                return Field(name: column.0, type: known ?? ArrowType(inferringFrom: column.1))
+            }
+            writeSchema(chosen)
+        }
+        guard let fields = fields else { return }
+        writeBatch(zip(fields, values).map { ArrowEncodedColumn($1, as: $0.type) })
+    }
+
+    /// Append one record batch of columns already encoded as `fields`. The first
+    /// batch fixes the schema.
+    mutating func write(fields: [Field], columns: [ArrowEncodedColumn]) {
+        if self.fields == nil {
+            writeSchema(fields)
+        }
+        writeBatch(columns)
+    }
+
+    private mutating func writeBatch(_ columns: [ArrowEncodedColumn]) {
+        let length = columns.first?.length ?? 0
+        var nodes: [(Int64, Int64)] = []
+        var bufferSpecs: [(Int64, Int64)] = []
+        var body: [UInt8] = []
+        for encoded in columns {
+            nodes.append((Int64(encoded.length), Int64(encoded.nullCount)))
+            for buffer in encoded.buffers {
+                bufferSpecs.append((Int64(body.count), Int64(buffer.count)))
+                body.append(contentsOf: buffer)
+                body.append(contentsOf: repeatElement(0, count: ArrowIPCWriter.padding(body.count)))
+            }
+        }
+
+        var fbb = FlatBufferBuilder()
+        let buffersVector = fbb.createInt64PairVector(bufferSpecs)
+        let nodesVector = fbb.createInt64PairVector(nodes)
+        fbb.startTable()
+        fbb.addField(0, Int64(length))
+        fbb.addOffsetField(1, nodesVector)
+        fbb.addOffsetField(2, buffersVector)
+        let batch = fbb.endTable()
+        let message = ArrowIPCWriter.message(&fbb, headerType: 3, header: batch, bodyLength: body.count)
+
+        let offset = position
+        let metadataLength = writeEncapsulated(message)
+        emit(body)
+        blocks.append(Block(offset: offset, metadataLength: metadataLength, bodyLength: body.count))
+        rowCount += length
+    }
+
+    /// Write the end-of-stream marker and, for the file format, the footer.
+    mutating func finish() {
+        if fields == nil { writeSchema([]) }
+        emit(littleEndian: ArrowIPCWriter.continuation)
+        emit(littleEndian: UInt32(0))
+        guard format == .file, let fields = fields else { return }
+
+        var fbb = FlatBufferBuilder()
+        let schema = ArrowIPCWriter.schema(&fbb, fields)
+        let recordBatches = fbb.createBlockVector(blocks)
+        let dictionaries = fbb.createBlockVector([])
+        fbb.startTable()
+        fbb.addField(0, ArrowIPCWriter.metadataVersionV5)
+        fbb.addOffsetField(1, schema)
+        fbb.addOffsetField(2, dictionaries)
+        fbb.addOffsetField(3, recordBatches)
+        let table = fbb.endTable()
+        let footer = fbb.finish(table)
+
+        emit(footer)
+        emit(littleEndian: Int32(footer.count))
+        emit(ArrowIPCWriter.magic)
+    }
+
+    private mutating func writeSchema(_ fields: [Field]) {
+        self.fields = fields
+        if format == .file {
+            emit(ArrowIPCWriter.magic)
+            emit([0, 0])
+        }
+        var fbb = FlatBufferBuilder()
+        let schema = ArrowIPCWriter.schema(&fbb, fields)
+        let message = ArrowIPCWriter.message(&fbb, headerType: 1, header: schema, bodyLength: 0)
+        _ = writeEncapsulated(message)
+    }
+
+    /// Continuation marker, metadata length, flatbuffer and padding. Returns the
+    /// total prefix + metadata length recorded in file footer blocks.
+    private mutating func writeEncapsulated(_ metadata: [UInt8]) -> Int {
+        let padded = metadata.count + ArrowIPCWriter.padding(metadata.count)
+        emit(littleEndian: ArrowIPCWriter.continuation)
+        emit(littleEndian: Int32(padded))
+        emit(metadata)
+        emit([UInt8](repeating: 0, count: padded - metadata.count))
+        return 8 + padded
+    }
+
+    private mutating func emit(_ bytes: [UInt8]) {
+        output.append(contentsOf: bytes)
+        position += bytes.count
+    }
+
+    private mutating func emit<T: FixedWidthInteger>(littleEndian value: T) {
+        appendLittleEndian(value, to: &output)
+        position += MemoryLayout<T>.size
+    }
+
+    private static func padding(_ count: Int) -> Int {
+        (8 - count % 8) % 8
+    }
+
+    private static func message(
+        _ fbb: inout FlatBufferBuilder,
+        headerType: UInt8,
+        header: Int,
+        bodyLength: Int
+    ) -> [UInt8] {
+        fbb.startTable()
+        fbb.addField(0, metadataVersionV5)
+        fbb.addField(1, headerType)
+        fbb.addOffsetField(2, header)
+        fbb.addField(3, Int64(bodyLength))
+        let table = fbb.endTable()
+        return fbb.finish(table)
+    }
+
+    private static func schema(_ fbb: inout FlatBufferBuilder, _ fields: [Field]) -> Int {
+        var fieldOffsets: [Int] = []
+        for field in fields {
+            let name = fbb.createString(field.name)
+            let type = typeTable(&fbb, field.type)
+            let children = fbb.createOffsetVector([])
+            fbb.startTable()
+            fbb.addOffsetField(0, name)
+            fbb.addField(1, UInt8(1))  // nullable
+            fbb.addField(2, field.type.unionType)
+            fbb.addOffsetField(3, type)
+            fbb.addOffsetField(5, children)
+            fieldOffsets.append(fbb.endTable())
+        }
+        let fieldsVector = fbb.createOffsetVector(fieldOffsets)
+        fbb.startTable()
+        fbb.addField(0, Int16(0))  // little endian
+        fbb.addOffsetField(1, fieldsVector)
+        return fbb.endTable()
+    }
+
+    private static func typeTable(_ fbb: inout FlatBufferBuilder, _ type: ArrowType) -> Int {
+        var timezone: Int? = nil
+        if case .timestampMicros(let tz?) = type {
+            timezone = fbb.createString(tz)
+        }
+        fbb.startTable()
+        switch type {
+        case .int(let bits, let signed):
+            fbb.addField(0, Int32(bits))
+            fbb.addField(1, UInt8(signed ? 1 : 0))
+        case .float:
+            fbb.addField(0, Int16(1))  // SINGLE
+        case .double:
+            fbb.addField(0, Int16(2))  // DOUBLE
+        case .decimal128(let precision, let scale):
+            fbb.addField(0, Int32(precision))
+            fbb.addField(1, Int32(scale))
+            fbb.addField(2, Int32(128))
+        case .date32:
+            fbb.addField(0, Int16(0))  // DateUnit.DAY
+        case .time32Seconds:
+            fbb.addField(0, Int16(0))  // TimeUnit.SECOND
+            fbb.addField(1, Int32(32))
+        case .timestampMicros:
+            fbb.addField(0, Int16(2))  // TimeUnit.MICROSECOND
+            if let timezone { fbb.addOffsetField(1, timezone) }
+        case .fixedSizeBinary(let width):
+            fbb.addField(0, Int32(width))
+        case .bool, .binary, .utf8:
+            break
+        }
+        return fbb.endTable()
+    }
+}
+
+// MARK: - FlatBuffers
+
+/// Minimal back-to-front FlatBuffers builder covering the tables, strings and
+/// vectors that Arrow IPC metadata (Message.fbs, Schema.fbs, File.fbs) needs.
+/// Offsets are measured from the end of the buffer, as in the reference builders.
+struct FlatBufferBuilder {
+    private var storage: [UInt8]
+    private var head: Int
+    private var minAlign = 1
+    private var vtable: [Int] = []
+    private var tableStart = 0
+
+    init(capacity: Int = 1024) {
+        storage = [UInt8](repeating: 0, count: capacity)
+        head = capacity
+    }
+
+    var offset: Int { storage.count - head }
+
+    mutating func startTable() {
+        vtable = []
+        tableStart = offset
+    }
+
+    mutating func addField<T: FixedWidthInteger>(_ slot: Int, _ value: T) {
+        prepend(value)
+        track(slot)
+    }
+
+    mutating func addOffsetField(_ slot: Int, _ target: Int) {
+        prependOffset(target)
+        track(slot)
+    }
+
+    /// Write the table's vtable and patch the table's vtable offset. Returns the table offset.
+    mutating func endTable() -> Int {
+        prepend(Int32(0))
+        let tableOffset = offset
+        for fieldOffset in vtable.reversed() {
+            put(UInt16(fieldOffset == 0 ? 0 : tableOffset - fieldOffset))
+        }
+        put(UInt16(tableOffset - tableStart))
+        put(UInt16(4 + 2 * vtable.count))
+        let vtableOffset = offset
+
+        let tablePosition = storage.count - tableOffset
+        let soffset = Int32(vtableOffset - tableOffset)
+        for i in 0..<4 {
+            storage[tablePosition + i] = UInt8(truncatingIfNeeded: soffset >> (i * 8))
+        }
+        return tableOffset
+    }
+
+    mutating func createString(_ string: String) -> Int {
+        let bytes = Array(string.utf8)
+        align(4, additional: bytes.count + 1)
+        put(UInt8(0))
+        reserve(bytes.count)
+        head -= bytes.count
+        storage.replaceSubrange(head..<(head + bytes.count), with: bytes)
+        put(UInt32(bytes.count))
+        return offset
+    }
+
+    mutating func createOffsetVector(_ targets: [Int]) -> Int {
+        align(4, additional: 4 * targets.count)
+        for target in targets.reversed() {
+            prependOffset(target)
+        }
+        put(UInt32(targets.count))
+        return offset
+    }
+
+    /// Vector of 16-byte structs made of two `long`s (FieldNode, Buffer).
+    mutating func createInt64PairVector(_ pairs: [(Int64, Int64)]) -> Int {
+        align(4, additional: 16 * pairs.count)
+        align(8, additional: 16 * pairs.count)
+        for (first, second) in pairs.reversed() {
+            put(second)
+            put(first)
+        }
+        put(UInt32(pairs.count))
+        return offset
+    }
+
+    /// Vector of File.fbs `Block` structs: `long offset; int metaDataLength; long bodyLength`.
+    mutating func createBlockVector(_ blocks: [ArrowIPCWriter.Block]) -> Int {
+        align(4, additional: 24 * blocks.count)
+        align(8, additional: 24 * blocks.count)
+        for block in blocks.reversed() {
+            put(Int64(block.bodyLength))
+            put(UInt32(0))
+            put(Int32(block.metadataLength))
+            put(Int64(block.offset))
+        }
+        put(UInt32(blocks.count))
+        return offset
+    }
+
+    /// Prefix the root table offset and return the finished buffer.
+    mutating func finish(_ root: Int) -> [UInt8] {
+        align(max(minAlign, 4), additional: 4)
+        prependOffset(root)
+        return Array(storage[head...])
+    }
+
+    private mutating func track(_ slot: Int) {
+        if vtable.count <= slot {
+            vtable.append(contentsOf: repeatElement(0, count: slot + 1 - vtable.count))
+        }
+        vtable[slot] = offset
+    }
+
+    private mutating func prepend<T: FixedWidthInteger>(_ value: T) {
+        align(MemoryLayout<T>.size)
+        put(value)
+    }
+
+    private mutating func prependOffset(_ target: Int) {
+        align(4)
+        put(UInt32(offset - target + 4))
+    }
+
+    private mutating func align(_ size: Int, additional: Int = 0) {
+        minAlign = max(minAlign, size)
+        let padding = (size - (offset + additional) % size) % size
+        reserve(padding)
+        for _ in 0..<padding {
+            head -= 1
+            storage[head] = 0
+        }
+    }
+
+    private mutating func put<T: FixedWidthInteger>(_ value: T) {
+        let size = MemoryLayout<T>.size
+        reserve(size)
+        head -= size
+        for i in 0..<size {
+            storage[head + i] = UInt8(truncatingIfNeeded: value >> (i * 8))
+        }
+    }
+
+    /// Grow the buffer at the front so that `count` more bytes can be prepended.
+    private mutating func reserve(_ count: Int) {
+        guard head < count else { return }
+        let used = storage.count - head
+        var newCount = max(storage.count * 2, 64)
+        while newCount - used < count { newCount *= 2 }
+        var grown = [UInt8](repeating: 0, count: newCount)
+        grown.replaceSubrange((newCount - used)..<newCount, with: storage[head...])
+        storage = grown
+        head = newCount - used
+    }
+}
@@ -0,0 +1,377 @@
+//
+//  BinaryValueCodec.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+/// One-byte type tags written in front of binary-encoded values. The numbering is
+/// part of the on-disk formats: only ever append new cases.
+enum BinaryValueTag: UInt8 {
+    /// The row has no entry for the column at all, as opposed to SQL NULL.
+    case absent = 0
+    case null
+    case uniqueidentifier
+    case char
+    case varchar
+    case nchar
+    case nvarchar
+    case text
+    case numeric
+    case decimal
+    case money
+    case integer
+    case smallInt
+    case bigInt
+    case tinyInt
+    case float
+    case real
+    case double
+    case date
+    case time
+    case datetime
+    case smalldatetime
+    case datetime2
+    case datetimeoffset
+    case bit
+    case binary
+    case varbinary
+    case spatial
+
+    init(_ value: SQLDataType) {
+        switch value {
+        case .uniqueidentifier: self = .uniqueidentifier
+        case .char: self = .char
+        case .varchar: self = .varchar
+        case .nchar: self = .nchar
+        case .nvarchar: self = .nvarchar
+        case .text: self = .text
+        case .numeric: self = .numeric
+        case .decimal: self = .decimal
+        case .money: self = .money
+        case .integer: self = .integer
+        case .smallInt: self = .smallInt
+        case .bigInt: self = .bigInt
+        case .tinyInt: self = .tinyInt
+        case .float: self = .float
+        case .real: self = .real
+        case .double: self = .double
+        case .date: self = .date
+        case .time: self = .time
+        case .datetime: self = .datetime
+        case .smalldatetime: self = .smalldatetime
+        case .datetime2: self = .datetime2
+        case .datetimeoffset: self = .datetimeoffset
+        case .bit: self = .bit
+        case .binary: self = .binary
+        case .varbinary: self = .varbinary
+        case .spatial: self = .spatial
+        case .null: self = .null
+        }
+    }
+}
+
+/// Thrown when binary-encoded data is truncated or malformed.
+public struct BinaryDecodingError: Error, CustomStringConvertible {
+    public let description: String
+}
+
+// MARK: - Writing
+
+/// Appends values to a byte buffer. Integers are little-endian; lengths and the
+/// integer fields of the date types are (zigzag) LEB128 varints.
+struct BinaryWriter {
+    var bytes: [UInt8] = []
+
+    mutating func write(_ byte: UInt8) {
+        bytes.append(byte)
+    }
+
+    mutating func write<T: FixedWidthInteger>(fixed value: T) {
+        withUnsafeBytes(of: value.littleEndian) { bytes.append(contentsOf: $0) }
+    }
+
+    mutating func write(varint value: UInt64) {
+        var value = value
+        while value >= 0x80 {
+            bytes.append(UInt8(truncatingIfNeeded: value) | 0x80)
+            value >>= 7
+        }
+        bytes.append(UInt8(value))
+    }
+
+    mutating func write(signed value: Int) {
+        let value = Int64(value)
+        write(varint: UInt64(bitPattern: (value << 1) ^ (value >> 63)))
+    }
+
+    mutating func write(_ string: String) {
+        var string = string
+        string.withUTF8 { utf8 in
+            write(varint: UInt64(utf8.count))
+            bytes.append(contentsOf: utf8)
+        }
+    }
+
+    mutating func write(_ data: Data) {
+        write(varint: UInt64(data.count))
+        bytes.append(contentsOf: data)
+    }
+
+    /// Write `value` preceded by its tag.
+    mutating func write(_ value: SQLDataType) {
+        write(BinaryValueTag(value).rawValue)
+        write(payloadOf: value)
+    }
+
+    /// Write `value` without its tag, for readers that already know the type.
+    mutating func write(payloadOf value: SQLDataType) {
+        switch value {
+        case .uniqueidentifier(let uuid):
+            withUnsafeBytes(of: uuid.uuid) { bytes.append(contentsOf: $0) }
+        case .char(let s), .varchar(let s), .nchar(let s), .nvarchar(let s), .text(let s):
+            write(s)
+        case .numeric(let d), .decimal(let d), .money(let d):
+            write(d)
+        case .integer(let i):
+            write(signed: i)
+        case .smallInt(let i):
+            write(fixed: i)
+        case .bigInt(let i):
+            write(fixed: i)
+        case .tinyInt(let i):
+            write(i)
+        case .float(let f), .real(let f):
+            write(fixed: f.bitPattern)
+        case .double(let d):
+            write(fixed: d.bitPattern)
+        case .date(let date):
+            write(date)
+        case .time(let time):
+            write(time)
+        case .datetime(let dt), .smalldatetime(let dt), .datetime2(let dt):
+            write(dt.date)
+            write(signed: dt.hour)
+            write(signed: dt.minute)
+            write(signed: dt.second)
+            write(signed: dt.fractionalSecond)
+        case .datetimeoffset(let dto):
+            write(dto.date)
+            write(dto.time)
+            write(signed: dto.fractionalSecond)
+            write(signed: dto.offset)
+        case .bit(let b):
+            write(b ? 1 : 0)
+        case .binary(let data), .varbinary(let data):
+            write(data)
+        case .spatial(let wkt):
+            write(wkt.value)
+        case .null:
+            break
+        }
+    }
+
+    /// Decimals keep their exact mantissa and exponent, including NaN.
+    private mutating func write(_ decimal: Decimal) {
+        write(signed: Int(decimal._exponent))
+        let length = Int(decimal._length)
+        write(UInt8(length) | UInt8(decimal._isNegative << 4) | UInt8(decimal._isCompact << 5))
+        withUnsafeBytes(of: decimal._mantissa) { raw in
+            for i in 0..<length {
+                write(fixed: raw.loadUnaligned(fromByteOffset: i * 2, as: UInt16.self))
+            }
+        }
+    }
+
+    private mutating func write(_ date: TDSDate) {
+        write(signed: date.year)
+        write(signed: date.month)
+        write(signed: date.day)
+    }
+
+    private mutating func write(_ time: TDSTime) {
+        write(signed: time.hour)
+        write(signed: time.minute)
+        write(signed: time.second)
+    }
+}
+
+// MARK: - Reading
+
+/// Reads values written by `BinaryWriter` from a borrowed buffer.
+struct BinaryReader {
+    let buffer: UnsafeRawBufferPointer
+    var offset: Int
+
+    init(_ buffer: UnsafeRawBufferPointer, offset: Int = 0) {
+        self.buffer = buffer
+        self.offset = offset
+    }
+
+    var isAtEnd: Bool { offset >= buffer.count }
+
+    private func ensure(_ count: Int) throws {
+        guard count >= 0, buffer.count - offset >= count else {
+            throw BinaryDecodingError(description: "Unexpected end of data at byte \(offset)")
+        }
+    }
+
+    mutating func readByte() throws -> UInt8 {
+        try ensure(1)
+        defer { offset += 1 }
+        return buffer[offset]
+    }
+
+    mutating func read<T: FixedWidthInteger>(fixed type: T.Type) throws -> T {
+        try ensure(MemoryLayout<T>.size)
+        defer { offset += MemoryLayout<T>.size }
+        return T(littleEndian: buffer.loadUnaligned(fromByteOffset: offset, as: T.self))
+    }
+
+    mutating func readVarint() throws -> UInt64 {
+        var result: UInt64 = 0
+        var shift: UInt64 = 0
+        while true {
+            let byte = try readByte()
+            if shift == 63 && byte > 1 {
+                throw BinaryDecodingError(description: "Varint overflows 64 bits at byte \(offset)")
+            }
+            result |= UInt64(byte & 0x7F) << shift
+            if byte & 0x80 == 0 { return result }
+            shift += 7
+        }
+    }
+
+    mutating func readSigned() throws -> Int {
+        let raw = try readVarint()
+        let value = Int64(bitPattern: (raw >> 1) ^ (0 &- (raw & 1)))
+        guard let int = Int(exactly: value) else {
+            throw BinaryDecodingError(description: "Integer out of range at byte \(offset)")
+        }
+        return int
+    }
+
+    mutating func readLength() throws -> Int {
+        let length = try readVarint()
+        guard length <= UInt64(buffer.count - offset) else {
+            throw BinaryDecodingError(description: "Length \(length) runs past the end at byte \(offset)")
+        }
+        return Int(length)
+    }
+
+    mutating func readBytes(_ count: Int) throws -> UnsafeRawBufferPointer {
+        try ensure(count)
+        defer { offset += count }
+        return UnsafeRawBufferPointer(rebasing: buffer[offset..<offset + count])
+    }
+
+    mutating func readString() throws -> String {
+        String(decoding: try readBytes(try readLength()), as: UTF8.self)
+    }
+
+    mutating func readData() throws -> Data {
+        Data(try readBytes(try readLength()))
+    }
+
+    mutating func readTag() throws -> BinaryValueTag {
+        let raw = try readByte()
+        guard let tag = BinaryValueTag(rawValue: raw) else {
+            throw BinaryDecodingError(description: "Unknown value tag \(raw) at byte \(offset - 1)")
+        }
+        return tag
+    }
+
+    /// Read a tagged value. Returns `nil` for `.absent`.
+    mutating func readValue() throws -> SQLDataType? {
+        try readPayload(of: try readTag())
+    }
+
+    /// Read the payload of a value whose tag is already known.
+    mutating func readPayload(of tag: BinaryValueTag) throws -> SQLDataType? {
+        switch tag {
+        case .absent: return nil
+        case .null: return .null
+        case .uniqueidentifier:
+            try ensure(16)
+            defer { offset += 16 }
+            return .uniqueidentifier(UUID(uuid: buffer.loadUnaligned(fromByteOffset: offset, as: uuid_t.self)))
+        case .char: return .char(try readString())
+        case .varchar: return .varchar(try readString())
+        case .nchar: return .nchar(try readString())
+        case .nvarchar: return .nvarchar(try readString())
+        case .text: return .text(try readString())
+        case .numeric: return .numeric(try readDecimal())
+        case .decimal: return .decimal(try readDecimal())
+        case .money: return .money(try readDecimal())
+        case .integer: return .integer(try readSigned())
+        case .smallInt: return .smallInt(try read(fixed: Int16.self))
+        case .bigInt: return .bigInt(try read(fixed: Int64.self))
+        case .tinyInt: return .tinyInt(try readByte())
+        case .float: return .float(Float(bitPattern: try read(fixed: UInt32.self)))
+        case .real: return .real(Float(bitPattern: try read(fixed: UInt32.self)))
+        case .double: return .double(Double(bitPattern: try read(fixed: UInt64.self)))
+        case .date: return .date(try readDate())
+        case .time: return .time(try readTime())
+        case .datetime: return .datetime(try readDateTime())
+        case .smalldatetime: return .smalldatetime(try readDateTime())
+        case .datetime2: return .datetime2(try readDateTime())
+        case .datetimeoffset:
+            return .datetimeoffset(
+                TDSDateTimeOffset(
+                    date: try readDate(),
+                    time: try readTime(),
+                    fractionalSecond: try readSigned(),
+                    offset: try readSigned()
+                )
+            )
+        case .bit: return .bit(try readByte() != 0)
+        case .binary: return .binary(try readData())
+        case .varbinary: return .varbinary(try readData())
+        case .spatial: return .spatial(SQLDataType.WKTString(value: try readString()))
+        }
+    }
+
+    private mutating func readDecimal() throws -> Decimal {
+        let exponent = try readSigned()
+        let flags = try readByte()
+        let length = Int(flags & 0x0F)
+        guard length <= 8, let exponent = Int32(exactly: exponent) else {
+            throw BinaryDecodingError(description: "Malformed decimal at byte \(offset)")
+        }
+        var mantissa: (UInt16, UInt16, UInt16, UInt16, UInt16, UInt16, UInt16, UInt16) =
+            (0, 0, 0, 0, 0, 0, 0, 0)
+        try withUnsafeMutableBytes(of: &mantissa) { raw in
+            for i in 0..<length {
+                raw.storeBytes(of: try read(fixed: UInt16.self), toByteOffset: i * 2, as: UInt16.self)
+            }
+        }
+        return Decimal(
+            _exponent: exponent,
+            _length: UInt32(length),
+            _isNegative: UInt32(flags >> 4 & 1),
+            _isCompact: UInt32(flags >> 5 & 1),
+            _reserved: 0,
+            _mantissa: mantissa
+        )
+    }
+
+    private mutating func readDate() throws -> TDSDate {
+        let year = try readSigned()
+        let month = try readSigned()
+        return TDSDate(day: try readSigned(), month: month, year: year)
+    }
+
+    private mutating func readTime() throws -> TDSTime {
+        TDSTime(hour: try readSigned(), minute: try readSigned(), second: try readSigned())
+    }
+
+    private mutating func readDateTime() throws -> TDSDateTime {
+        TDSDateTime(
+            date: try readDate(),
+            hour: try readSigned(),
+            minute: try readSigned(),
+            second: try readSigned(),
+            fractionalSecond: try readSigned()
+        )
+    }
+}
@@ -0,0 +1,233 @@
+//
+//  BoundedStreamBuffer.swift
+//  FreeTDSKit
+//
+
+import Synchronization
+
+/// A fixed-capacity FIFO between producing tasks and one consuming iterator.
+///
+/// `send(_:)` suspends the producer while the buffer is full, so a slow consumer
+/// holds back the producer instead of letting elements pile up. Several tasks may
+/// send at once; they wait their turn for free slots in the order they arrived. The consumer side
+/// is exposed as an `AsyncThrowingStream` through `stream`. Cancelling the consuming
+/// task, or releasing the stream before it finishes, cancels the buffer: buffered
+/// elements are dropped, `send(_:)` returns `false` and the cancellation handler runs.
+final class BoundedStreamBuffer<Element: Sendable>: Sendable {
+    /// Most elements held at once.
+    let capacity: Int
+
+    private let state: Mutex<State>
+
+    init(capacity: Int) {
+        precondition(capacity > 0, "BoundedStreamBuffer needs room for at least one element")
+        self.capacity = capacity
+        self.state = Mutex(State(capacity: capacity))
+    }
+
+    /// Elements currently waiting for the consumer.
+    var count: Int {
+        state.withLock { $0.count }
+    }
+
+    /// Whether the consumer has gone away.
+    var isCancelled: Bool {
+        state.withLock { $0.isCancelled }
+    }
+
+    /// The consumer side. Iterate it from a single task.
+    var stream: AsyncThrowingStream<Element, Error> {
+        let consumer = Consumer(self)
+        return AsyncThrowingStream { try await consumer.buffer.next() }
+    }
+
+    /// Run `handler` once when the buffer is cancelled, or now if it already was.
+    func onCancel(_ handler: @escaping @Sendable () -> Void) {
+        let runNow = state.withLock { state -> Bool in
+            if state.isCancelled { return true }
+            state.cancelHandler = handler
+            return false
+        }
+        if runNow { handler() }
+    }
+
+    /// Hand `element` to the consumer, waiting while the buffer is full. Returns
+    /// `false`, dropping the element, once the buffer has been cancelled.
+    func send(_ element: Element) async -> Bool {
+        while true {
+            let action = state.withLock { state -> SendAction in
+                if state.isCancelled { return .stop }
+                if let consumer = state.consumer {
+                    state.consumer = nil
+                    return .deliver(consumer)
+                }
+                if state.count < capacity {
+                    state.append(element)
+                    return .done
+                }
+                return .wait
+            }
+            switch action {
+            case .stop:
+                return false
+            case .done:
+                return true
+            case .deliver(let consumer):
+                consumer.resume(returning: element)
+                return true
+            case .wait:
+                await withCheckedContinuation { (producer: CheckedContinuation<Void, Never>) in
+                    let resumeNow = state.withLock { state -> Bool in
+                        if state.isCancelled || state.count < capacity { return true }
+                        state.producers.append(producer)
+                        return false
+                    }
+                    if resumeNow { producer.resume() }
+                }
+            }
+        }
+    }
+
+    /// End the stream after the buffered elements, with `error` if given.
+    func finish(throwing error: Error? = nil) {
+        let consumer = state.withLock { state -> CheckedContinuation<Element?, Error>? in
+            guard state.ending == nil else { return nil }
+            guard let consumer = state.consumer else {
+                state.ending = error.map { .failure($0) } ?? .success(())
+                return nil
+            }
+            // The waiting consumer is told directly; later calls just see the end.
+            state.ending = .success(())
+            state.consumer = nil
+            return consumer
+        }
+        if let error {
+            consumer?.resume(throwing: error)
+        } else {
+            consumer?.resume(returning: nil)
+        }
+    }
+
+    /// Drop buffered elements, end the stream and stop the producers. The cancellation
+    /// handler only runs if the producers had not finished yet.
+    func cancel() {
+        let (consumer, producers, handler) = state.withLock { state -> CancelAction in
+            if state.isCancelled { return (nil, [], nil) }
+            state.isCancelled = true
+            state.removeAll()
+            // A producer that already finished has nothing left to stop.
+            let handler = state.ending == nil ? state.cancelHandler : nil
+            defer {
+                state.consumer = nil
+                state.producers = []
+                state.cancelHandler = nil
+            }
+            return (state.consumer, state.producers, handler)
+        }
+        consumer?.resume(returning: nil)
+        producers.forEach { $0.resume() }
+        handler?()
+    }
+
+    func next() async throws -> Element? {
+        try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { consumer in
+                let action = state.withLock { state -> NextAction in
+                    if let element = state.removeFirst() {
+                        let producer = state.producers.isEmpty ? nil : state.producers.removeFirst()
+                        return .element(element, producer)
+                    }
+                    if state.isCancelled { return .end(nil) }
+                    if let ending = state.ending {
+                        // Report a failure once; later calls just see the end.
+                        state.ending = .success(())
+                        if case .failure(let error) = ending { return .end(error) }
+                        return .end(nil)
+                    }
+                    state.consumer = consumer
+                    return .wait
+                }
+                switch action {
+                case .element(let element, let producer):
+                    producer?.resume()
+                    consumer.resume(returning: element)
+                case .end(let error?):
+                    consumer.resume(throwing: error)
+                case .end(nil):
+                    consumer.resume(returning: nil)
+                case .wait:
+                    break
+                }
+            }
+        } onCancel: {
+            cancel()
+        }
+    }
+
+    private enum SendAction {
+        case stop
+        case done
+        case deliver(CheckedContinuation<Element?, Error>)
+        case wait
+    }
+
+    private typealias CancelAction = (
+        consumer: CheckedContinuation<Element?, Error>?,
+        producers: [CheckedContinuation<Void, Never>],
+        handler: (@Sendable () -> Void)?
+    )
+
+    private enum NextAction {
+        case element(Element, CheckedContinuation<Void, Never>?)
+        case end(Error?)
+        case wait
+    }
+
+    private struct State {
+        // Ring of `capacity` slots; `count` of them from `head` are occupied.
+        var elements: [Element?]
+        var head = 0
+        var count = 0
+        var ending: Result<Void, Error>?
+        var isCancelled = false
+        var consumer: CheckedContinuation<Element?, Error>?
+        // Senders waiting for a free slot, oldest first.
+        var producers: [CheckedContinuation<Void, Never>] = []
+        var cancelHandler: (@Sendable () -> Void)?
+
+        init(capacity: Int) {
+            elements = Array(repeating: nil, count: capacity)
+        }
+
+        mutating func append(_ element: Element) {
+            elements[(head + count) % elements.count] = element
+            count += 1
+        }
+
+        mutating func removeFirst() -> Element? {
+            guard count > 0 else { return nil }
+            let element = elements[head]
+            elements[head] = nil
+            head = (head + 1) % elements.count
+            count -= 1
+            return element
+        }
+
+        mutating func removeAll() {
+            while removeFirst() != nil {}
+        }
+    }
+
+    /// Cancels the buffer when the stream that owns it is released.
+    private final class Consumer: Sendable {
+        let buffer: BoundedStreamBuffer
+
+        init(_ buffer: BoundedStreamBuffer) {
+            self.buffer = buffer
+        }
+
+        deinit {
+            buffer.cancel()
+        }
+    }
+}
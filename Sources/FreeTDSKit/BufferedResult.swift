@@ -0,0 +1,248 @@
+//
+//  BufferedResult.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+import Synchronization
+
+extension TDSConnection {
+
+    /// Run `queryString` with DB-Library row buffering and hand `body` a
+    /// random-access view of its first result set.
+    ///
+    /// Rows are read from the server only as far as `body` asks for them. At most
+    /// `windowSize` of them stay buffered; reading further ahead drops the oldest.
+    /// Cells are decoded when they are accessed, not when they arrive. The
+    /// connection is busy with the query until `body` returns.
+    public nonisolated func withBufferedResult<T>(
+        queryString: String,
+        windowSize: Int = 1_000,
+        isolation: isolated (any Actor)? = #isolation,
+        _ body: (BufferedResult) async throws -> T
+    ) async throws -> T {
+        let windowSize = max(1, windowSize)
+        await beginCommand()
+        let result: BufferedResult
+        do {
+            let session = try await liveConnection()
+            let schema = try await runOnSession(session) { conn in
+                try BufferedResult.open(conn, queryString: queryString, windowSize: windowSize)
+            }
+            result = BufferedResult(
+                connection: self,
+                session: session,
+                schema: schema,
+                windowSize: windowSize
+            )
+        } catch {
+            await endCommand()
+            throw error
+        }
+
+        do {
+            let value = try await body(result)
+            await result.close()
+            await endCommand()
+            return value
+        } catch {
+            await result.close()
+            await endCommand()
+            throw error
+        }
+    }
+}
+
+/// A window onto a result set whose rows stay in DB-Library's row buffer until
+/// they are read. Handed out by `TDSConnection.withBufferedResult`.
+///
+/// Row indices are zero-based. Moving forward past the window reads more rows from
+/// the server; moving back before it is an error, because the rows have been
+/// discarded. Use a `windowSize` that covers how far back readers scroll.
+public final class BufferedResult: Sendable {
+    /// Column names, in result order.
+    public let columns: [String]
+    /// Types, precision and nullability of the columns.
+    public let schema: ResultSchema
+    /// Most rows held in the buffer at once.
+    public let windowSize: Int
+
+    private let connection: TDSConnection
+    private let session: Int
+    private let encoding: String.Encoding
+    // Held while the DB-Library row buffer is in use.
+    private let bufferLock = NSLock()
+    private let state = Mutex(State())
+
+    private struct State {
+        var window: Range<Int> = 0..<0
+        var rowCount: Int?
+        var isClosed = false
+    }
+
+    init(connection: TDSConnection, session: Int, schema: ResultSchema, windowSize: Int) {
+        self.connection = connection
+        self.session = session
+        self.schema = schema
+        self.columns = schema.names
+        self.windowSize = windowSize
+        self.encoding = connection.textEncoding
+    }
+
+    /// Indices of the rows currently buffered.
+    public var window: Range<Int> {
+        state.withLock { $0.window }
+    }
+
+    /// Total number of rows, known once a read has reached the end.
+    public var rowCount: Int? {
+        state.withLock { $0.rowCount }
+    }
+
+    /// Value of `column` in row `row`, or `nil` past the last row or for an
+    /// unknown column.
+    public func value(row: Int, column: String) async throws -> SQLDataType? {
+        guard let index = columns.firstIndex(of: column) else { return nil }
+        return try await value(row: row, column: index)
+    }
+
+    /// Value of the column at `column` in row `row`, or `nil` past the last row.
+    public func value(row: Int, column: Int) async throws -> SQLDataType? {
+        guard columns.indices.contains(column) else { return nil }
+        return try await read(row: row, columns: [column])?.first ?? nil
+    }
+
+    /// Row `row` keyed by column name, or `nil` past the last row.
+    public func row(_ row: Int) async throws -> [String: SQLDataType]? {
+        guard let values = try await read(row: row, columns: Array(columns.indices)) else {
+            return nil
+        }
+        var dict: [String: SQLDataType] = [:]
+        for (name, value) in zip(columns, values) {
+            if let value { dict[name] = value }
+        }
+        return dict
+    }
+
+    /// Read ahead so that `row` is buffered. Returns `false` if the result has
+    /// fewer rows.
+    @discardableResult
+    public func prefetch(through row: Int) async throws -> Bool {
+        try await read(row: row, columns: []) != nil
+    }
+
+    // MARK: - Buffer access
+
+    /// Decode `columns` of row `row`, or return `nil` when the result set ends
+    /// before it.
+    private func read(row: Int, columns: [Int]) async throws -> [SQLDataType?]? {
+        precondition(row >= 0, "Row indices start at 0")
+        if let count = rowCount, row >= count { return nil }
+        if state.withLock({ $0.isClosed }) {
+            throw TDSConnectionError.queryExecutionFailed(reason: "Buffered result is closed")
+        }
+
+        let encoding = encoding
+        let bufferLock = bufferLock
+        let outcome = try await connection.runOnSession(session) { conn -> ReadOutcome in
+            bufferLock.lock()
+            defer { bufferLock.unlock() }
+
+            let rowNumber = Int32(row + 1)
+            let status = bufferRowsThrough(conn, rowNumber)
+            var first: Int32 = 0
+            var last: Int32 = 0
+            bufferedRowRange(conn, &first, &last)
+            let window = first > 0 ? Int(first - 1)..<Int(last) : 0..<0
+            if status < 0 {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Fetching buffered rows failed")
+                )
+            }
+            if status == 0 {
+                return ReadOutcome(values: nil, window: window, rowCount: Int(last))
+            }
+            if rowNumber < first {
+                return ReadOutcome(values: nil, window: window, rowCount: nil, evicted: true)
+            }
+
+            var values: [SQLDataType?] = []
+            values.reserveCapacity(columns.count)
+            for column in columns {
+                var cell = RowData()
+                guard readBufferedCell(conn, rowNumber, Int32(column + 1), &cell) == 0 else {
+                    throw TDSConnectionError.queryExecutionFailed(
+                        reason: "Row \(row) could not be read from the row buffer"
+                    )
+                }
+                defer { freeRowContents(&cell) }
+                values.append(cell.value(at: 0, encoding: encoding))
+            }
+            return ReadOutcome(values: values, window: window, rowCount: nil)
+        }
+
+        state.withLock { state in
+            state.window = outcome.window
+            if let rowCount = outcome.rowCount { state.rowCount = rowCount }
+        }
+        if outcome.evicted {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: "Row \(row) has left the buffer window, which starts at row \(outcome.window.lowerBound)"
+            )
+        }
+        return outcome.values
+    }
+
+    private struct ReadOutcome: Sendable {
+        var values: [SQLDataType?]?
+        var window: Range<Int>
+        var rowCount: Int?
+        var evicted = false
+    }
+
+    /// Start `queryString` with a `windowSize`-row buffer and return the layout of
+    /// its first result set. Buffering is switched off again if the query fails.
+    static func open(_ conn: OpaquePointer, queryString: String, windowSize: Int) throws -> ResultSchema {
+        guard setRowBuffering(conn, Int32(windowSize)) == 0 else {
+            throw TDSConnectionError.queryExecutionFailed(reason: "Row buffering is not available")
+        }
+        func fail(_ fallback: String) -> TDSConnectionError {
+            let error = TDSConnectionError.queryExecutionFailed(
+                reason: TDSConnection.lastErrorMessage(conn, or: fallback)
+            )
+            dbcancel(conn)
+            setRowBuffering(conn, 0)
+            return error
+        }
+        guard executeQuery(conn, queryString) == 0 else {
+            throw fail("Query failed")
+        }
+        let columnCount = openBufferedResults(conn)
+        guard columnCount >= 0 else {
+            throw fail("Query failed")
+        }
+        guard columnCount > 0 else { return ResultSchema(columns: []) }
+        describeResultSet(conn)
+        return ResultSchema.current(conn) ?? ResultSchema(columns: [])
+    }
+
+    /// Discard the rest of the results and switch buffering off.
+    func close() async {
+        let alreadyClosed = state.withLock { state -> Bool in
+            defer { state.isClosed = true }
+            return state.isClosed
+        }
+        guard !alreadyClosed else { return }
+        let bufferLock = bufferLock
+        // Not tied to the caller, so a cancelled body still leaves the session clean.
+        _ = try? await Task { [connection, session] in
+            try await connection.runOnSession(session) { conn in
+                bufferLock.lock()
+                defer { bufferLock.unlock() }
+                dbcancel(conn)
+                setRowBuffering(conn, 0)
+            }
+        }.value
+    }
+}
@@ -0,0 +1,41 @@
+//
+//  ReconnectPolicy.swift
+//  FreeTDSKit
+//
+
+/// How a `TDSConnection` reopens its session after the server or network drops it.
+///
+/// The first attempt is made immediately. Each later attempt waits `initialBackoff`,
+/// then `multiplier` times longer than the previous wait, up to `maxBackoff`.
+public struct ReconnectPolicy: Sendable {
+    /// Attempts to reopen the session before giving up.
+    public var maxAttempts: Int
+    /// Wait before the second attempt.
+    public var initialBackoff: Duration
+    /// Longest wait between attempts.
+    public var maxBackoff: Duration
+    /// Growth factor applied to the wait after each failed attempt.
+    public var multiplier: Double
+
+    public init(
+        maxAttempts: Int = 5,
+        initialBackoff: Duration = .milliseconds(50),
+        maxBackoff: Duration = .seconds(5),
+        multiplier: Double = 2
+    ) {
+        self.maxAttempts = max(1, maxAttempts)
+        self.initialBackoff = initialBackoff
+        self.maxBackoff = maxBackoff
+        self.multiplier = multiplier
+    }
+
+    /// Wait before the zero-based `attempt`.
+    func backoff(before attempt: Int) -> Duration {
+        guard attempt > 0 else { return .zero }
+        var delay = initialBackoff
+        for _ in 1..<attempt where delay < maxBackoff {
+            delay = delay * multiplier
+        }
+        return min(delay, maxBackoff)
+    }
+}
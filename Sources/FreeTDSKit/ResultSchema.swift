@@ -0,0 +1,184 @@
+//
+//  ResultSchema.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+/// Column layout of one result set, read from DB-Library once when the result
+/// set starts rather than from every row.
+public struct ResultSchema: Sendable, Equatable {
+
+    /// One result column.
+    public struct Column: Sendable, Equatable {
+        public var name: String
+        /// DB-Library type code (`SYBINT4`, `SYBDECIMAL`, ...).
+        public var typeCode: Int
+        /// Server user type, which tells apart types that share a type code.
+        public var userType: Int
+        /// Longest value in bytes.
+        public var maxLength: Int
+        /// Digits, for `decimal` and `numeric` columns; 0 otherwise.
+        public var precision: Int
+        /// Digits after the decimal point, for `decimal` and `numeric` columns.
+        public var scale: Int
+        public var isNullable: Bool
+        public var isIdentity: Bool
+        public var isVariableLength: Bool
+        public var isUpdatable: Bool
+
+        public init(
+            name: String,
+            typeCode: Int,
+            userType: Int = 0,
+            maxLength: Int = 0,
+            precision: Int = 0,
+            scale: Int = 0,
+            isNullable: Bool = true,
+            isIdentity: Bool = false,
+            isVariableLength: Bool = false,
+            isUpdatable: Bool = false
+        ) {
+            self.name = name
+            self.typeCode = typeCode
+            self.userType = userType
+            self.maxLength = maxLength
+            self.precision = precision
+            self.scale = scale
+            self.isNullable = isNullable
+            self.isIdentity = isIdentity
+            self.isVariableLength = isVariableLength
+            self.isUpdatable = isUpdatable
+        }
+
+        /// SQL Server name of the column's type, such as `decimal(10,3)` or
+        /// `nvarchar`, or `type <code>` when the code is not recognised.
+        public var typeName: String {
+            switch typeCode {
+            case SYBINT1: return "tinyint"
+            case SYBINT2: return "smallint"
+            case SYBINT4: return "int"
+            case SYBINT8: return "bigint"
+            case SYBBIT, SYBBITN: return "bit"
+            case SYBREAL: return "real"
+            case SYBFLT8: return "float"
+            case SYBMONEY4: return "smallmoney"
+            case SYBMONEY: return "money"
+            case SYBDECIMAL: return "decimal(\(precision),\(scale))"
+            case SYBNUMERIC: return "numeric(\(precision),\(scale))"
+            case SYBCHAR: return "char"
+            case SYBVARCHAR: return "varchar"
+            case SYBNVARCHAR: return "nvarchar"
+            case SYBTEXT: return "text"
+            case SYBNTEXT: return "ntext"
+            case SYBBINARY: return "binary"
+            case SYBVARBINARY: return "varbinary"
+            case SYBIMAGE: return "image"
+            case SYBDATETIME: return "datetime"
+            case SYBDATETIME4: return "smalldatetime"
+            case 36: return "uniqueidentifier"
+            case 40: return "date"
+            case 41: return "time"
+            case 42: return "datetime2"
+            case 43: return "datetimeoffset"
+            default: return "type \(typeCode)"
+            }
+        }
+
+        /// The Arrow type the column's values map to. Every column gets one from
+        /// its type code, so a batch of NULLs is typed like any other.
+        var arrowType: ArrowType {
+            switch typeCode {
+            case SYBINT1: return .int(bitWidth: 8, signed: false)
+            case SYBINT2: return .int(bitWidth: 16, signed: true)
+            case SYBINT4: return .int(bitWidth: 32, signed: true)
+            case SYBINT8: return .int(bitWidth: 64, signed: true)
+            case SYBBIT, SYBBITN: return .bool
+            case SYBREAL: return .float
+            case SYBFLT8: return .double
+            case SYBDECIMAL, SYBNUMERIC:
+                guard (1...38).contains(precision), (0...precision).contains(scale) else {
+                    return .decimal128(precision: 38, scale: min(max(scale, 0), 38))
+                }
+                return .decimal128(precision: precision, scale: scale)
+            case SYBMONEY4: return .decimal128(precision: 10, scale: 4)
+            case SYBMONEY: return .decimal128(precision: 19, scale: 4)
+            case SYBBINARY, SYBVARBINARY, SYBIMAGE: return .binary
+            case SYBDATETIME, SYBDATETIME4, 42: return .timestampMicros(timezone: nil)
+            case 36: return .fixedSizeBinary(16)
+            case 40: return .date32
+            case 41: return .time32Seconds
+            case 43: return .timestampMicros(timezone: "UTC")
+            default: return .utf8
+            }
+        }
+    }
+
+    public var columns: [Column]
+
+    public init(columns: [Column]) {
+        self.columns = columns
+    }
+
+    /// Column names, in result order.
+    public var names: [String] {
+        columns.map(\.name)
+    }
+
+    /// Position of the first column called `name`.
+    public func index(of name: String) -> Int? {
+        columns.firstIndex { $0.name == name }
+    }
+
+    public subscript(name: String) -> Column? {
+        index(of: name).map { columns[$0] }
+    }
+}
+
+extension ResultSchema {
+    /// The layout DB-Library last recorded for `conn`, or `nil` if no result set
+    /// has been described since the query started.
+    static func current(_ conn: OpaquePointer) -> ResultSchema? {
+        var count: Int32 = 0
+        guard let base = resultSchema(conn, &count), count > 0 else { return nil }
+        return ResultSchema(
+            columns: UnsafeBufferPointer(start: base, count: Int(count)).map { info in
+                // snprintf in the shim always NUL-terminates the name.
+                let name = withUnsafeBytes(of: info.name) { raw in
+                    String(decoding: raw.prefix { $0 != 0 }, as: UTF8.self)
+                }
+                return Column(
+                    name: name,
+                    typeCode: Int(info.type),
+                    userType: Int(info.userType),
+                    maxLength: Int(info.maxLength),
+                    precision: Int(info.precision),
+                    scale: Int(info.scale),
+                    isNullable: info.nullable != 0,
+                    isIdentity: info.identity != 0,
+                    isVariableLength: info.variableLength != 0,
+                    isUpdatable: info.updatable != 0
+                )
+            }
+        )
+    }
+}
+
+extension RowData {
+    /// The whole row keyed by `names`, for rows fetched without their own names.
+    func dictionary(names: [String], encoding: String.Encoding = .utf8) -> [String: SQLDataType] {
+        var dict: [String: SQLDataType] = Dictionary(minimumCapacity: names.count)
+        for j in 0..<min(Int(columnCount), names.count) {
+            guard let value = value(at: j, encoding: encoding) else { continue }
+            dict[names[j]] = value
+        }
+        return dict
+    }
+
+    /// Column names of a row fetched with them, `nil` for one fetched without.
+    var columnNameList: [String]? {
+        guard columnCount > 0, name(at: 0) != nil else { return nil }
+        return (0..<Int(columnCount)).map { name(at: $0) ?? "" }
+    }
+}
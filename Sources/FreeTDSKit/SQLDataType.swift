@@ -130,17 +130,40 @@ public struct TDSDateTimeOffset: Equatable, Codable,
 public let SYBGEOGRAPHY: Int = 240  // Actual value from SQL Server
 public let SYBGEOMETRY: Int = 241  // Actual value from SQL Server
 
+/// Decode a NUL-terminated value. Prefer `determineSQLType(_:length:columnType:)`
+/// when the byte length is known, since binary values may contain zero bytes.
 func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
     -> SQLDataType
 {
+    determineSQLType(colValue, length: strlen(colValue), columnType: columnType)
+}
+
+/// Decode `length` bytes of a fetched value according to its DB-Library column type.
+/// Text is interpreted in `encoding`, the connection's client charset.
+func determineSQLType(
+    _ colValue: UnsafePointer<CChar>,
+    length: Int,
+    columnType: Int,
+    encoding: String.Encoding = .utf8
+) -> SQLDataType {
+    func text() -> String {
+        encoding == .utf8
+            ? makeString(colValue, length: length)
+            : makeString(colValue, length: length, encoding: encoding)
+    }
 
     switch columnType {
     case 36:  // uniqueidentifier
-        if let uuid = UUID(uuidString: String(cString: colValue)) {
+        if length == 16 {
+            return .uniqueidentifier(
+                decodeUniqueIdentifier(UnsafeRawPointer(colValue))
+            )
+        }
+        if let uuid = UUID(uuidString: text()) {
             return .uniqueidentifier(uuid)
         }
     case 40:  // Date type
-        let dateParts = String(cString: colValue).split(separator: "-")
+        let dateParts = text().split(separator: "-")
             .compactMap { Int($0) }
         if dateParts.count == 3 {
             return .date(
@@ -152,7 +175,7 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
             )
         }
     case 41:  // Time type
-        let timeString = String(cString: colValue).split(separator: ":")
+        let timeString = text().split(separator: ":")
             .compactMap { Int($0) }
         if timeString.count == 3 {
             return .time(
@@ -165,7 +188,7 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
         }
     case 42:  // datetime2
         // Extracts higher precision seconds
-        let dateTimeParts = String(cString: colValue).split(separator: ".")
+        let dateTimeParts = text().split(separator: ".")
         if let dateTime = dateTimeParts.first {
             let dateAndTime = dateTime.split(separator: " ")
             if dateAndTime.count == 2 {
@@ -192,7 +215,7 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
             }
         }
     case 43:  // DateTimeOffset type
-        let dateTimeParts = String(cString: colValue).split(separator: " ")
+        let dateTimeParts = text().split(separator: " ")
         if dateTimeParts.count == 3 {
             // Extract date, time, and offset parts
             let dateParts = dateTimeParts[0].split(separator: "-").compactMap {
@@ -234,20 +257,20 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
             }
         }
     case SYBINT1:  //sql server type 48
-        if let value = UInt8(String(cString: colValue)) {
+        if let value = UInt8(text()) {
             return .tinyInt(value)
         }
     case SYBINT2:  //sql server type 52
-        if let value = Int16(String(cString: colValue)) {
+        if let value = Int16(text()) {
             return .smallInt(value)
         }
     case SYBINT4:  //sql server type 56
-        if let value = Int32(String(cString: colValue)) {
+        if let value = Int32(text()) {
             return .integer(Int(value))
         }
     case 58:  // smalldatetime
         // Similar to datetime but truncates seconds
-        let dateTimeParts = String(cString: colValue).split(separator: " ")
+        let dateTimeParts = text().split(separator: " ")
         if dateTimeParts.count == 2 {
             let dateParts = dateTimeParts[0].split(separator: "-").compactMap {
                 Int($0)
@@ -274,14 +297,17 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
             }
         }
     case 61:  // datetime
-        let dateTimeParts = String(cString: colValue).split(separator: " ")
+        let dateTimeParts = text().split(separator: " ")
         if dateTimeParts.count == 2 {
             let dateParts = dateTimeParts[0].split(separator: "-").compactMap {
                 Int($0)
             }
-            let timeParts = dateTimeParts[1].split(separator: ":").compactMap {
+            // Seconds may carry a fraction in 100ns ticks: "14:45:30.0030000".
+            let clock = dateTimeParts[1].split(separator: ".")
+            let timeParts = (clock.first ?? "").split(separator: ":").compactMap {
                 Int($0)
             }
+            let fractionalSecond = clock.count == 2 ? Int(clock[1]) ?? 0 : 0
             if dateParts.count == 3,
                 timeParts.count == 3
             {
@@ -295,39 +321,37 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
                     hour: timeParts[0],
                     minute: timeParts[1],
                     second: timeParts[2],
-                    fractionalSecond: 0
+                    fractionalSecond: fractionalSecond
                 )
                 return .datetime(timestamp)
             }
         }
     case SYBFLT8:  // 8-byte FLOAT
-        if let v = Double(String(cString: colValue)) {
+        if let v = Double(text()) {
             return .double(v)
         }
     case SYBINT8:  //sql server type 127
-        if let value = Int64(String(cString: colValue)) {
+        if let value = Int64(text()) {
             return .bigInt(value)
         }
     case SYBREAL:
-        if let value = Float(String(cString: colValue)) {
+        if let value = Float(text()) {
             return .real(value)
         }
     case SYBCHAR:  //sql server type 175 and nchar is 239
-        return .char(String(cString: colValue))
+        return .char(text())
     case SYBNVARCHAR:
-        return .nvarchar(String(cString: colValue))
+        return .nvarchar(text())
     case 239:
-        return .nchar(String(cString: colValue))
+        return .nchar(text())
     case SYBVARCHAR:  //sql server type 167
-        return .varchar(String(cString: colValue))
+        return .varchar(text())
     case SYBTEXT, 99:  // 99 = SYBNTEXT (Unicode)
-        return .text(String(cString: colValue))
+        return .text(text())
     case SYBBINARY, SYBVARBINARY:  //sql server type 165, 173
-        let dataLength = strlen(colValue)
-        let data = Data(bytes: colValue, count: Int(dataLength))
-        return .binary(data)
+        return .binary(Data(bytes: colValue, count: length))
     case SYBBIT:
-        let valueStr = String(cString: colValue).lowercased()
+        let valueStr = text().lowercased()
         if valueStr == "1" || valueStr == "true" {
             return .bit(true)
         } else if valueStr == "0" || valueStr == "false" {
@@ -335,20 +359,20 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
         }
         return .null
     case 60:  //money
-        if let value = Decimal(string: String(cString: colValue)) {
+        if let value = Decimal(string: text()) {
             return .money(value)
         }
     case SYBMONEY, SYBMONEY4:
-        if let value = Decimal(string: String(cString: colValue)) {
+        if let value = Decimal(string: text()) {
             // Round to the expected precision for money types
             return .money(value.rounded(scale: 2))
         }
     case SYBDECIMAL, SYBNUMERIC:
-        if let value = Decimal(string: String(cString: colValue)) {
+        if let value = Decimal(string: text()) {
             return .decimal(value)
         }
     case SYBGEOGRAPHY, SYBGEOMETRY:
-        let colAsString = String(cString: colValue)
+        let colAsString = text()
         let spatialWKT = SQLDataType.WKTString(value: colAsString)
         return .spatial(spatialWKT)
     default:
@@ -358,6 +382,68 @@ func determineSQLType(_ colValue: UnsafePointer<CChar>, columnType: Int)
     return .null
 }
 
+/// Build a `String` from exactly `length` UTF-8 bytes, without scanning for a
+/// terminator. The standard library validates in a single pass with a word-at-a-time
+/// ASCII fast path; invalid sequences are replaced with U+FFFD.
+@inline(__always)
+func makeString(_ bytes: UnsafePointer<CChar>, length: Int) -> String {
+    bytes.withMemoryRebound(to: UInt8.self, capacity: length) {
+        String(decoding: UnsafeBufferPointer(start: $0, count: length), as: UTF8.self)
+    }
+}
+
+/// Decode the 16-byte on-wire form of a `uniqueidentifier`.
+///
+/// SQL Server stores the first three groups (Data1, Data2, Data3) little-endian
+/// and the final eight bytes in order, so `354E427F-F042-445B-…` arrives as
+/// `7F 42 4E 35 42 F0 5B 44 …`.
+func decodeUniqueIdentifier(_ raw: UnsafeRawPointer) -> UUID {
+    let b = raw.assumingMemoryBound(to: UInt8.self)
+    return UUID(uuid: (
+        b[3], b[2], b[1], b[0],
+        b[5], b[4],
+        b[7], b[6],
+        b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]
+    ))
+}
+
+/// Build a `String` from `length` bytes in a non-UTF-8 client charset, falling back
+/// to lossy UTF-8 if the bytes are not valid in `encoding`.
+func makeString(
+    _ bytes: UnsafePointer<CChar>,
+    length: Int,
+    encoding: String.Encoding
+) -> String {
+    String(bytes: UnsafeRawBufferPointer(start: bytes, count: length), encoding: encoding)
+        ?? makeString(bytes, length: length)
+}
+
+extension RowData {
+    /// Column name `j` of a fetched row.
+    func name(at j: Int) -> String? {
+        columnNames?[j].map { String(cString: $0) }
+    }
+
+    /// Whether column `j` of a fetched row is SQL NULL.
+    func isNull(at j: Int) -> Bool {
+        guard let nullBitmap else { return false }
+        return nullBitmap[j >> 3] & (1 << UInt8(j & 7)) != 0
+    }
+
+    /// Decode column `j` of a fetched row using its explicit byte length.
+    /// NULL cells decode to `.null` without touching a value buffer.
+    func value(at j: Int, encoding: String.Encoding = .utf8) -> SQLDataType? {
+        if isNull(at: j) { return .null }
+        guard let valPtr = columnValues?[j] else { return nil }
+        return determineSQLType(
+            valPtr,
+            length: Int(columnLengths?[j] ?? 0),
+            columnType: Int(columnTypes?[j] ?? 0),
+            encoding: encoding
+        )
+    }
+}
+
 extension Decimal {
     func rounded(scale: Int) -> Decimal {
         var result = Decimal()
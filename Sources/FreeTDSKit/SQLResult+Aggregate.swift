@@ -0,0 +1,346 @@
+//
+//  SQLResult+Aggregate.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+extension SQLResult {
+
+    /// Column `name` as contiguous `Double`s, for aggregation. Floating-point,
+    /// integer and `decimal`/`numeric`/`money` cells are converted; NULL, missing
+    /// and non-numeric cells are nulls.
+    public func doubleColumn(_ name: String) -> NumericColumn<Double> {
+        NumericColumn(gathering: self, column: name) { value in
+            switch value {
+            case .tinyInt(let v): return Double(v)
+            case .smallInt(let v): return Double(v)
+            case .integer(let v): return Double(v)
+            case .bigInt(let v): return Double(v)
+            default: return value.double
+            }
+        }
+    }
+
+    /// Column `name` as contiguous `Int64`s, for aggregation. Integer cells are
+    /// kept; NULL, missing and non-integer cells are nulls.
+    public func integerColumn(_ name: String) -> NumericColumn<Int64> {
+        NumericColumn(gathering: self, column: name) { value in
+            switch value {
+            case .tinyInt(let v): return Int64(v)
+            case .smallInt(let v): return Int64(v)
+            case .integer(let v): return Int64(v)
+            case .bigInt(let v): return v
+            default: return nil
+            }
+        }
+    }
+
+    /// Column `name` of `decimal`, `numeric` or `money` cells as `Int64` counts of
+    /// `10^-scale`, so sums are exact. `scale` defaults to the column's scale in
+    /// `schema`, or else the most fractional digits among the values.
+    ///
+    /// Returns `nil` when a value has more fractional digits than `scale` or does
+    /// not fit in 64 bits once scaled. Other cells are nulls.
+    public func scaledDecimalColumn(_ name: String, scale: Int? = nil) -> ScaledDecimalColumn? {
+        let scale = scale ?? schema?[name].flatMap(\.decimalScale) ?? widestScale(of: name)
+        guard (0...18).contains(scale) else { return nil }
+        var representable = true
+        let units = NumericColumn<Int64>(gathering: self, column: name) { value in
+            guard representable, let decimal = value.decimal else { return nil }
+            guard let scaled = decimal.scaledInt64(scale: scale) else {
+                representable = false
+                return nil
+            }
+            return scaled
+        }
+        guard representable else { return nil }
+        return ScaledDecimalColumn(units: units, scale: scale)
+    }
+
+    private func widestScale(of name: String) -> Int {
+        var scale = 0
+        for row in self {
+            if let decimal = row[name]?.decimal, !decimal.isNaN {
+                scale = max(scale, -Int(decimal.exponent))
+            }
+        }
+        return scale
+    }
+}
+
+extension ResultSchema.Column {
+    /// Scale of a `decimal`, `numeric` or `money` column.
+    fileprivate var decimalScale: Int? {
+        switch typeCode {
+        case SYBDECIMAL, SYBNUMERIC: return scale
+        case SYBMONEY, SYBMONEY4: return 4
+        default: return nil
+        }
+    }
+}
+
+// MARK: - Columns
+
+/// One result column copied into a contiguous buffer with an Arrow-style
+/// validity bitmap, so aggregates run eight values at a time with SIMD.
+///
+/// NULL slots hold zero and are left out of every aggregate. Aggregates of a
+/// column with no values are `nil`, except `sum`, which is zero.
+public struct NumericColumn<Element: SIMDScalar & Comparable & AdditiveArithmetic & Sendable>: Sendable {
+    /// One value per row; zero where the row is NULL.
+    public private(set) var values: [Element]
+    /// Bit `i` is set when row `i` is not NULL. Empty when no row is NULL.
+    public private(set) var validity: [UInt8]
+    public let nullCount: Int
+
+    init(values: [Element], validity: [UInt8], nullCount: Int) {
+        self.values = values
+        self.validity = nullCount == 0 ? [] : validity
+        self.nullCount = nullCount
+    }
+
+    init(gathering result: SQLResult, column name: String, _ convert: (SQLDataType) -> Element?) {
+        let count = result.count
+        var values: [Element] = []
+        values.reserveCapacity(count)
+        var validity = [UInt8](repeating: 0, count: (count + 7) / 8)
+        var nullCount = 0
+        for (i, row) in result.enumerated() {
+            if let cell = row[name], let value = convert(cell) {
+                values.append(value)
+                validity[i >> 3] |= 1 << UInt8(i & 7)
+            } else {
+                values.append(.zero)
+                nullCount += 1
+            }
+        }
+        self.init(values: values, validity: validity, nullCount: nullCount)
+    }
+
+    public var count: Int { values.count }
+
+    public var nonNullCount: Int { values.count - nullCount }
+
+    public func isNull(at index: Int) -> Bool {
+        !validity.isEmpty && validity[index >> 3] & (1 << UInt8(index & 7)) == 0
+    }
+
+    /// The value of row `index`, or `nil` when it is NULL.
+    public subscript(index: Int) -> Element? {
+        isNull(at: index) ? nil : values[index]
+    }
+
+    public func min() -> Element? {
+        extremum(pointwiseMin, Swift.min)
+    }
+
+    public func max() -> Element? {
+        extremum(pointwiseMax, Swift.max)
+    }
+
+    /// Fold the non-NULL values with `lanes`, eight at a time where a whole
+    /// validity byte is set, and `combine` for the rest.
+    private func extremum(
+        _ lanes: (SIMD8<Element>, SIMD8<Element>) -> SIMD8<Element>,
+        _ combine: (Element, Element) -> Element
+    ) -> Element? {
+        guard nonNullCount > 0 else { return nil }
+        return values.withUnsafeBufferPointer { buffer -> Element? in
+            let raw = UnsafeRawPointer(buffer.baseAddress!)
+            let blocks = buffer.count / 8
+            var vector: SIMD8<Element>?
+            var scalar: Element?
+            func fold(_ value: Element) {
+                scalar = scalar.map { combine($0, value) } ?? value
+            }
+            for block in 0..<blocks {
+                let mask = validity.isEmpty ? 0xFF : validity[block]
+                if mask == 0xFF {
+                    let next = raw.loadUnaligned(
+                        fromByteOffset: block * 8 * MemoryLayout<Element>.stride,
+                        as: SIMD8<Element>.self
+                    )
+                    vector = vector.map { lanes($0, next) } ?? next
+                } else if mask != 0 {
+                    for lane in 0..<8 where mask & (1 << UInt8(lane)) != 0 {
+                        fold(buffer[block * 8 + lane])
+                    }
+                }
+            }
+            for index in (blocks * 8)..<buffer.count where !isNull(at: index) {
+                fold(buffer[index])
+            }
+            if let vector {
+                for lane in 0..<8 { fold(vector[lane]) }
+            }
+            return scalar
+        }
+    }
+
+    /// Visit the values as whole `SIMD8` vectors, then the remaining tail. NULL
+    /// slots are included, which is harmless for sums because they hold zero.
+    fileprivate func forEachVector(_ vector: (SIMD8<Element>) -> Void, tail: (Element) -> Void) {
+        values.withUnsafeBufferPointer { buffer in
+            guard let base = buffer.baseAddress else { return }
+            let raw = UnsafeRawPointer(base)
+            let blocks = buffer.count / 8
+            for block in 0..<blocks {
+                vector(
+                    raw.loadUnaligned(
+                        fromByteOffset: block * 8 * MemoryLayout<Element>.stride,
+                        as: SIMD8<Element>.self
+                    )
+                )
+            }
+            for index in (blocks * 8)..<buffer.count {
+                tail(buffer[index])
+            }
+        }
+    }
+}
+
+extension NumericColumn where Element == Double {
+
+    public func sum() -> Double {
+        var lanes = SIMD8<Double>()
+        var tail = 0.0
+        forEachVector({ lanes += $0 }, tail: { tail += $0 })
+        return lanes.sum() + tail
+    }
+
+    public func mean() -> Double? {
+        nonNullCount > 0 ? sum() / Double(nonNullCount) : nil
+    }
+}
+
+extension NumericColumn where Element == Int64 {
+
+    /// The exact total, or `nil` if it does not fit in `Int64`. The result does
+    /// not depend on row order: when a lane or the tail overflows part way, the
+    /// values are summed again one at a time with a wider running total.
+    public func sum() -> Int64? {
+        var lanes = SIMD8<Int64>()
+        // Sign bit set in a lane once an addition in that lane has overflowed.
+        var overflow = SIMD8<Int64>()
+        var tail: Int64 = 0
+        var tailOverflow = false
+        forEachVector({ next in
+            let total = lanes &+ next
+            overflow |= (lanes ^ total) & (next ^ total)
+            lanes = total
+        }, tail: { next in
+            let (total, overflowed) = tail.addingReportingOverflow(next)
+            tail = total
+            tailOverflow = tailOverflow || overflowed
+        })
+        guard !tailOverflow, !any(overflow .< 0) else { return checkedSum() }
+        var total = tail
+        for lane in 0..<8 {
+            let (next, overflowed) = total.addingReportingOverflow(lanes[lane])
+            if overflowed { return nil }
+            total = next
+        }
+        return total
+    }
+
+    /// The total accumulated in 128 bits, so a partial sum that leaves the
+    /// `Int64` range and comes back still gives the right answer.
+    private func checkedSum() -> Int64? {
+        var high: Int64 = 0
+        var low: UInt64 = 0
+        for value in values {
+            let (next, carry) = low.addingReportingOverflow(UInt64(bitPattern: value))
+            low = next
+            // Sign-extend the addend into the high word, then add the carry.
+            high = high &+ (value < 0 ? -1 : 0) &+ (carry ? 1 : 0)
+        }
+        let total = Int64(bitPattern: low)
+        // Fits when the high word is the sign extension of the low word.
+        return high == (total < 0 ? -1 : 0) ? total : nil
+    }
+
+    /// The mean, accumulated in `Double` so it is defined even where `sum()`
+    /// overflows.
+    public func mean() -> Double? {
+        guard nonNullCount > 0 else { return nil }
+        var lanes = SIMD8<Double>()
+        var tail = 0.0
+        forEachVector({ lanes += SIMD8<Double>($0) }, tail: { tail += Double($0) })
+        return (lanes.sum() + tail) / Double(nonNullCount)
+    }
+}
+
+/// A `decimal`, `numeric` or `money` column held as integer counts of
+/// `10^-scale`, so that sums are exact and vectorize like plain integers.
+public struct ScaledDecimalColumn: Sendable {
+    /// The scaled values: `12.3400` at scale 4 is `123400`.
+    public let units: NumericColumn<Int64>
+    public let scale: Int
+
+    public var count: Int { units.count }
+    public var nonNullCount: Int { units.nonNullCount }
+
+    public subscript(index: Int) -> Decimal? {
+        units[index].map(decimal)
+    }
+
+    /// The exact total, or `nil` if the scaled total does not fit in `Int64`.
+    public func sum() -> Decimal? {
+        units.sum().map(decimal)
+    }
+
+    public func min() -> Decimal? {
+        units.min().map(decimal)
+    }
+
+    public func max() -> Decimal? {
+        units.max().map(decimal)
+    }
+
+    /// The exact total divided by the number of non-NULL values.
+    public func mean() -> Decimal? {
+        guard nonNullCount > 0, let sum = sum() else { return nil }
+        return sum / Decimal(nonNullCount)
+    }
+
+    private func decimal(_ units: Int64) -> Decimal {
+        Decimal(
+            sign: units < 0 ? .minus : .plus,
+            exponent: -scale,
+            significand: Decimal(units.magnitude)
+        )
+    }
+}
+
+extension Decimal {
+    /// `self * 10^scale` as an `Int64`, or `nil` unless that is a whole number
+    /// that fits.
+    fileprivate func scaledInt64(scale: Int) -> Int64? {
+        guard !isNaN, _length <= 4 else { return nil }
+        var magnitude: UInt64 = 0
+        withUnsafeBytes(of: _mantissa) { raw in
+            for i in 0..<Int(_length) {
+                magnitude |= UInt64(raw.loadUnaligned(fromByteOffset: i * 2, as: UInt16.self)) << (16 * i)
+            }
+        }
+        var shift = Int(_exponent) + scale
+        while shift > 0 {
+            let (next, overflowed) = magnitude.multipliedReportingOverflow(by: 10)
+            guard !overflowed else { return nil }
+            magnitude = next
+            shift -= 1
+        }
+        while shift < 0 {
+            guard magnitude % 10 == 0 else { return nil }
+            magnitude /= 10
+            shift += 1
+        }
+        if _isNegative != 0 {
+            guard magnitude <= UInt64(Int64.max) + 1 else { return nil }
+            return Int64(truncatingIfNeeded: 0 &- magnitude)
+        }
+        return Int64(exactly: magnitude)
+    }
+}
@@ -0,0 +1,192 @@
+//
+//  SQLResult+Arrow.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+extension SQLResult {
+
+    /// Encode the result as Arrow IPC, `batchSize` rows per record batch.
+    ///
+    /// Columns take their types from `schema` when the result has one. Otherwise
+    /// types are inferred from the first batch: integers keep their width,
+    /// `decimal`/`numeric`/`money` become `decimal128`, `datetimeoffset` becomes a
+    /// UTC timestamp, binary columns become `binary` and text becomes `utf8`.
+    public func arrowIPCData(format: ArrowIPCFormat = .file, batchSize: Int = 65_536) -> Data {
+        var out = Data()
+        writeArrowIPC(format: format, batchSize: batchSize) { out.append($0) }
+        return out
+    }
+
+    /// Encode the result as Arrow IPC into the file at `url`, replacing it if present.
+    public func writeArrowIPC(
+        to url: URL,
+        format: ArrowIPCFormat = .file,
+        batchSize: Int = 65_536
+    ) throws {
+        FileManager.default.createFile(atPath: url.path, contents: nil)
+        let handle = try FileHandle(forWritingTo: url)
+        defer { try? handle.close() }
+        var writeError: Error? = nil
+        writeArrowIPC(format: format, batchSize: batchSize) { chunk in
+            guard writeError == nil else { return }
+            do { try handle.write(contentsOf: chunk) } catch { writeError = error }
+        }
+        if let writeError { throw writeError }
+    }
+
+    private func writeArrowIPC(format: ArrowIPCFormat, batchSize: Int, _ sink: (Data) -> Void) {
+        var writer = ArrowIPCWriter(format: format)
+        var batch = ArrowColumnBatch(columnCount: columns.count, capacity: batchSize)
+        let types = schema.map { schema in columns.map { schema[$0]?.arrowType } } ?? []
+        for row in self {
+            for (j, name) in columns.enumerated() {
+                batch.columns[j].append(row[name] ?? .null)
+            }
+            batch.rowCount += 1
+            if batch.rowCount >= batchSize {
+                batch.flush(into: &writer, names: columns, types: types)
+                sink(writer.drain())
+            }
+        }
+        if batch.rowCount > 0 {
+            batch.flush(into: &writer, names: columns, types: types)
+        }
+        writer.finish()
+        sink(writer.drain())
+    }
+}
+
+extension TDSConnection {
+
+    /// Run `queryString` and stream its rows into Arrow IPC record batches written
+    /// to `url`. Rows are fetched one at a time and their cells appended straight
+    /// to each column's Arrow buffers, without building a value per cell. A batch
+    /// of at most `batchSize` rows is written before the next is fetched, so memory
+    /// stays bounded by one batch. Every column is typed from the result schema. Only the first result set that returns rows is
+    /// exported; the rest are discarded. Returns the number of rows written.
+    @discardableResult
+    public func exportArrow(
+        queryString: String,
+        to url: URL,
+        format: ArrowIPCFormat = .file,
+        batchSize: Int = 65_536
+    ) async throws -> Int {
+        let encoding = textEncoding
+        return try await runBlocking { conn in
+            FileManager.default.createFile(atPath: url.path, contents: nil)
+            let handle = try FileHandle(forWritingTo: url)
+            defer { try? handle.close() }
+            return try TDSConnection.writeArrow(
+                conn, queryString: queryString, encoding: encoding,
+                format: format, batchSize: batchSize
+            ) { try handle.write(contentsOf: $0) }
+        }
+    }
+
+    /// Run `queryString` and return its rows encoded as an in-memory Arrow IPC buffer.
+    public func exportArrow(
+        queryString: String,
+        format: ArrowIPCFormat = .stream,
+        batchSize: Int = 65_536
+    ) async throws -> Data {
+        let encoding = textEncoding
+        return try await runBlocking { conn in
+            var out = Data()
+            try TDSConnection.writeArrow(
+                conn, queryString: queryString, encoding: encoding,
+                format: format, batchSize: batchSize
+            ) { out.append($0) }
+            return out
+        }
+    }
+
+    /// Run `queryString` on `conn` and pass its Arrow IPC encoding to `sink` a
+    /// record batch at a time. Returns the number of rows written.
+    @discardableResult
+    static func writeArrow(
+        _ conn: OpaquePointer,
+        queryString: String,
+        encoding: String.Encoding = .utf8,
+        format: ArrowIPCFormat,
+        batchSize: Int,
+        _ sink: (Data) throws -> Void
+    ) throws -> Int {
+        guard executeQuery(conn, queryString) == 0 else {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: lastErrorMessage(conn, or: "Query failed")
+            )
+        }
+
+        let batchSize = max(1, batchSize)
+        var writer = ArrowIPCWriter(format: format)
+        var fields: [ArrowIPCWriter.Field] = []
+        var builders: [ArrowColumnBuilder] = []
+        var resultSet = 0
+        var rowCount = 0
+        var row = RowData()
+        do {
+            while true {
+                let status = fetchNextRow(conn, &row)
+                if status == 0 { break }
+                guard status > 0 else {
+                    throw TDSConnectionError.queryExecutionFailed(
+                        reason: lastErrorMessage(conn, or: "Query failed")
+                    )
+                }
+                defer { freeRowContents(&row) }
+
+                let ordinal = Int(resultSetOrdinal(conn))
+                if resultSet == 0 {
+                    resultSet = ordinal
+                    let columns = ResultSchema.current(conn)?.columns ?? []
+                    fields = columns.map { ArrowIPCWriter.Field(name: $0.name, type: $0.arrowType) }
+                    builders = columns.map {
+                        ArrowColumnBuilder(column: $0, encoding: encoding, capacity: batchSize)
+                    }
+                } else if ordinal != resultSet {
+                    // A later result set has other columns; the stream has one schema.
+                    dbcancel(conn)
+                    break
+                }
+
+                for j in builders.indices {
+                    builders[j].append(row, at: j)
+                }
+                rowCount += 1
+                if rowCount % batchSize == 0 {
+                    writer.write(fields: fields, columns: builders.indices.map { builders[$0].finish() })
+                    try sink(writer.drain())
+                }
+            }
+        } catch {
+            dbcancel(conn)
+            throw error
+        }
+        if rowCount % batchSize != 0 {
+            writer.write(fields: fields, columns: builders.indices.map { builders[$0].finish() })
+        }
+        writer.finish()
+        try sink(writer.drain())
+        return rowCount
+    }
+}
+
+/// Column-major staging area for one Arrow record batch.
+struct ArrowColumnBatch {
+    var columns: [[SQLDataType]]
+    var rowCount = 0
+
+    init(columnCount: Int, capacity: Int) {
+        self.columns = Array(repeating: [], count: columnCount)
+        for j in columns.indices { columns[j].reserveCapacity(capacity) }
+    }
+
+    mutating func flush(into writer: inout ArrowIPCWriter, names: [String], types: [ArrowType?] = []) {
+        writer.write(columns: names, values: columns, types: types)
+        for j in columns.indices { columns[j].removeAll(keepingCapacity: true) }
+        rowCount = 0
+    }
+}
@@ -0,0 +1,144 @@
+//
+//  SQLResult+Binary.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+extension SQLResult {
+
+    /// Version written by `binaryEncoded()`. Decoding rejects newer versions.
+    public static let binaryFormatVersion: UInt8 = 1
+
+    private static let binaryMagic: [UInt8] = Array("TDSR".utf8)
+
+    /// Layout of one column in the payload.
+    private enum ColumnEncoding: UInt8 {
+        /// Every cell carries its own type tag.
+        case tagged = 0
+        /// One tag for the column, a bitmap of non-NULL cells and untagged payloads.
+        case uniform = 1
+    }
+
+    /// Encode the result in a compact, versioned binary format that round-trips
+    /// every `SQLDataType` case exactly, for caches and inter-process hand-off.
+    ///
+    /// The layout is a header (magic `TDSR`, version, affected rows, row count and
+    /// column names) followed by one block per column. A column whose cells are all
+    /// of one type, or NULL, stores that type once plus a NULL bitmap; other columns
+    /// tag each cell. Integers in the header and the date fields are varints.
+    public func binaryEncoded() -> Data {
+        let rows = self.rows
+        var writer = BinaryWriter()
+        writer.bytes.append(contentsOf: Self.binaryMagic)
+        writer.write(Self.binaryFormatVersion)
+        writer.write(signed: affectedRows)
+        writer.write(varint: UInt64(rows.count))
+        writer.write(varint: UInt64(columns.count))
+        for name in columns {
+            writer.write(name)
+        }
+
+        for name in columns {
+            if let tag = Self.uniformTag(of: name, in: rows) {
+                writer.write(ColumnEncoding.uniform.rawValue)
+                writer.write(tag.rawValue)
+                var bitmap = [UInt8](repeating: 0, count: (rows.count + 7) / 8)
+                for (i, row) in rows.enumerated() {
+                    if case .null = row[name] { continue }
+                    bitmap[i >> 3] |= 1 << UInt8(i & 7)
+                }
+                writer.bytes.append(contentsOf: bitmap)
+                for row in rows {
+                    guard let value = row[name] else { continue }
+                    writer.write(payloadOf: value)
+                }
+            } else {
+                writer.write(ColumnEncoding.tagged.rawValue)
+                for row in rows {
+                    if let value = row[name] {
+                        writer.write(value)
+                    } else {
+                        writer.write(BinaryValueTag.absent.rawValue)
+                    }
+                }
+            }
+        }
+        return Data(writer.bytes)
+    }
+
+    /// Decode a result produced by `binaryEncoded()`. Throws `BinaryDecodingError`
+    /// for data that is truncated, malformed or from a newer format version.
+    public init(binaryEncoded data: Data) throws {
+        let decoded = try data.withUnsafeBytes { raw -> SQLResult in
+            var reader = BinaryReader(raw)
+            guard Array(try reader.readBytes(Self.binaryMagic.count)) == Self.binaryMagic else {
+                throw BinaryDecodingError(description: "Not an encoded SQLResult")
+            }
+            let version = try reader.readByte()
+            guard version <= Self.binaryFormatVersion else {
+                throw BinaryDecodingError(description: "Unsupported format version \(version)")
+            }
+            let affectedRows = try reader.readSigned()
+            let rowCount = try reader.readVarint()
+            let columnCount = try reader.readLength()
+            var columns: [String] = []
+            columns.reserveCapacity(columnCount)
+            for _ in 0..<columnCount {
+                columns.append(try reader.readString())
+            }
+            // Every row costs at least one bit per column, so a count larger than
+            // the data is corrupt rather than a reason to allocate.
+            guard rowCount <= UInt64(raw.count) * 8 || (columnCount == 0 && rowCount <= UInt32.max) else {
+                throw BinaryDecodingError(description: "Row count \(rowCount) exceeds the data")
+            }
+
+            var rows = [[String: SQLDataType]](
+                repeating: Dictionary(minimumCapacity: columnCount),
+                count: Int(rowCount)
+            )
+            for name in columns {
+                let rawEncoding = try reader.readByte()
+                switch ColumnEncoding(rawValue: rawEncoding) {
+                case .uniform:
+                    let tag = try reader.readTag()
+                    let bitmap = try reader.readBytes((rows.count + 7) / 8)
+                    for i in rows.indices {
+                        if bitmap[i >> 3] & (1 << UInt8(i & 7)) == 0 {
+                            rows[i][name] = .null
+                        } else {
+                            rows[i][name] = try reader.readPayload(of: tag)
+                        }
+                    }
+                case .tagged:
+                    for i in rows.indices {
+                        if let value = try reader.readValue() {
+                            rows[i][name] = value
+                        }
+                    }
+                case nil:
+                    throw BinaryDecodingError(description: "Unknown column encoding \(rawEncoding)")
+                }
+            }
+            guard reader.isAtEnd else {
+                throw BinaryDecodingError(description: "Trailing bytes after the last column")
+            }
+            return SQLResult(columns: columns, rows: rows, affectedRows: affectedRows)
+        }
+        self = decoded
+    }
+
+    /// The tag shared by every non-NULL cell of column `name`, or `nil` if the
+    /// column mixes types, has missing cells or is entirely NULL.
+    private static func uniformTag(of name: String, in rows: [[String: SQLDataType]]) -> BinaryValueTag? {
+        var shared: BinaryValueTag?
+        for row in rows {
+            guard let value = row[name] else { return nil }
+            let tag = BinaryValueTag(value)
+            if tag == .null { continue }
+            if let shared, shared != tag { return nil }
+            shared = tag
+        }
+        return shared
+    }
+}
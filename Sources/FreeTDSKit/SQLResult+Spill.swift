@@ -0,0 +1,335 @@
+//
+//  SQLResult+Spill.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+extension TDSConnection {
+
+    /// Execute `queryString`, keeping rows in memory only until they take up about
+    /// `spillThreshold` bytes. Later rows are written to an anonymous temporary file
+    /// in `spillDirectory` (default: the system temporary directory) and read back
+    /// through a memory map, so the result is bounded by disk rather than RAM.
+    ///
+    /// The returned `SQLResult` behaves like any other through its subscripts and
+    /// `Sequence` conformance. Its `rows` property reads every spilled row back into
+    /// memory, so avoid it on large results. The file has no name on disk and is
+    /// reclaimed when the last copy of the result goes away.
+    ///
+    /// Only the first result set that returns rows is kept; once it ends, the rest
+    /// of the batch is cancelled. Every row, in memory or spilled, therefore has the
+    /// same columns.
+    public func execute(
+        queryString: String,
+        spillThreshold: Int,
+        spillDirectory: URL? = nil
+    ) async throws -> SQLResult {
+        let encoding = textEncoding
+        let directory = spillDirectory ?? FileManager.default.temporaryDirectory
+        return try await runBlocking { conn in
+            try TDSConnection.fetchSpillingResult(
+                conn,
+                queryString: queryString,
+                encoding: encoding,
+                spillThreshold: spillThreshold,
+                spillDirectory: directory
+            )
+        }
+    }
+
+    /// Fetch rows one at a time, switching to a spill file once the rows held in
+    /// memory pass `spillThreshold` bytes.
+    static func fetchSpillingResult(
+        _ conn: OpaquePointer,
+        queryString: String,
+        encoding: String.Encoding,
+        spillThreshold: Int,
+        spillDirectory: URL
+    ) throws -> SQLResult {
+        guard executeQuery(conn, queryString) == 0 else {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: lastErrorMessage(conn, or: "Query failed")
+            )
+        }
+
+        var schema: ResultSchema?
+        var resultSet = 0
+        var columns: [String]?
+        var names: [String] = []
+        var rows: [[String: SQLDataType]] = []
+        var byteCount = 0
+        var spill: SpillFileWriter?
+        var rowCount = 0
+        var stoppedEarly = false
+        var row = RowData()
+        while true {
+            let status = fetchNextRow(conn, &row)
+            if status == 0 { break }
+            guard status > 0 else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: lastErrorMessage(conn, or: "Query failed")
+                )
+            }
+            defer { freeRowContents(&row) }
+            if Int(resultSetOrdinal(conn)) != resultSet {
+                guard columns == nil else {
+                    // A later result set; its columns would not match the spill file.
+                    dbcancel(conn)
+                    stoppedEarly = true
+                    break
+                }
+                resultSet = Int(resultSetOrdinal(conn))
+                schema = ResultSchema.current(conn)
+                names = schema?.names ?? []
+                columns = names
+            }
+            rowCount += 1
+
+            let dict = row.dictionary(names: names, encoding: encoding)
+            if let spill {
+                do {
+                    try spill.append(dict)
+                } catch {
+                    dbcancel(conn)
+                    throw error
+                }
+                continue
+            }
+            rows.append(dict)
+            byteCount += SQLResult.estimatedByteCount(ofRow: dict)
+            if byteCount > spillThreshold {
+                do {
+                    spill = try SpillFileWriter(directory: spillDirectory, columns: columns ?? [])
+                } catch {
+                    dbcancel(conn)
+                    throw error
+                }
+            }
+        }
+
+        var result = SQLResult(
+            columns: columns ?? [],
+            storedRows: rows,
+            spilledRows: try spill?.finish(),
+            // After a cancel dbcount no longer describes the kept result set.
+            affectedRows: stoppedEarly ? rowCount : Int(dbcount(conn))
+        )
+        result.schema = schema
+        return result
+    }
+}
+
+// MARK: - Spill file
+
+/// Writes rows to an unlinked temporary file in the binary value encoding, then
+/// maps it for reading.
+///
+/// Each row is a little-endian `UInt32` byte length followed by one tagged value
+/// per column, in column order. Every `SpilledRows.blockSize`-th row offset is
+/// remembered so random access only has to step over a few rows.
+final class SpillFileWriter {
+    private let columns: [String]
+    private var descriptor: Int32
+    private var writer = BinaryWriter()
+    private var flushedByteCount = 0
+    private var blockOffsets: [Int] = []
+    private var rowCount = 0
+
+    init(directory: URL, columns: [String]) throws {
+        self.columns = columns
+        var template = Array(directory.appendingPathComponent("FreeTDSKit-spill-XXXXXX").path.utf8CString)
+        descriptor = template.withUnsafeMutableBufferPointer { mkstemp($0.baseAddress!) }
+        guard descriptor >= 0 else {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: "Could not create a spill file in \(directory.path): \(String(cString: strerror(errno)))"
+            )
+        }
+        // Without a name, the file is reclaimed once it is closed and unmapped,
+        // even if the process dies first.
+        unlink(template)
+        writer.bytes.reserveCapacity(Self.flushSize)
+    }
+
+    deinit {
+        if descriptor >= 0 { close(descriptor) }
+    }
+
+    private static let flushSize = 1 << 20
+
+    func append(_ row: [String: SQLDataType]) throws {
+        if rowCount % SpilledRows.blockSize == 0 {
+            blockOffsets.append(flushedByteCount + writer.bytes.count)
+        }
+        let start = writer.bytes.count
+        writer.write(fixed: UInt32(0))
+        for name in columns {
+            if let value = row[name] {
+                writer.write(value)
+            } else {
+                writer.write(BinaryValueTag.absent.rawValue)
+            }
+        }
+        guard let length = UInt32(exactly: writer.bytes.count - start - 4) else {
+            throw TDSConnectionError.queryExecutionFailed(reason: "Row is too large to spill")
+        }
+        writer.bytes.withUnsafeMutableBytes {
+            $0.storeBytes(of: length.littleEndian, toByteOffset: start, as: UInt32.self)
+        }
+        rowCount += 1
+        if writer.bytes.count >= Self.flushSize {
+            try flush()
+        }
+    }
+
+    private func flush() throws {
+        try writer.bytes.withUnsafeBytes { raw in
+            var done = 0
+            while done < raw.count {
+                let written = write(descriptor, raw.baseAddress! + done, raw.count - done)
+                if written < 0 {
+                    if errno == EINTR { continue }
+                    throw TDSConnectionError.queryExecutionFailed(
+                        reason: "Writing the spill file failed: \(String(cString: strerror(errno)))"
+                    )
+                }
+                done += written
+            }
+        }
+        flushedByteCount += writer.bytes.count
+        writer.bytes.removeAll(keepingCapacity: true)
+    }
+
+    /// Flush the remaining rows and map the file read-only.
+    func finish() throws -> SpilledRows {
+        try flush()
+        var base: UnsafeRawPointer?
+        if flushedByteCount > 0 {
+            guard
+                let mapped = mmap(nil, flushedByteCount, PROT_READ, MAP_PRIVATE, descriptor, 0),
+                mapped != UnsafeMutableRawPointer(bitPattern: -1)
+            else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: "Mapping the spill file failed: \(String(cString: strerror(errno)))"
+                )
+            }
+            base = UnsafeRawPointer(mapped)
+        }
+        // The mapping keeps the file alive.
+        close(descriptor)
+        descriptor = -1
+        return SpilledRows(
+            base: base,
+            byteCount: flushedByteCount,
+            columns: columns,
+            count: rowCount,
+            blockOffsets: blockOffsets
+        )
+    }
+}
+
+/// Rows of a spilled result, decoded on access from a read-only memory map.
+/// Immutable once created, so it can be read from any thread.
+final class SpilledRows: @unchecked Sendable {
+    static let blockSize = 64
+
+    let columns: [String]
+    let count: Int
+    /// Bytes of spilled data, on disk rather than in the heap.
+    let byteCount: Int
+    private let base: UnsafeRawPointer?
+    private let blockOffsets: [Int]
+
+    init(base: UnsafeRawPointer?, byteCount: Int, columns: [String], count: Int, blockOffsets: [Int]) {
+        self.base = base
+        self.byteCount = byteCount
+        self.columns = columns
+        self.count = count
+        self.blockOffsets = blockOffsets
+    }
+
+    deinit {
+        if let base {
+            munmap(UnsafeMutableRawPointer(mutating: base), byteCount)
+        }
+    }
+
+    /// Heap memory held for the spilled rows.
+    var residentByteCount: Int {
+        blockOffsets.count * MemoryLayout<Int>.stride
+    }
+
+    private var buffer: UnsafeRawBufferPointer {
+        UnsafeRawBufferPointer(start: base, count: byteCount)
+    }
+
+    /// Value of the column at `column` in spilled row `index`.
+    func value(row index: Int, column: Int) -> SQLDataType? {
+        guard (0..<count).contains(index), columns.indices.contains(column) else { return nil }
+        var reader = BinaryReader(buffer, offset: offset(of: index) + 4)
+        do {
+            for _ in 0..<column {
+                _ = try reader.readValue()
+            }
+            return try reader.readValue()
+        } catch {
+            return nil
+        }
+    }
+
+    /// Spilled row `index`, keyed by column name.
+    func row(at index: Int) -> [String: SQLDataType]? {
+        guard (0..<count).contains(index) else { return nil }
+        return decodeRow(at: offset(of: index)).row
+    }
+
+    /// Every spilled row, read into memory.
+    var allRows: [[String: SQLDataType]] {
+        Array(IteratorSequence(makeIterator()))
+    }
+
+    func makeIterator() -> Iterator {
+        Iterator(rows: self)
+    }
+
+    struct Iterator: IteratorProtocol {
+        let rows: SpilledRows
+        var index = 0
+        var offset = 0
+
+        mutating func next() -> [String: SQLDataType]? {
+            guard index < rows.count else { return nil }
+            let (row, next) = rows.decodeRow(at: offset)
+            index += 1
+            offset = next
+            return row
+        }
+    }
+
+    /// Byte offset of row `index`, stepping forward from the nearest block start.
+    private func offset(of index: Int) -> Int {
+        var offset = blockOffsets[index / Self.blockSize]
+        for _ in 0..<(index % Self.blockSize) {
+            offset += 4 + Int(UInt32(littleEndian: buffer.loadUnaligned(fromByteOffset: offset, as: UInt32.self)))
+        }
+        return offset
+    }
+
+    /// Decode the row at byte `offset` and return it with the offset of the next row.
+    private func decodeRow(at offset: Int) -> (row: [String: SQLDataType], next: Int) {
+        let length = Int(UInt32(littleEndian: buffer.loadUnaligned(fromByteOffset: offset, as: UInt32.self)))
+        var reader = BinaryReader(buffer, offset: offset + 4)
+        var row: [String: SQLDataType] = [:]
+        row.reserveCapacity(columns.count)
+        do {
+            for name in columns {
+                if let value = try reader.readValue() { row[name] = value }
+            }
+        } catch {
+            // The file was written by this process, so this only happens if it was
+            // truncated underneath us. The remaining cells read as missing.
+        }
+        return (row, offset + 4 + length)
+    }
+}
@@ -9,34 +9,69 @@ import Foundation
 
 public struct SQLResult {
     public let columns: [String]  // Column names
-    public let rows: [[String: SQLDataType]]  // Rows with typed data
     public let affectedRows: Int  // Affected rows count
+    let storedRows: [[String: SQLDataType]]  // Rows held in memory
+    let spilledRows: SpilledRows?  // Rows past the spill threshold, on disk
+    /// Server statistics, when the query was run with `collectStatistics`.
+    public internal(set) var statistics: QueryStatistics?
+    /// Types, precision, nullability and identity of the columns, for results
+    /// fetched from the server. `nil` for results built by hand or decoded.
+    public internal(set) var schema: ResultSchema?
 
     public init(
         columns: [String],
         rows: [[String: SQLDataType]],
         affectedRows: Int
+    ) {
+        self.init(columns: columns, storedRows: rows, spilledRows: nil, affectedRows: affectedRows)
+    }
+
+    init(
+        columns: [String],
+        storedRows: [[String: SQLDataType]],
+        spilledRows: SpilledRows?,
+        affectedRows: Int
     ) {
         self.columns = columns
-        self.rows = rows
+        self.storedRows = storedRows
+        self.spilledRows = spilledRows
         self.affectedRows = affectedRows
     }
 
+    /// Rows with typed data. For a result that spilled to disk this reads every
+    /// row back into memory; prefer the subscripts or iterating the result.
+    public var rows: [[String: SQLDataType]] {
+        guard let spilledRows else { return storedRows }
+        return storedRows + spilledRows.allRows
+    }
+
+    /// Number of rows.
+    public var count: Int {
+        storedRows.count + (spilledRows?.count ?? 0)
+    }
+
+    /// Whether some rows were written to a spill file.
+    public var isSpilled: Bool {
+        spilledRows != nil
+    }
 }
 
 extension SQLResult {
 
     public subscript(_ row: Int, _ column: String) -> SQLDataType? {
-        guard rows.indices.contains(row) else { return nil }
-        return rows[row][column]
+        if storedRows.indices.contains(row) { return storedRows[row][column] }
+        guard let spilledRows, row >= storedRows.count,
+            let colIndex = columns.firstIndex(of: column)
+        else { return nil }
+        return spilledRows.value(row: row - storedRows.count, column: colIndex)
     }
 
     /// Row index + column index (uses `columns`)
     public subscript(_ row: Int, column colIndex: Int) -> SQLDataType? {
-        guard rows.indices.contains(row),
-            columns.indices.contains(colIndex)
-        else { return nil }
-        return rows[row][columns[colIndex]]
+        guard columns.indices.contains(colIndex) else { return nil }
+        if storedRows.indices.contains(row) { return storedRows[row][columns[colIndex]] }
+        guard let spilledRows, row >= storedRows.count else { return nil }
+        return spilledRows.value(row: row - storedRows.count, column: colIndex)
     }
 }
 
@@ -60,8 +95,20 @@ extension SQLResult {
 //}
 extension SQLResult: Sequence {
     public typealias Element = [String: SQLDataType]
-    public func makeIterator() -> IndexingIterator<[[String: SQLDataType]]> {
-        rows.makeIterator()
+
+    public struct Iterator: IteratorProtocol {
+        var stored: IndexingIterator<[[String: SQLDataType]]>
+        var spilled: SpilledRows.Iterator?
+
+        public mutating func next() -> [String: SQLDataType]? {
+            stored.next() ?? spilled?.next()
+        }
+    }
+
+    public func makeIterator() -> Iterator {
+        Iterator(stored: storedRows.makeIterator(), spilled: spilledRows?.makeIterator())
     }
+
+    public var underestimatedCount: Int { count }
 }
 extension SQLResult: Sendable {}
@@ -0,0 +1,352 @@
+//
+//  SQLResultCache.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Synchronization
+
+/// An opt-in, size-bounded cache of `SQLResult` values.
+///
+/// Entries are keyed by normalized SQL, parameter values and the server and
+/// database the query ran against, expire after a
+/// per-entry TTL, and are evicted least-recently-used first once the total
+/// estimated size exceeds `maxBytes`. `SQLResult` is an immutable value type,
+/// so a hit hands back the shared copy without re-running the query.
+public final class SQLResultCache: Sendable {
+
+    /// Cache key built from SQL text with insignificant whitespace collapsed.
+    public struct Key: Hashable, Sendable {
+        public let sql: String
+        public let parameters: [String]
+        /// Where the query runs, such as `"server/database"`, so that one cache
+        /// can be shared by connections to different databases.
+        public let scope: String
+
+        public init(sql: String, parameters: [String] = [], scope: String = "") {
+            self.sql = SQLResultCache.normalize(sql)
+            self.parameters = parameters
+            self.scope = scope
+        }
+    }
+
+    /// Counters describing cache effectiveness since creation (or the last `resetMetrics()`).
+    public struct Metrics: Equatable, Sendable {
+        public var hits: Int = 0
+        public var misses: Int = 0
+        public var insertions: Int = 0
+        public var evictions: Int = 0
+        public var expirations: Int = 0
+        public var invalidations: Int = 0
+        public var entryCount: Int = 0
+        public var totalBytes: Int = 0
+
+        /// Fraction of lookups served from the cache, or 0 when nothing was looked up.
+        public var hitRate: Double {
+            let lookups = hits + misses
+            return lookups == 0 ? 0 : Double(hits) / Double(lookups)
+        }
+    }
+
+    /// Upper bound on the summed `estimatedByteCount` of all cached results.
+    public let maxBytes: Int
+    /// TTL used when `insert` is called without one.
+    public let defaultTTL: Duration
+
+    private let storage: Mutex<Storage>
+
+    public init(maxBytes: Int = 64 * 1024 * 1024, defaultTTL: Duration = .seconds(60)) {
+        self.maxBytes = maxBytes
+        self.defaultTTL = defaultTTL
+        self.storage = Mutex(Storage())
+    }
+
+    /// Look up a live entry, refreshing its LRU position. Expired entries are dropped.
+    public func value(forKey key: Key) -> SQLResult? {
+        let now = ContinuousClock.now
+        return storage.withLock { $0.lookup(key, now: now) }
+    }
+
+    /// Store `result` under `key`. Results larger than `maxBytes` are not cached.
+    public func insert(
+        _ result: SQLResult,
+        forKey key: Key,
+        ttl: Duration? = nil,
+        tags: Set<String> = []
+    ) {
+        let bytes = result.estimatedByteCount
+        guard bytes <= maxBytes else { return }
+        let expiry = ContinuousClock.now.advanced(by: ttl ?? defaultTTL)
+        let limit = maxBytes
+        storage.withLock {
+            $0.insert(result, key: key, bytes: bytes, expiry: expiry, tags: tags, limit: limit)
+        }
+    }
+
+    /// Drop a single entry.
+    public func invalidate(key: Key) {
+        storage.withLock { $0.invalidate(key) }
+    }
+
+    /// Drop every entry that was inserted with `tag`.
+    public func invalidate(tag: String) {
+        storage.withLock { storage in
+            for key in storage.keys(taggedWith: tag) {
+                storage.invalidate(key)
+            }
+        }
+    }
+
+    /// Drop every entry.
+    public func removeAll() {
+        storage.withLock { storage in
+            let invalidations = storage.metrics.invalidations + storage.entries.count
+            storage = Storage()
+            storage.metrics.invalidations = invalidations
+        }
+    }
+
+    public var metrics: Metrics {
+        storage.withLock { $0.metrics }
+    }
+
+    public func resetMetrics() {
+        storage.withLock { storage in
+            storage.metrics = Metrics(
+                entryCount: storage.metrics.entryCount,
+                totalBytes: storage.metrics.totalBytes
+            )
+        }
+    }
+
+    /// Collapse whitespace runs and drop comments outside of string literals, and
+    /// strip trailing semicolons, so trivially reformatted statements share a
+    /// cache entry.
+    static func normalize(_ sql: String) -> String {
+        let scalars = Array(sql.unicodeScalars)
+        var out = String.UnicodeScalarView()
+        var quote: Unicode.Scalar? = nil
+        var pendingSpace = false
+        var i = 0
+        while i < scalars.count {
+            let scalar = scalars[i]
+            let next = i + 1 < scalars.count ? scalars[i + 1] : nil
+            i += 1
+            if let q = quote {
+                out.append(scalar)
+                if scalar == q { quote = nil }
+                continue
+            }
+            // A comment reads as whitespace, so a quote inside it opens no literal.
+            // A line comment runs to, but not over, its newline.
+            if scalar == "-", next == "-" {
+                while i < scalars.count, scalars[i] != "\n" { i += 1 }
+                pendingSpace = !out.isEmpty
+                continue
+            }
+            if scalar == "/", next == "*" {
+                // T-SQL block comments nest.
+                var depth = 1
+                i += 1
+                while i < scalars.count, depth > 0 {
+                    let current = scalars[i]
+                    let following = i + 1 < scalars.count ? scalars[i + 1] : nil
+                    if current == "/", following == "*" {
+                        depth += 1
+                        i += 2
+                    } else if current == "*", following == "/" {
+                        depth -= 1
+                        i += 2
+                    } else {
+                        i += 1
+                    }
+                }
+                pendingSpace = !out.isEmpty
+                continue
+            }
+            if scalar.properties.isWhitespace {
+                pendingSpace = !out.isEmpty
+                continue
+            }
+            if pendingSpace {
+                out.append(" ")
+                pendingSpace = false
+            }
+            if scalar == "'" || scalar == "\"" || scalar == "[" {
+                quote = scalar == "[" ? "]" : scalar
+            }
+            out.append(scalar)
+        }
+        var normalized = String(out)
+        while normalized.last == ";" || normalized.last == " " {
+            normalized.removeLast()
+        }
+        return normalized
+    }
+}
+
+// MARK: - LRU storage
+
+extension SQLResultCache {
+
+    /// Doubly linked LRU list stored in an array, indexed from a dictionary so
+    /// lookups, promotions and evictions are O(1).
+    fileprivate struct Storage {
+        struct Node {
+            var key: Key
+            var result: SQLResult
+            var bytes: Int
+            var expiry: ContinuousClock.Instant
+            var tags: Set<String>
+            var prev: Int?
+            var next: Int?
+        }
+
+        var entries: [Key: Int] = [:]
+        var nodes: [Node?] = []
+        var freeSlots: [Int] = []
+        var tagIndex: [String: Set<Key>] = [:]
+        var head: Int?  // most recently used
+        var tail: Int?  // least recently used
+        var metrics = Metrics()
+
+        mutating func lookup(_ key: Key, now: ContinuousClock.Instant) -> SQLResult? {
+            guard let index = entries[key], let node = nodes[index] else {
+                metrics.misses += 1
+                return nil
+            }
+            if node.expiry <= now {
+                remove(at: index)
+                metrics.expirations += 1
+                metrics.misses += 1
+                return nil
+            }
+            moveToFront(index)
+            metrics.hits += 1
+            return node.result
+        }
+
+        mutating func insert(
+            _ result: SQLResult,
+            key: Key,
+            bytes: Int,
+            expiry: ContinuousClock.Instant,
+            tags: Set<String>,
+            limit: Int
+        ) {
+            if let existing = entries[key] {
+                remove(at: existing)
+            }
+            while metrics.totalBytes + bytes > limit, let lru = tail {
+                remove(at: lru)
+                metrics.evictions += 1
+            }
+
+            let node = Node(
+                key: key, result: result, bytes: bytes, expiry: expiry,
+                tags: tags, prev: nil, next: head
+            )
+            let index: Int
+            if let slot = freeSlots.popLast() {
+                nodes[slot] = node
+                index = slot
+            } else {
+                nodes.append(node)
+                index = nodes.count - 1
+            }
+            if let oldHead = head { nodes[oldHead]?.prev = index }
+            head = index
+            if tail == nil { tail = index }
+
+            entries[key] = index
+            for tag in tags { tagIndex[tag, default: []].insert(key) }
+            metrics.insertions += 1
+            metrics.entryCount += 1
+            metrics.totalBytes += bytes
+        }
+
+        mutating func invalidate(_ key: Key) {
+            guard let index = entries[key] else { return }
+            remove(at: index)
+            metrics.invalidations += 1
+        }
+
+        func keys(taggedWith tag: String) -> Set<Key> {
+            tagIndex[tag] ?? []
+        }
+
+        private mutating func unlink(_ index: Int) {
+            guard let node = nodes[index] else { return }
+            if let prev = node.prev { nodes[prev]?.next = node.next } else { head = node.next }
+            if let next = node.next { nodes[next]?.prev = node.prev } else { tail = node.prev }
+            nodes[index]?.prev = nil
+            nodes[index]?.next = nil
+        }
+
+        private mutating func moveToFront(_ index: Int) {
+            guard head != index else { return }
+            unlink(index)
+            nodes[index]?.next = head
+            if let oldHead = head { nodes[oldHead]?.prev = index }
+            head = index
+            if tail == nil { tail = index }
+        }
+
+        private mutating func remove(at index: Int) {
+            guard let node = nodes[index] else { return }
+            unlink(index)
+            nodes[index] = nil
+            freeSlots.append(index)
+            entries[node.key] = nil
+            for tag in node.tags {
+                tagIndex[tag]?.remove(node.key)
+                if tagIndex[tag]?.isEmpty == true { tagIndex[tag] = nil }
+            }
+            metrics.entryCount -= 1
+            metrics.totalBytes -= node.bytes
+        }
+    }
+}
+
+// MARK: - Size estimation
+
+extension SQLDataType {
+    /// Approximate in-memory footprint of the value, including heap payloads.
+    var estimatedByteCount: Int {
+        let inline = MemoryLayout<SQLDataType>.stride
+        switch self {
+        case .char(let s), .varchar(let s), .nchar(let s), .nvarchar(let s), .text(let s):
+            // Strings of up to 15 UTF-8 bytes are stored inline.
+            return inline + (s.utf8.count > 15 ? s.utf8.count + 32 : 0)
+        case .spatial(let wkt):
+            return inline + (wkt.value.utf8.count > 15 ? wkt.value.utf8.count + 32 : 0)
+        case .binary(let d), .varbinary(let d):
+            return inline + (d.count > 14 ? d.count + 32 : 0)
+        default:
+            return inline
+        }
+    }
+}
+
+extension SQLResult {
+    /// Approximate in-memory footprint of the result, used for cache budgeting.
+    /// Spilled rows live on disk and only count for their index.
+    var estimatedByteCount: Int {
+        var total = columns.reduce(0) { $0 + MemoryLayout<String>.stride + $1.utf8.count }
+        for row in storedRows {
+            total += Self.estimatedByteCount(ofRow: row)
+        }
+        return total + (spilledRows?.residentByteCount ?? 0)
+    }
+
+    /// Approximate in-memory footprint of one row dictionary.
+    static func estimatedByteCount(ofRow row: [String: SQLDataType]) -> Int {
+        let slot = MemoryLayout<String>.stride + MemoryLayout<SQLDataType>.stride
+        // Dictionary header plus ~4/3 load-factor slack per slot.
+        var total = 48 + (row.count * slot * 4) / 3
+        for value in row.values {
+            total += value.estimatedByteCount - MemoryLayout<SQLDataType>.stride
+        }
+        return total
+    }
+}
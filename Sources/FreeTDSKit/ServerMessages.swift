@@ -0,0 +1,227 @@
+//
+//  ServerMessages.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+import Synchronization
+
+/// A message sent by the server: `PRINT` output, `RAISERROR`, statistics or an
+/// error.
+public struct ServerMessage: Sendable, Equatable {
+    public var number: Int
+    public var severity: Int
+    public var state: Int
+    /// The stored procedure that raised the message, if any.
+    public var procedure: String?
+    public var line: Int
+    public var text: String
+
+    public init(number: Int, severity: Int, state: Int, procedure: String?, line: Int, text: String) {
+        self.number = number
+        self.severity = severity
+        self.state = state
+        self.procedure = procedure
+        self.line = line
+        self.text = text
+    }
+
+    /// Whether the message reports an error rather than information.
+    public var isError: Bool { severity >= 11 }
+}
+
+extension TDSConnection {
+
+    /// Messages the server sends on this connection, delivered as they arrive,
+    /// including while a query is still running.
+    ///
+    /// Iterate from a separate task to follow the progress of a long command, for
+    /// example a procedure that reports with `RAISERROR (..., 0, 1) WITH NOWAIT`.
+    /// Messages are only kept while an iteration is active, and only one
+    /// iteration per connection can be active at a time; a second one ends at
+    /// once. The sequence ends when the connection is closed.
+    public nonisolated func serverMessages() -> ServerMessages {
+        ServerMessages(ring: messageRing)
+    }
+
+    /// Route the messages of session `conn` into `messageRing`.
+    nonisolated func attachMessageRing(to conn: OpaquePointer) {
+        let context = Unmanaged.passUnretained(messageRing).toOpaque()
+        setMessageSink(conn, { context, message in
+            guard let context, let message else { return }
+            let ring = Unmanaged<ServerMessageRing>.fromOpaque(context).takeUnretainedValue()
+            guard ring.isListening else { return }
+            let procedure = message.pointee.procedure.map { String(cString: $0) }
+            ring.push(
+                ServerMessage(
+                    number: message.pointee.number,
+                    severity: Int(message.pointee.severity),
+                    state: Int(message.pointee.state),
+                    procedure: procedure?.isEmpty == false ? procedure : nil,
+                    line: Int(message.pointee.line),
+                    text: message.pointee.text.map { String(cString: $0) } ?? ""
+                )
+            )
+        }, context)
+    }
+}
+
+/// The server messages of one connection, as an async sequence.
+public struct ServerMessages: AsyncSequence, Sendable {
+    public typealias Element = ServerMessage
+
+    let ring: ServerMessageRing
+
+    /// Messages dropped so far because the consumer fell `ServerMessageRing.capacity`
+    /// messages behind.
+    public var droppedCount: Int {
+        ring.droppedCount
+    }
+
+    public func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(subscription: Subscription(ring: ring))
+    }
+
+    public struct AsyncIterator: AsyncIteratorProtocol {
+        let subscription: Subscription
+
+        public mutating func next() async -> ServerMessage? {
+            guard subscription.isActive else { return nil }
+            return await subscription.ring.next()
+        }
+    }
+
+    /// Holds the ring's single consumer slot for the life of an iterator.
+    final class Subscription: Sendable {
+        let ring: ServerMessageRing
+        let isActive: Bool
+
+        init(ring: ServerMessageRing) {
+            self.ring = ring
+            self.isActive = ring.subscribe()
+        }
+
+        deinit {
+            if isActive { ring.unsubscribe() }
+        }
+    }
+}
+
+/// Single-producer, single-consumer ring of server messages.
+///
+/// The producer is whichever executor thread runs the connection's current
+/// command; commands never overlap, so there is only ever one. It publishes with
+/// atomic stores and never blocks: when the ring is full the message is dropped
+/// and counted. A lock is only taken to wake a consumer that is parked waiting.
+final class ServerMessageRing: @unchecked Sendable {
+    static let capacity = 256
+
+    private let slots: UnsafeMutablePointer<ServerMessage?>
+    private let mask = ServerMessageRing.capacity - 1
+    // Next slot to read; advanced only by the consumer.
+    private let head = Atomic<Int>(0)
+    // Next slot to write; advanced only by the producer.
+    private let tail = Atomic<Int>(0)
+    private let dropped = Atomic<Int>(0)
+    private let listening = Atomic<Bool>(false)
+    private let claimed = Atomic<Bool>(false)
+    private let finished = Atomic<Bool>(false)
+    private let hasWaiter = Atomic<Bool>(false)
+    private let waiter = Mutex<CheckedContinuation<Void, Never>?>(nil)
+
+    init() {
+        slots = .allocate(capacity: Self.capacity)
+        slots.initialize(repeating: nil, count: Self.capacity)
+    }
+
+    deinit {
+        slots.deinitialize(count: Self.capacity)
+        slots.deallocate()
+    }
+
+    var isListening: Bool {
+        listening.load(ordering: .relaxed)
+    }
+
+    var droppedCount: Int {
+        dropped.load(ordering: .relaxed)
+    }
+
+    // MARK: Producer
+
+    func push(_ message: ServerMessage) {
+        let t = tail.load(ordering: .relaxed)
+        guard t - head.load(ordering: .acquiring) < Self.capacity else {
+            dropped.wrappingAdd(1, ordering: .relaxed)
+            return
+        }
+        slots[t & mask] = message
+        tail.store(t + 1, ordering: .sequentiallyConsistent)
+        wakeConsumer()
+    }
+
+    /// End the sequence once the buffered messages are read.
+    func finish() {
+        finished.store(true, ordering: .sequentiallyConsistent)
+        wakeConsumer()
+    }
+
+    // MARK: Consumer
+
+    /// Claim the consumer side, discarding messages left by an earlier consumer.
+    /// Returns `false` if another consumer holds it.
+    func subscribe() -> Bool {
+        guard claimed.compareExchange(expected: false, desired: true, ordering: .acquiring).exchanged
+        else { return false }
+        while pop() != nil {}
+        listening.store(true, ordering: .releasing)
+        return true
+    }
+
+    func unsubscribe() {
+        listening.store(false, ordering: .relaxed)
+        claimed.store(false, ordering: .releasing)
+    }
+
+    func next() async -> ServerMessage? {
+        while true {
+            if let message = pop() { return message }
+            if finished.load(ordering: .sequentiallyConsistent) { return pop() }
+            if Task.isCancelled { return nil }
+            await withTaskCancellationHandler {
+                await withCheckedContinuation { continuation in
+                    waiter.withLock { $0 = continuation }
+                    hasWaiter.store(true, ordering: .sequentiallyConsistent)
+                    // Pairs with the producer's store to `tail` then load of
+                    // `hasWaiter`: one side always sees the other.
+                    if tail.load(ordering: .sequentiallyConsistent) != head.load(ordering: .relaxed)
+                        || finished.load(ordering: .sequentiallyConsistent) || Task.isCancelled
+                    {
+                        wakeConsumer()
+                    }
+                }
+            } onCancel: {
+                wakeConsumer()
+            }
+        }
+    }
+
+    private func pop() -> ServerMessage? {
+        let h = head.load(ordering: .relaxed)
+        guard h != tail.load(ordering: .acquiring) else { return nil }
+        let message = slots[h & mask].take()
+        head.store(h + 1, ordering: .releasing)
+        return message
+    }
+
+    private func wakeConsumer() {
+        guard hasWaiter.load(ordering: .sequentiallyConsistent) else { return }
+        let continuation = waiter.withLock { waiter -> CheckedContinuation<Void, Never>? in
+            hasWaiter.store(false, ordering: .relaxed)
+            defer { waiter = nil }
+            return waiter
+        }
+        continuation?.resume()
+    }
+}
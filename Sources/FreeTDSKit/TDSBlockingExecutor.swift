@@ -0,0 +1,78 @@
+//
+//  TDSBlockingExecutor.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+/// A fixed pool of OS threads that runs the blocking DB-Library calls
+/// (`dbsqlexec`, `dbresults`, `dbnextrow`, ...) behind `TDSConnection`.
+///
+/// Those calls park their thread until the server answers. Running them here
+/// rather than on the global cooperative pool keeps slow queries from starving
+/// unrelated async work such as request handlers and timers. Size the pool to
+/// the number of queries expected to be in flight at once; extra work queues.
+/// Threads live for the lifetime of the process.
+public final class TDSBlockingExecutor: TaskExecutor, @unchecked Sendable {
+    /// Pool used by connections that are not given one explicitly.
+    public static let shared = TDSBlockingExecutor(
+        threadCount: max(4, ProcessInfo.processInfo.activeProcessorCount)
+    )
+
+    /// Number of worker threads.
+    public let threadCount: Int
+
+    // Guarded by `condition`.
+    private let condition = NSCondition()
+    private var jobs: [UnownedJob] = []
+    private var head = 0
+
+    public init(threadCount: Int, name: String = "FreeTDSKit.blocking") {
+        precondition(threadCount > 0, "TDSBlockingExecutor needs at least one thread")
+        self.threadCount = threadCount
+        for index in 0..<threadCount {
+            let thread = Thread { self.runJobs() }
+            thread.name = "\(name).\(index)"
+            thread.start()
+        }
+    }
+
+    public func enqueue(_ job: consuming ExecutorJob) {
+        let job = UnownedJob(job)
+        condition.lock()
+        jobs.append(job)
+        condition.signal()
+        condition.unlock()
+    }
+
+    /// Jobs waiting for a free thread.
+    public var pendingJobCount: Int {
+        condition.lock()
+        defer { condition.unlock() }
+        return jobs.count - head
+    }
+
+    private func runJobs() {
+        let executor = asUnownedTaskExecutor()
+        while true {
+            condition.lock()
+            while head == jobs.count {
+                condition.wait()
+            }
+            let job = jobs[head]
+            head += 1
+            if head == jobs.count {
+                jobs.removeAll(keepingCapacity: true)
+                head = 0
+            } else if head > jobs.count / 2 {
+                // Under steady load the queue may never drain. Dropping the run
+                // jobs once they are the majority keeps the array bounded by
+                // twice the backlog and moves each job at most once on average.
+                jobs.removeFirst(head)
+                head = 0
+            }
+            condition.unlock()
+            job.runSynchronously(on: executor)
+        }
+    }
+}
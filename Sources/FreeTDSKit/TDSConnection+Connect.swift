@@ -0,0 +1,123 @@
+//
+//  TDSConnection+Connect.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Synchronization
+
+extension TDSConnection {
+
+    /// Open a connection without blocking the caller.
+    ///
+    /// The login (`dbopen` and `dbuse`) runs on the configuration's executor rather
+    /// than the calling thread or the cooperative pool. Cancelling the calling task
+    /// throws `CancellationError` right away; DB-Library cannot abandon a login part
+    /// way, so a login that still completes is closed in the background.
+    public static func connect(configuration: ConnectionConfiguration) async throws -> TDSConnection {
+        try Task.checkCancellation()
+        let login = PendingLogin()
+        return try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { continuation in
+                guard login.begin(continuation) else { return }
+                Task.detached(executorPreference: configuration.executor, priority: .userInitiated) {
+                    let result = Result { try TDSConnection(configuration: configuration) }
+                    if !login.complete(with: result), case .success(let connection) = result {
+                        await connection.close()
+                    }
+                }
+            }
+        } onCancel: {
+            login.cancel()
+        }
+    }
+
+    /// Open `count` connections concurrently, so startup takes about as long as
+    /// the slowest login rather than the sum. If any login fails, the connections
+    /// already opened are closed and the error is thrown.
+    public static func connect(
+        configuration: ConnectionConfiguration,
+        count: Int
+    ) async throws -> [TDSConnection] {
+        // Every login is waited for, so none that succeeds after another has
+        // failed is dropped without being closed.
+        let results = await withTaskGroup(of: Result<TDSConnection, Error>.self) { group in
+            for _ in 0..<count {
+                group.addTask {
+                    do {
+                        return .success(try await connect(configuration: configuration))
+                    } catch {
+                        return .failure(error)
+                    }
+                }
+            }
+            var results: [Result<TDSConnection, Error>] = []
+            results.reserveCapacity(count)
+            for await result in group {
+                results.append(result)
+            }
+            return results
+        }
+        var connections: [TDSConnection] = []
+        connections.reserveCapacity(count)
+        var failure: Error?
+        for result in results {
+            switch result {
+            case .success(let connection): connections.append(connection)
+            case .failure(let error): failure = failure ?? error
+            }
+        }
+        if let failure {
+            for connection in connections {
+                await connection.close()
+            }
+            throw failure
+        }
+        return connections
+    }
+}
+
+/// Hands the outcome of a login to whichever comes first: the waiting caller, or
+/// its cancellation.
+private final class PendingLogin: Sendable {
+    private enum State {
+        case idle
+        case waiting(CheckedContinuation<TDSConnection, Error>)
+        case done
+    }
+
+    private let state = Mutex(State.idle)
+
+    /// Store the caller's continuation. Returns `false`, having resumed it, if the
+    /// caller was already cancelled.
+    func begin(_ continuation: CheckedContinuation<TDSConnection, Error>) -> Bool {
+        let cancelled = state.withLock { state -> Bool in
+            guard case .idle = state else { return true }
+            state = .waiting(continuation)
+            return false
+        }
+        if cancelled {
+            continuation.resume(throwing: CancellationError())
+        }
+        return !cancelled
+    }
+
+    /// Deliver the login result. Returns `false` if the caller has gone away.
+    func complete(with result: Result<TDSConnection, Error>) -> Bool {
+        guard let continuation = take() else { return false }
+        continuation.resume(with: result)
+        return true
+    }
+
+    func cancel() {
+        take()?.resume(throwing: CancellationError())
+    }
+
+    private func take() -> CheckedContinuation<TDSConnection, Error>? {
+        state.withLock { state -> CheckedContinuation<TDSConnection, Error>? in
+            defer { state = .done }
+            if case .waiting(let continuation) = state { return continuation }
+            return nil
+        }
+    }
+}
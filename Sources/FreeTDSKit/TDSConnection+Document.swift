@@ -0,0 +1,142 @@
+//
+//  TDSConnection+Document.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+extension TDSConnection {
+
+    /// Run a `FOR JSON` or `FOR XML` query and return its output as one buffer.
+    ///
+    /// The server splits such output over many rows of a single text column, a
+    /// couple of thousand characters each. The rows are appended to the buffer
+    /// straight from DB-Library's row buffer, without building a row per chunk.
+    /// The bytes are in the client charset. A query that returns no rows gives
+    /// empty data; one whose result is not a single text column throws.
+    public func fetchDocument(queryString: String) async throws -> Data {
+        try await runBlocking { conn in
+            var document = Data()
+            try TDSConnection.readDocument(conn, queryString: queryString) { bytes, length in
+                document.append(UnsafeRawPointer(bytes).assumingMemoryBound(to: UInt8.self), count: length)
+            }
+            return document
+        }
+    }
+
+    /// Run a `FOR JSON` or `FOR XML` query and return its output as a string.
+    /// See `fetchDocument(queryString:)`.
+    public func fetchDocumentString(queryString: String) async throws -> String {
+        let encoding = textEncoding
+        let document = try await fetchDocument(queryString: queryString)
+        return document.withUnsafeBytes { raw -> String in
+            guard let base = raw.baseAddress?.assumingMemoryBound(to: CChar.self) else { return "" }
+            return encoding == .utf8
+                ? makeString(base, length: raw.count)
+                : makeString(base, length: raw.count, encoding: encoding)
+        }
+    }
+
+    /// Run a `FOR JSON` or `FOR XML` query and stream its output chunk by chunk,
+    /// one `Data` per row the server sent, in the client charset.
+    ///
+    /// Concatenating the chunks gives the document. At most `bufferSize` chunks are
+    /// held ahead of the consumer. Cancelling the consuming task, or dropping the
+    /// sequence before the end, cancels the query. As with `query(query:)`, the
+    /// connection is busy until the sequence ends.
+    public nonisolated func documentChunks(
+        queryString: String,
+        bufferSize: Int = 16
+    ) -> AsyncThrowingStream<Data, Error> {
+        let buffer = BoundedStreamBuffer<Data>(capacity: max(1, bufferSize))
+
+        Task.detached(executorPreference: executor, priority: .userInitiated) {
+            await self.beginCommand()
+            do {
+                let connRaw = try await self.liveConnection()
+                await TDSConnection.produceDocumentChunks(
+                    OpaquePointer(bitPattern: connRaw)!,
+                    queryString: queryString,
+                    into: buffer
+                )
+            } catch {
+                buffer.finish(throwing: error)
+            }
+            await self.endCommand()
+        }
+
+        return buffer.stream
+    }
+
+    /// Run `queryString` on `conn` and pass each chunk of its document to `body`.
+    /// The bytes are only valid during the call.
+    static func readDocument(
+        _ conn: OpaquePointer,
+        queryString: String,
+        _ body: (UnsafePointer<CChar>, Int) -> Void
+    ) throws {
+        guard executeQuery(conn, queryString) == 0 else {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: lastErrorMessage(conn, or: "Query failed")
+            )
+        }
+        while true {
+            var bytes: UnsafePointer<CChar>?
+            var length: Int32 = 0
+            let status = nextDocumentChunk(conn, &bytes, &length)
+            if status == 0 { return }
+            guard status > 0, let bytes else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: lastErrorMessage(conn, or: "Query failed")
+                )
+            }
+            body(bytes, Int(length))
+        }
+    }
+
+    private static func produceDocumentChunks(
+        _ conn: OpaquePointer,
+        queryString: String,
+        into buffer: BoundedStreamBuffer<Data>
+    ) async {
+        let connRaw = Int(bitPattern: conn)
+        clearCancelRequest(conn)
+        buffer.onCancel {
+            requestCancel(OpaquePointer(bitPattern: connRaw)!)
+        }
+        guard executeQuery(conn, queryString) == 0 else {
+            buffer.finish(
+                throwing: TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Query failed")
+                )
+            )
+            return
+        }
+
+        while true {
+            var bytes: UnsafePointer<CChar>?
+            var length: Int32 = 0
+            let status = nextDocumentChunk(conn, &bytes, &length)
+            if status == 0 {
+                buffer.finish()
+                return
+            }
+            guard status > 0, let bytes else {
+                // Also reached when the consumer cancelled; the stream has
+                // already ended then and the error goes unseen.
+                buffer.finish(
+                    throwing: TDSConnectionError.queryExecutionFailed(
+                        reason: TDSConnection.lastErrorMessage(conn, or: "Query failed")
+                    )
+                )
+                return
+            }
+            guard await buffer.send(Data(bytes: bytes, count: Int(length))) else {
+                // The consumer went away; discard the rest of the results.
+                dbcancel(conn)
+                return
+            }
+        }
+    }
+}
@@ -0,0 +1,215 @@
+//
+//  TDSConnection+Export.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+/// Text formats produced by `TDSConnection.export(queryString:format:...)`.
+public enum TDSExportFormat: Sendable {
+    /// RFC 4180 CSV with a header row and CRLF line endings. NULL is an empty field,
+    /// binary values are hex (`0x…`).
+    case csv
+    /// Newline-delimited JSON, one object per row. Binary values are base64 strings.
+    case ndjson
+    /// A single JSON array with one object per row, formatted like `ndjson`.
+    case json
+
+    var cValue: Int32 {
+        switch self {
+        case .csv: return Int32(TDS_EXPORT_CSV.rawValue)
+        case .ndjson: return Int32(TDS_EXPORT_NDJSON.rawValue)
+        case .json: return Int32(TDS_EXPORT_JSON.rawValue)
+        }
+    }
+}
+
+extension TDSConnection {
+
+    /// Run `queryString` and write its first result set to `fileDescriptor`.
+    ///
+    /// Cells are formatted in the C layer straight from the DB-Library row buffers
+    /// into `chunkSize`-byte chunks, so memory use stays constant regardless of
+    /// result size and no `SQLDataType` values are built. Returns the row count.
+    @discardableResult
+    public func export(
+        queryString: String,
+        format: TDSExportFormat,
+        to fileDescriptor: Int32,
+        chunkSize: Int = 1 << 20
+    ) async throws -> Int {
+        try await runBlocking { conn in
+            if executeQuery(conn, queryString) != 0 {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn)
+                )
+            }
+            let rows = exportResultsToFileDescriptor(
+                conn, format.cValue, fileDescriptor, chunkSize
+            )
+            guard rows >= 0 else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Export failed")
+                )
+            }
+            return Int(rows)
+        }
+    }
+
+    /// Run `queryString` and write its first result set to `fileHandle`.
+    @discardableResult
+    public func export(
+        queryString: String,
+        format: TDSExportFormat,
+        to fileHandle: FileHandle,
+        chunkSize: Int = 1 << 20
+    ) async throws -> Int {
+        try await export(
+            queryString: queryString,
+            format: format,
+            to: fileHandle.fileDescriptor,
+            chunkSize: chunkSize
+        )
+    }
+
+    /// Run `queryString` and return its first result set formatted as CSV or JSON.
+    public func export(
+        queryString: String,
+        format: TDSExportFormat,
+        chunkSize: Int = 1 << 20
+    ) async throws -> Data {
+        try await runBlocking { conn in
+            if executeQuery(conn, queryString) != 0 {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn)
+                )
+            }
+            let sink = ExportDataSink()
+            let rows = withExtendedLifetime(sink) {
+                exportResults(
+                    conn,
+                    format.cValue,
+                    { context, bytes, length in
+                        guard let context, let bytes else { return 0 }
+                        Unmanaged<ExportDataSink>.fromOpaque(context)
+                            .takeUnretainedValue()
+                            .append(bytes, count: length)
+                        return 0
+                    },
+                    Unmanaged.passUnretained(sink).toOpaque(),
+                    chunkSize
+                )
+            }
+            guard rows >= 0 else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Export failed")
+                )
+            }
+            return sink.data
+        }
+    }
+}
+
+extension TDSConnection {
+
+    /// Run `queryString` and stream its first result set, formatted as CSV or
+    /// JSON, as chunks of about `chunkSize` bytes.
+    ///
+    /// Rows are formatted in the C layer straight from the DB-Library row buffers,
+    /// with column names escaped once, and each chunk is handed over as soon as it
+    /// fills, so the chunks can be written to an HTTP response body as the server
+    /// produces rows. At most `bufferSize` chunks are held ahead of the consumer.
+    /// Cancelling the consuming task, or dropping the sequence before the end,
+    /// cancels the query. As with `query(query:)`, the connection is busy until
+    /// the sequence ends.
+    public nonisolated func exportStream(
+        queryString: String,
+        format: TDSExportFormat = .json,
+        chunkSize: Int = 64 << 10,
+        bufferSize: Int = 4
+    ) -> AsyncThrowingStream<Data, Error> {
+        let buffer = BoundedStreamBuffer<Data>(capacity: max(1, bufferSize))
+
+        Task.detached(executorPreference: executor, priority: .userInitiated) {
+            await self.beginCommand()
+            do {
+                let connRaw = try await self.liveConnection()
+                await TDSConnection.produceChunks(
+                    OpaquePointer(bitPattern: connRaw)!,
+                    queryString: queryString,
+                    format: format,
+                    chunkSize: chunkSize,
+                    into: buffer
+                )
+            } catch {
+                buffer.finish(throwing: error)
+            }
+            await self.endCommand()
+        }
+
+        return buffer.stream
+    }
+
+    private static func produceChunks(
+        _ conn: OpaquePointer,
+        queryString: String,
+        format: TDSExportFormat,
+        chunkSize: Int,
+        into buffer: BoundedStreamBuffer<Data>
+    ) async {
+        let connRaw = Int(bitPattern: conn)
+        clearCancelRequest(conn)
+        buffer.onCancel {
+            requestCancel(OpaquePointer(bitPattern: connRaw)!)
+        }
+        guard executeQuery(conn, queryString) == 0 else {
+            buffer.finish(
+                throwing: TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Query failed")
+                )
+            )
+            return
+        }
+        guard let cursor = openExport(conn, format.cValue, max(1, chunkSize)) else {
+            dbcancel(conn)
+            buffer.finish(throwing: TDSConnectionError.queryExecutionFailed(reason: "Export failed"))
+            return
+        }
+        defer { closeExport(cursor) }
+
+        while true {
+            var bytes: UnsafePointer<CChar>?
+            var length = 0
+            let status = exportNextChunk(cursor, &bytes, &length)
+            if status == 0 {
+                buffer.finish()
+                return
+            }
+            guard status > 0, let bytes else {
+                // Also reached when the consumer cancelled; the stream has
+                // already ended then and the error goes unseen.
+                buffer.finish(
+                    throwing: TDSConnectionError.queryExecutionFailed(
+                        reason: TDSConnection.lastErrorMessage(conn, or: "Export failed")
+                    )
+                )
+                return
+            }
+            let chunk = Data(bytes: bytes, count: length)
+            guard await buffer.send(chunk) else {
+                // The consumer went away; closeExport discards the rest.
+                return
+            }
+        }
+    }
+}
+
+/// Collects exported chunks into `Data` for the in-memory export path.
+final class ExportDataSink {
+    var data = Data()
+
+    func append(_ bytes: UnsafePointer<CChar>, count: Int) {
+        data.append(UnsafeRawPointer(bytes).assumingMemoryBound(to: UInt8.self), count: count)
+    }
+}
@@ -0,0 +1,231 @@
+//
+//  TDSConnection+Procedure.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+/// An argument to `TDSConnection.callProcedure(name:parameters:)`.
+public struct ProcedureParameter: Sendable {
+    /// Parameter name. A leading `@` is added if missing.
+    public var name: String
+    /// Value sent to the server. Its case also selects the parameter type, so an
+    /// output-only parameter still needs a typed placeholder such as `.integer(0)`.
+    public var value: SQLDataType
+    /// Whether the parameter is passed as `OUTPUT`.
+    public var isOutput: Bool
+
+    public init(name: String, value: SQLDataType, isOutput: Bool = false) {
+        self.name = name
+        self.value = value
+        self.isOutput = isOutput
+    }
+
+    /// An input parameter.
+    public static func input(_ name: String, _ value: SQLDataType) -> ProcedureParameter {
+        ProcedureParameter(name: name, value: value)
+    }
+
+    /// An `OUTPUT` parameter, sent with `value` as its initial value.
+    public static func output(_ name: String, _ value: SQLDataType) -> ProcedureParameter {
+        ProcedureParameter(name: name, value: value, isOutput: true)
+    }
+}
+
+/// Everything a stored procedure call returned.
+public struct ProcedureResult: Sendable {
+    /// Row-returning result sets, in the order the procedure produced them.
+    public let resultSets: [SQLResult]
+    /// The procedure's `RETURN` value, if the server sent one.
+    public let returnStatus: Int?
+    /// Output parameter values keyed by parameter name, including the `@`.
+    public let outputParameters: [String: SQLDataType]
+}
+
+extension TDSConnection {
+
+    /// Call stored procedure `name` as an RPC.
+    ///
+    /// Parameters are sent typed rather than spliced into an `EXEC` string. Result
+    /// sets, the return status and output parameters all come back in the same
+    /// round-trip, so no follow-up `SELECT` is needed to read outputs.
+    public func callProcedure(
+        name: String,
+        parameters: [ProcedureParameter] = []
+    ) async throws -> ProcedureResult {
+        let encoding = textEncoding
+
+        return try await runBlocking { conn in
+            let sent = TDSConnection.withRPCParameters(parameters) { params in
+                executeProcedure(conn, name, params.baseAddress, Int32(params.count))
+            }
+            guard sent == 0 else {
+                dbcancel(conn)
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Procedure call failed")
+                )
+            }
+
+            var resultSets: [SQLResult] = []
+            while true {
+                var cRows: UnsafeMutablePointer<RowData>? = nil
+                var rowCount: Int32 = 0
+                let status = fetchNextResultSet(conn, &cRows, &rowCount)
+                if status < 0 {
+                    dbcancel(conn)
+                    throw TDSConnectionError.queryExecutionFailed(
+                        reason: TDSConnection.lastErrorMessage(conn, or: "Procedure call failed")
+                    )
+                }
+                if status == 0 { break }
+                defer { freeFetchedResults(cRows, rowCount) }
+                var resultSet = SQLResult(
+                    fetched: cRows,
+                    rowCount: Int(rowCount),
+                    affectedRows: Int(dbcount(conn)),
+                    encoding: encoding
+                )
+                resultSet.schema = ResultSchema.current(conn)
+                resultSets.append(resultSet)
+            }
+
+            var returnStatus: Int32 = 0
+            let hasReturnStatus = getReturnStatus(conn, &returnStatus) != 0
+
+            var outputs: [String: SQLDataType] = [:]
+            if let outputRow = fetchOutputParameters(conn) {
+                defer { freeFetchedResults(outputRow, 1) }
+                let row = outputRow.pointee
+                for j in 0..<Int(row.columnCount) {
+                    guard
+                        let key = row.name(at: j),
+                        let value = row.value(at: j, encoding: encoding)
+                    else { continue }
+                    outputs[key] = value
+                }
+            }
+
+            return ProcedureResult(
+                resultSets: resultSets,
+                returnStatus: hasReturnStatus ? Int(returnStatus) : nil,
+                outputParameters: outputs
+            )
+        }
+    }
+
+    /// Lay out `parameters` as C `TdsRpcParam`s whose names and values stay valid
+    /// for the duration of `body`.
+    static func withRPCParameters<T>(
+        _ parameters: [ProcedureParameter],
+        _ body: (UnsafeBufferPointer<TdsRpcParam>) throws -> T
+    ) rethrows -> T {
+        var allocations: [UnsafeMutableRawPointer] = []
+        defer { allocations.forEach { free($0) } }
+
+        let params = parameters.map { parameter -> TdsRpcParam in
+            let wire = parameter.wireValue
+            let name = strdup(parameter.name.hasPrefix("@") ? parameter.name : "@" + parameter.name)!
+            allocations.append(UnsafeMutableRawPointer(name))
+
+            var value: UnsafeRawPointer? = nil
+            if let bytes = wire.bytes {
+                let buffer = malloc(max(bytes.count, 1))!
+                bytes.withUnsafeBytes { raw in
+                    if let base = raw.baseAddress {
+                        buffer.copyMemory(from: base, byteCount: raw.count)
+                    }
+                }
+                allocations.append(buffer)
+                value = UnsafeRawPointer(buffer)
+            }
+
+            return TdsRpcParam(
+                name: UnsafePointer(name),
+                type: wire.type,
+                isOutput: parameter.isOutput ? 1 : 0,
+                maxLength: parameter.isOutput ? wire.maxLength : -1,
+                value: value,
+                length: Int32(wire.bytes?.count ?? 0)
+            )
+        }
+        return try params.withUnsafeBufferPointer { try body($0) }
+    }
+}
+
+extension ProcedureParameter {
+    /// DB-Library type code, bytes (`nil` for NULL) and output buffer size for `value`.
+    ///
+    /// Fixed-width numbers are sent natively. Decimals, GUIDs and temporal values are
+    /// sent as text and converted by the server to the declared parameter type, which
+    /// also decides the type of any output value that comes back. `nchar` and
+    /// `nvarchar` values are sent as `nvarchar`, which DB-Library converts from the
+    /// client charset to UCS-2, so characters outside the server codepage survive.
+    var wireValue: (type: Int32, bytes: [UInt8]?, maxLength: Int32) {
+        func fixed<T>(_ type: Int, _ v: T) -> (type: Int32, bytes: [UInt8]?, maxLength: Int32) {
+            (Int32(type), withUnsafeBytes(of: v) { Array($0) }, -1)
+        }
+        func text(_ s: String) -> (type: Int32, bytes: [UInt8]?, maxLength: Int32) {
+            (Int32(SYBVARCHAR), Array(s.utf8), 8000)
+        }
+        func unicode(_ s: String) -> (type: Int32, bytes: [UInt8]?, maxLength: Int32) {
+            (Int32(SYBNVARCHAR), Array(s.utf8), 8000)
+        }
+        func date(_ d: TDSDate) -> String {
+            String(format: "%04ld-%02ld-%02ld", d.year, d.month, d.day)
+        }
+
+        switch value {
+        case .null:
+            return (Int32(SYBVARCHAR), nil, 8000)
+        case .integer(let v):
+            return fixed(SYBINT8, Int64(v))
+        case .bigInt(let v):
+            return fixed(SYBINT8, v)
+        case .smallInt(let v):
+            return fixed(SYBINT2, v)
+        case .tinyInt(let v):
+            return fixed(SYBINT1, v)
+        case .bit(let v):
+            return fixed(SYBBIT, UInt8(v ? 1 : 0))
+        case .double(let v):
+            return fixed(SYBFLT8, v)
+        case .float(let v), .real(let v):
+            return fixed(SYBREAL, v)
+        case .char(let s), .varchar(let s), .text(let s):
+            return text(s)
+        case .nchar(let s), .nvarchar(let s):
+            return unicode(s)
+        case .binary(let d), .varbinary(let d):
+            return (Int32(SYBVARBINARY), Array(d), 8000)
+        case .decimal(let d), .numeric(let d), .money(let d):
+            return text(d.description)
+        case .uniqueidentifier(let u):
+            return text(u.uuidString)
+        case .spatial(let wkt):
+            return text(wkt.value)
+        case .date(let d):
+            return text(date(d))
+        case .time(let t):
+            return text(String(format: "%02ld:%02ld:%02ld", t.hour, t.minute, t.second))
+        case .datetime(let dt), .smalldatetime(let dt):
+            // datetime only accepts milliseconds; fractionalSecond is in 100ns ticks.
+            return text(
+                date(dt.date)
+                    + String(format: "T%02ld:%02ld:%02ld.%03ld", dt.hour, dt.minute, dt.second,
+                             dt.fractionalSecond / 10_000))
+        case .datetime2(let dt):
+            return text(
+                date(dt.date)
+                    + String(format: "T%02ld:%02ld:%02ld.%07ld", dt.hour, dt.minute, dt.second,
+                             dt.fractionalSecond))
+        case .datetimeoffset(let dto):
+            let sign = dto.offset < 0 ? "-" : "+"
+            return text(
+                date(dto.date)
+                    + String(format: "T%02ld:%02ld:%02ld.%07ld", dto.time.hour, dto.time.minute,
+                             dto.time.second, dto.fractionalSecond)
+                    + sign + String(format: "%02ld:%02ld", abs(dto.offset) / 60, abs(dto.offset) % 60))
+        }
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  TDSConnection+Session.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+extension TDSConnection {
+
+    /// Return the session to its state right after login, without logging in again.
+    ///
+    /// Temp tables are dropped, open transactions rolled back, `SET` options
+    /// restored and the configured database selected again, using the server's
+    /// `sp_reset_connection` procedure. Use this before handing a connection to
+    /// another tenant or request. If the server refuses the reset, open transactions
+    /// are still rolled back, but this throws because temp tables and `SET` options
+    /// may remain; close the connection rather than reuse it.
+    public func resetSession() async throws {
+        let database = login.database
+        try await runBlocking { conn in
+            guard CFreeTDS.resetSession(conn, database) == 0 else {
+                throw TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Session reset failed")
+                )
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+//
+//  TDSConnection+Statistics.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+
+/// Server-side work reported by `SET STATISTICS IO, TIME ON` for one query.
+public struct QueryStatistics: Sendable, Equatable {
+
+    /// Page reads against one table, from one `STATISTICS IO` message. A table read
+    /// by several statements appears once per statement.
+    public struct TableIO: Sendable, Equatable {
+        public var table: String
+        public var scanCount: Int
+        public var logicalReads: Int
+        public var physicalReads: Int
+        public var readAheadReads: Int
+        public var lobLogicalReads: Int
+        public var lobPhysicalReads: Int
+        public var lobReadAheadReads: Int
+        /// Every counter in the message keyed by its label, such as
+        /// `"page server reads"`, including those without a property above.
+        public var counters: [String: Int]
+    }
+
+    public var tables: [TableIO] = []
+    /// CPU time spent parsing and compiling, summed over the batch.
+    public var compileCPUTime: Duration = .zero
+    public var compileElapsedTime: Duration = .zero
+    /// CPU time spent executing, summed over the statements of the batch.
+    public var executionCPUTime: Duration = .zero
+    public var executionElapsedTime: Duration = .zero
+    /// Text of every informational message the query produced.
+    public var messages: [String] = []
+
+    /// Logical reads over all tables.
+    public var logicalReads: Int {
+        tables.reduce(0) { $0 + $1.logicalReads }
+    }
+
+    /// Physical and read-ahead reads over all tables.
+    public var physicalReads: Int {
+        tables.reduce(0) { $0 + $1.physicalReads + $1.readAheadReads }
+    }
+
+    /// Message numbers of the statistics output.
+    static let executionTimesMessage = 3612
+    static let compileTimeMessage = 3613
+    static let tableIOMessage = 3615
+
+    /// Parse statistics from `(number, text)` server messages. Messages are matched
+    /// by number; the counters are read from their text, which assumes an English
+    /// session language.
+    init(messages: [(number: Int, text: String)]) {
+        for (number, text) in messages {
+            self.messages.append(text)
+            switch number {
+            case Self.tableIOMessage:
+                if let io = TableIO(message: text) { tables.append(io) }
+            case Self.executionTimesMessage:
+                executionCPUTime += Self.milliseconds(after: "CPU time =", in: text)
+                executionElapsedTime += Self.milliseconds(after: "elapsed time =", in: text)
+            case Self.compileTimeMessage:
+                compileCPUTime += Self.milliseconds(after: "CPU time =", in: text)
+                compileElapsedTime += Self.milliseconds(after: "elapsed time =", in: text)
+            default:
+                break
+            }
+        }
+    }
+
+    private static func milliseconds(after label: String, in text: String) -> Duration {
+        guard let range = text.range(of: label) else { return .zero }
+        let digits = text[range.upperBound...].drop(while: { $0 == " " }).prefix(while: \.isNumber)
+        return .milliseconds(Int(digits) ?? 0)
+    }
+}
+
+extension QueryStatistics.TableIO {
+    /// Parse `Table 'Name'. Scan count 1, logical reads 3, physical reads 0, ...`.
+    init?(message: String) {
+        guard message.hasPrefix("Table '"),
+            let nameEnd = message.range(of: "'.", options: .backwards)
+        else { return nil }
+        table = String(message[message.index(message.startIndex, offsetBy: 7)..<nameEnd.lowerBound])
+
+        var counters: [String: Int] = [:]
+        for part in message[nameEnd.upperBound...].split(separator: ",") {
+            let words = part.trimmingCharacters(in: CharacterSet(charactersIn: " .\n")).split(separator: " ")
+            guard let last = words.last, let value = Int(last) else { continue }
+            counters[words.dropLast().joined(separator: " ").lowercased()] = value
+        }
+        self.counters = counters
+        scanCount = counters["scan count"] ?? 0
+        logicalReads = counters["logical reads"] ?? 0
+        physicalReads = counters["physical reads"] ?? 0
+        readAheadReads = counters["read-ahead reads"] ?? 0
+        lobLogicalReads = counters["lob logical reads"] ?? 0
+        lobPhysicalReads = counters["lob physical reads"] ?? 0
+        lobReadAheadReads = counters["lob read-ahead reads"] ?? 0
+    }
+}
+
+extension TDSConnection {
+
+    /// Execute `queryString` with `SET STATISTICS IO, TIME ON` and attach the
+    /// parsed reads and CPU/elapsed times to the result's `statistics`.
+    ///
+    /// The options are switched on in the same batch as the query and off again
+    /// with a separate command afterwards, so a profiled query costs one extra
+    /// round-trip. Without `collectStatistics` this is a plain `execute`.
+    public func execute(queryString: String, collectStatistics: Bool) async throws -> SQLResult {
+        guard collectStatistics else { return try await execute(queryString: queryString) }
+        let encoding = textEncoding
+        return try await runBlocking { conn in
+            setMessageCapture(conn, 1)
+            let outcome = Result {
+                try TDSConnection.fetchResult(
+                    conn,
+                    queryString: "SET STATISTICS IO, TIME ON\n" + queryString,
+                    encoding: encoding
+                )
+            }
+            let statistics = QueryStatistics(messages: TDSConnection.capturedMessages(conn))
+            setMessageCapture(conn, 0)
+            _ = try? TDSConnection.withFetchedRows(conn, queryString: "SET STATISTICS IO, TIME OFF") { _, _, _ in }
+
+            var result = try outcome.get()
+            result.statistics = statistics
+            return result
+        }
+    }
+
+    /// The informational messages captured on `conn` so far.
+    static func capturedMessages(_ conn: OpaquePointer) -> [(number: Int, text: String)] {
+        var length = 0
+        guard let base = CFreeTDS.capturedMessages(conn, &length), length > 0 else { return [] }
+        let bytes = UnsafeRawBufferPointer(start: base, count: length)
+        return bytes.split(separator: 0).compactMap { record in
+            guard let tab = record.firstIndex(of: UInt8(ascii: "\t")),
+                let number = Int(String(decoding: record[..<tab], as: UTF8.self))
+            else { return nil }
+            return (number, String(decoding: record[(tab + 1)...], as: UTF8.self))
+        }
+    }
+}
@@ -0,0 +1,330 @@
+//
+//  TDSConnection+Transaction.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Synchronization
+
+/// Transaction isolation levels accepted by `TDSConnection.withTransaction`.
+public enum TransactionIsolation: String, Sendable {
+    case readUncommitted = "READ UNCOMMITTED"
+    case readCommitted = "READ COMMITTED"
+    case repeatableRead = "REPEATABLE READ"
+    case serializable = "SERIALIZABLE"
+    case snapshot = "SNAPSHOT"
+
+    /// The level for a `transaction_isolation_level` value from
+    /// `sys.dm_exec_sessions`, or `nil` for 0 (unspecified).
+    init?(sessionLevel: Int) {
+        switch sessionLevel {
+        case 1: self = .readUncommitted
+        case 2: self = .readCommitted
+        case 3: self = .repeatableRead
+        case 4: self = .serializable
+        case 5: self = .snapshot
+        default: return nil
+        }
+    }
+}
+
+extension TDSConnection {
+
+    /// Run `body` in a transaction that commits when `body` returns and rolls back
+    /// when it throws.
+    ///
+    /// No round-trip is spent on `BEGIN TRANSACTION`: it is sent in the same batch
+    /// as the first statement. Ending `body` with `commit(after:)` sends the last
+    /// statement and `COMMIT` together too, so a one-statement transaction costs a
+    /// single round-trip. Other commands on this connection wait until the
+    /// transaction ends; do not start another transaction inside `body`.
+    ///
+    /// With `isolationLevel`, the session's current level is read first, at the
+    /// cost of one round-trip, and set back when the transaction ends.
+    public nonisolated func withTransaction<T>(
+        isolationLevel: TransactionIsolation? = nil,
+        isolation: isolated (any Actor)? = #isolation,
+        _ body: (TDSTransaction) async throws -> T
+    ) async throws -> T {
+        await beginCommand()
+        let transaction: TDSTransaction
+        do {
+            let session = try await liveConnection()
+            var restoredIsolation: TransactionIsolation? = nil
+            if isolationLevel != nil {
+                restoredIsolation = try await sessionIsolation(session)
+            }
+            transaction = TDSTransaction(
+                connection: self,
+                session: session,
+                isolationLevel: isolationLevel,
+                restoring: restoredIsolation
+            )
+        } catch {
+            await endCommand()
+            throw error
+        }
+
+        do {
+            let value = try await body(transaction)
+            try await transaction.commit()
+            await endCommand()
+            return value
+        } catch {
+            try? await transaction.rollback()
+            await endCommand()
+            throw error
+        }
+    }
+
+    /// The isolation level `session` runs at outside a transaction. The caller must
+    /// hold the command queue.
+    nonisolated func sessionIsolation(_ session: Int) async throws -> TransactionIsolation {
+        let encoding = textEncoding
+        let result = try await runOnSession(session) { conn in
+            try TDSConnection.fetchResult(
+                conn,
+                queryString: """
+                    SELECT CAST(transaction_isolation_level AS INT) AS Level
+                    FROM sys.dm_exec_sessions WHERE session_id = @@SPID
+                    """,
+                encoding: encoding
+            )
+        }
+        return result[0, "Level"]?.int.flatMap(TransactionIsolation.init(sessionLevel:)) ?? .readCommitted
+    }
+}
+
+/// An open transaction, handed to the body of `TDSConnection.withTransaction`.
+///
+/// Statements run in order; do not call into a transaction from several tasks at
+/// once. `BEGIN TRANSACTION`, savepoints and rollbacks to a savepoint are queued
+/// and sent in front of the next statement, so they cost no round-trip of their
+/// own. An error from a queued command is reported by that next statement.
+///
+/// A first statement that fails to compile takes `BEGIN TRANSACTION` down with
+/// it; the transaction then begins with the next statement instead. If the server
+/// rolls the transaction back on its own, for example under `XACT_ABORT`, later
+/// statements throw rather than run outside it.
+public final class TDSTransaction: Sendable {
+    /// Isolation level the transaction was started with, or `nil` for the
+    /// session's current level.
+    public let isolationLevel: TransactionIsolation?
+    /// Level the session is set back to when the transaction ends, if
+    /// `isolationLevel` changed it.
+    private let restoredIsolation: TransactionIsolation?
+
+    private let connection: TDSConnection
+    private let session: Int
+    private let state: Mutex<State>
+
+    private struct State {
+        var pending: [String]
+        var began = false
+        var isFinished = false
+        /// Set when the server ended the transaction after a failed statement.
+        var isAborted = false
+    }
+
+    init(
+        connection: TDSConnection,
+        session: Int,
+        isolationLevel: TransactionIsolation?,
+        restoring restoredIsolation: TransactionIsolation? = nil
+    ) {
+        self.connection = connection
+        self.session = session
+        self.isolationLevel = isolationLevel
+        self.restoredIsolation = isolationLevel == nil ? nil : restoredIsolation ?? .readCommitted
+        var begin: [String] = []
+        if let isolationLevel {
+            begin.append("SET TRANSACTION ISOLATION LEVEL \(isolationLevel.rawValue)")
+        }
+        begin.append("BEGIN TRANSACTION")
+        self.state = Mutex(State(pending: begin))
+    }
+
+    /// Whether the transaction has been committed or rolled back.
+    public var isFinished: Bool {
+        state.withLock { $0.isFinished }
+    }
+
+    /// Run `queryString` inside the transaction.
+    public func execute(queryString: String) async throws -> SQLResult {
+        let queued = try dequeue()
+        do {
+            return try await send((queued.commands + [queryString]).joined(separator: ";\n"))
+        } catch {
+            await recover(from: queued)
+            throw error
+        }
+    }
+
+    /// Run `queryString` and commit in the same round-trip. If the statement fails,
+    /// the transaction is rolled back on the server and the error is thrown.
+    /// `affectedRows` of the result reflects the batch as a whole.
+    @discardableResult
+    public func commit(after queryString: String) async throws -> SQLResult {
+        let statement = """
+            BEGIN TRY
+            \(queryString)
+            ;COMMIT TRANSACTION;
+            END TRY
+            BEGIN CATCH
+            IF @@TRANCOUNT > 0 ROLLBACK TRANSACTION;
+            \(restoreIsolation)THROW;
+            END CATCH;
+            \(restoreIsolation)
+            """
+        let result = try await send(try batch(ending: statement))
+        state.withLock { $0.isFinished = true }
+        return result
+    }
+
+    /// Commit now. A transaction that has not sent a statement yet ends without
+    /// contacting the server.
+    public func commit() async throws {
+        if state.withLock({ $0.isAborted && !$0.isFinished }) { throw Self.abortedError }
+        guard let batch = finishingBatch("COMMIT TRANSACTION", keepingQueued: true) else { return }
+        _ = try await send(batch)
+        state.withLock { $0.isFinished = true }
+    }
+
+    /// Roll back now. A transaction that has not sent a statement yet ends without
+    /// contacting the server.
+    public func rollback() async throws {
+        // Also marks the transaction finished: a failed rollback is not retried.
+        guard let batch = finishingBatch("IF @@TRANCOUNT > 0 ROLLBACK TRANSACTION", always: true)
+        else { return }
+        _ = try await send(batch)
+    }
+
+    /// Mark a savepoint that `rollback(to:)` can return to.
+    public func savepoint(_ name: String) throws {
+        try enqueue("SAVE TRANSACTION \(Self.quote(name))")
+    }
+
+    /// Undo everything since savepoint `name`, keeping the transaction open.
+    public func rollback(to name: String) throws {
+        try enqueue("ROLLBACK TRANSACTION \(Self.quote(name))")
+    }
+
+    /// Run `body` after savepoint `name`, rolling back to it if `body` throws. The
+    /// error is rethrown and the transaction stays open.
+    public func withSavepoint<T>(
+        _ name: String,
+        isolation: isolated (any Actor)? = #isolation,
+        _ body: () async throws -> T
+    ) async throws -> T {
+        try savepoint(name)
+        do {
+            return try await body()
+        } catch {
+            try rollback(to: name)
+            throw error
+        }
+    }
+
+    // MARK: - Batches
+
+    private var restoreIsolation: String {
+        restoredIsolation.map { "SET TRANSACTION ISOLATION LEVEL \($0.rawValue);\n" } ?? ""
+    }
+
+    private func enqueue(_ command: String) throws {
+        try state.withLock { state in
+            guard !state.isFinished else { throw Self.finishedError }
+            state.pending.append(command)
+        }
+    }
+
+    /// Commands taken off the queue for one batch.
+    private struct Queued {
+        var commands: [String]
+        /// Whether the batch carries `BEGIN TRANSACTION`.
+        var begins: Bool
+    }
+
+    private func dequeue() throws -> Queued {
+        try state.withLock { state in
+            guard !state.isFinished else { throw Self.finishedError }
+            guard !state.isAborted else { throw Self.abortedError }
+            let queued = Queued(commands: state.pending, begins: !state.began)
+            state.pending.removeAll()
+            state.began = true
+            return queued
+        }
+    }
+
+    /// The queued commands followed by `statement`.
+    private func batch(ending statement: String) throws -> String {
+        try (dequeue().commands + [statement]).joined(separator: ";\n")
+    }
+
+    /// After a batch failed, ask the server whether the transaction is still open.
+    /// A batch that failed to compile never ran, so when it carried `BEGIN
+    /// TRANSACTION` its commands go back to the front of the queue. A transaction
+    /// that was open before and is gone now was rolled back by the server.
+    private func recover(from queued: Queued) async {
+        guard
+            let result = try? await send("SELECT @@TRANCOUNT AS Depth"),
+            result[0, "Depth"]?.int == 0
+        else {
+            return
+        }
+        state.withLock { state in
+            if queued.begins {
+                state.pending = queued.commands + state.pending
+                state.began = false
+            } else {
+                state.isAborted = true
+            }
+        }
+    }
+
+    /// The batch that ends the transaction with `command`, or `nil` if nothing was
+    /// ever sent to the server. With `keepingQueued`, commands queued since the
+    /// last statement run first, so a pending rollback to a savepoint still
+    /// happens before a commit.
+    private func finishingBatch(
+        _ command: String,
+        always: Bool = false,
+        keepingQueued: Bool = false
+    ) -> String? {
+        state.withLock { state -> String? in
+            guard !state.isFinished else { return nil }
+            if always { state.isFinished = true }
+            guard state.began else {
+                state.isFinished = true
+                return nil
+            }
+            var queued = keepingQueued ? state.pending : []
+            state.pending.removeAll()
+            // A savepoint with no statement after it changes nothing.
+            while queued.last?.hasPrefix("SAVE TRANSACTION ") == true {
+                queued.removeLast()
+            }
+            return (queued + [command]).joined(separator: ";\n") + ";\n" + restoreIsolation
+        }
+    }
+
+    private func send(_ batch: String) async throws -> SQLResult {
+        let encoding = connection.textEncoding
+        return try await connection.runOnSession(session) { conn in
+            try TDSConnection.fetchResult(conn, queryString: batch, encoding: encoding)
+        }
+    }
+
+    private static var finishedError: TDSConnectionError {
+        .queryExecutionFailed(reason: "Transaction already finished")
+    }
+
+    private static var abortedError: TDSConnectionError {
+        .queryExecutionFailed(reason: "Transaction was rolled back by the server")
+    }
+
+    /// Bracket-quote a savepoint name.
+    static func quote(_ name: String) -> String {
+        "[" + name.replacingOccurrences(of: "]", with: "]]") + "]"
+    }
+}
@@ -25,6 +25,21 @@ public struct ConnectionConfiguration: Sendable {
     public var database: String
     /// Connection timeout in seconds.
     public var timeout: Int
+    /// Client charset requested at login (e.g. `"UTF-8"`, `"ISO-8859-1"`).
+    /// `nil` keeps the charset configured in `freetds.conf`.
+    public var charset: String?
+    /// Thread pool that runs this connection's blocking DB-Library calls.
+    public var executor: TDSBlockingExecutor
+    /// Rows a streaming query may fetch ahead of its consumer before it pauses.
+    public var streamBufferSize: Int
+    /// How often an idle connection checks that its session is still alive.
+    /// `nil` disables the check.
+    public var keepaliveInterval: Duration?
+    /// How a dropped session is reopened. `nil` leaves a dead connection dead.
+    public var reconnectPolicy: ReconnectPolicy?
+    /// Keep a second, logged-in session ready to replace the active one when it
+    /// dies. Only used together with `reconnectPolicy`.
+    public var keepsStandbyConnection: Bool
 
     /// Create an empty default configuration.
     public init() {
@@ -34,6 +49,12 @@ public struct ConnectionConfiguration: Sendable {
         self.password = ""
         self.database = ""
         self.timeout = 5
+        self.charset = "UTF-8"
+        self.executor = .shared
+        self.streamBufferSize = 256
+        self.keepaliveInterval = nil
+        self.reconnectPolicy = nil
+        self.keepsStandbyConnection = false
     }
 
     /// Create a configuration with host, port, credentials, and database name.
@@ -43,7 +64,13 @@ public struct ConnectionConfiguration: Sendable {
         username: String,
         password: String,
         database: String,
-        timeout: Int = 5
+        timeout: Int = 5,
+        charset: String? = "UTF-8",
+        executor: TDSBlockingExecutor = .shared,
+        streamBufferSize: Int = 256,
+        keepaliveInterval: Duration? = nil,
+        reconnectPolicy: ReconnectPolicy? = nil,
+        keepsStandbyConnection: Bool = false
     ) {
         self.host = host
         self.port = port
@@ -51,14 +78,61 @@ public struct ConnectionConfiguration: Sendable {
         self.password = password
         self.database = database
         self.timeout = timeout
+        self.charset = charset
+        self.executor = executor
+        self.streamBufferSize = streamBufferSize
+        self.keepaliveInterval = keepaliveInterval
+        self.reconnectPolicy = reconnectPolicy
+        self.keepsStandbyConnection = keepsStandbyConnection
     }
 }
 
 public actor TDSConnection {
-    private var connection: OpaquePointer?
+    private var connection: OpaquePointer? {
+        didSet {
+            if let connection { attachMessageRing(to: connection) }
+        }
+    }
+    private var isClosed = false
+
+    /// Login parameters, kept to reopen the session after it drops.
+    nonisolated let login: Login
+
+    // Commands run one at a time; later ones queue here in arrival order.
+    private var isBusy = false
+    private var commandWaiters: [CheckedContinuation<Void, Never>] = []
+    private var lastActivity = ContinuousClock.now
+
+    private var standby: OpaquePointer?
+    private var isOpeningStandby = false
+    private var isProbingStandby = false
+    private var keepaliveTask: Task<Void, Never>?
+
+    /// Client charset negotiated at login, as reported by DB-Library.
+    public nonisolated let clientCharset: String?
+
+    /// Encoding used to build Swift strings from fetched text. UTF-8 is decoded
+    /// directly; other charsets go through Foundation's transcoder.
+    nonisolated let textEncoding: String.Encoding
+
+    /// Thread pool that runs blocking DB-Library calls for this connection, keeping
+    /// them off the cooperative pool.
+    public nonisolated let executor: TDSBlockingExecutor
+
+    /// Default number of rows a streaming query fetches ahead of its consumer.
+    public nonisolated let streamBufferSize: Int
+
+    /// How a dropped session is reopened, or `nil` to leave it dead.
+    public nonisolated let reconnectPolicy: ReconnectPolicy?
+
+    /// Whether a standby session is kept ready to replace a dead one.
+    public nonisolated let keepsStandbyConnection: Bool
+
+    /// Feeds `serverMessages()` from every session this connection uses.
+    nonisolated let messageRing = ServerMessageRing()
 
     /// Actor-isolated raw pointer bit-pattern for send across tasks.
-    private var rawConnection: Int? {
+    var rawConnection: Int? {
         guard let conn = connection else { return nil }
         return Int(bitPattern: conn)
     }
@@ -70,7 +144,13 @@ public actor TDSConnection {
             username: configuration.username,
             password: configuration.password,
             database: configuration.database,
-            timeout: configuration.timeout
+            timeout: configuration.timeout,
+            charset: configuration.charset,
+            executor: configuration.executor,
+            streamBufferSize: configuration.streamBufferSize,
+            keepaliveInterval: configuration.keepaliveInterval,
+            reconnectPolicy: configuration.reconnectPolicy,
+            keepsStandbyConnection: configuration.keepsStandbyConnection
         )
     }
 
@@ -80,102 +160,144 @@ public actor TDSConnection {
         username: String,
         password: String,
         database: String,
-        timeout: Int = 5
+        timeout: Int = 5,
+        charset: String? = "UTF-8",
+        executor: TDSBlockingExecutor = .shared,
+        streamBufferSize: Int = 256,
+        keepaliveInterval: Duration? = nil,
+        reconnectPolicy: ReconnectPolicy? = nil,
+        keepsStandbyConnection: Bool = false
     ) throws {
-        let dbInit = initializeDBLibrary()
-        if dbInit != 0 {
-            let msg =
-                getLastTdsErrorMessage().map { String(cString: $0) }
-                ?? "DB init failed"
-            throw TDSConnectionError.connectionFailed(reason: msg)
-        }
-        self.connection = connectToDatabase(
-            server,
-            username,
-            password,
-            database,
-            Int32(timeout)
+        let login = Login(
+            server: server,
+            username: username,
+            password: password,
+            database: database,
+            timeout: timeout,
+            charset: charset
         )
-        if self.connection == nil {
-            let msg =
-                getLastTdsErrorMessage().map { String(cString: $0) }
-                ?? "Connection failed"
-            throw TDSConnectionError.connectionFailed(reason: msg)
+        let connection = try TDSConnection.open(login)
+        self.connection = connection
+        self.login = login
+        self.executor = executor
+        self.streamBufferSize = max(1, streamBufferSize)
+        self.reconnectPolicy = reconnectPolicy
+        self.keepsStandbyConnection = keepsStandbyConnection && reconnectPolicy != nil
+        let negotiated = dbgetcharset(connection).map { String(cString: $0) }
+        self.clientCharset = negotiated
+        self.textEncoding = String.Encoding(tdsCharset: negotiated)
+        attachMessageRing(to: connection)
+
+        if keepaliveInterval != nil || self.keepsStandbyConnection {
+            Task { await self.startMaintenance(keepaliveInterval: keepaliveInterval) }
         }
     }
 
     public func execute(queryString: String) async throws -> SQLResult {
-        guard let connection = connection else {
-            throw TDSConnectionError.notConnected
+        let encoding = textEncoding
+        return try await runBlocking { conn in
+            try TDSConnection.fetchResult(conn, queryString: queryString, encoding: encoding)
         }
+    }
 
-        let connRaw = Int(bitPattern: connection)
-
-        return try await Task.detached(priority: .userInitiated) {
-            let conn = OpaquePointer(bitPattern: connRaw)!
-            let success = executeQuery(conn, queryString)
-            if success != 0 {
-                throw TDSConnectionError.queryExecutionFailed(
-                    reason: getLastTdsErrorMessage().map { String(cString: $0) }
-                        ?? ""
-                )
-            }
+    /// Execute `queryString`, serving repeated calls from `cache` until the entry
+    /// expires or is invalidated. Only successful results are cached. Entries are
+    /// kept apart per server and database, so a cache can be shared by
+    /// connections to different ones.
+    public func execute(
+        queryString: String,
+        cache: SQLResultCache,
+        ttl: Duration? = nil,
+        tags: Set<String> = []
+    ) async throws -> SQLResult {
+        let key = SQLResultCache.Key(sql: queryString, scope: "\(login.server)/\(login.database)")
+        if let cached = cache.value(forKey: key) {
+            return cached
+        }
+        let result = try await execute(queryString: queryString)
+        cache.insert(result, forKey: key, ttl: ttl, tags: tags)
+        return result
+    }
 
-            var rowCount: Int32 = 0
-            guard let cRows = fetchResultsWithType(conn, &rowCount) else {
-                throw TDSConnectionError.queryExecutionFailed(
-                    reason: getLastTdsErrorMessage().map { String(cString: $0) }
-                        ?? ""
-                )
-            }
-            defer { freeFetchedResults(cRows, rowCount) }
+    /// The most recent server or DB-Library error text the C wrapper captured on
+    /// `conn`, or `fallback` when there is none.
+    static func lastErrorMessage(_ conn: OpaquePointer, or fallback: String = "") -> String {
+        let message = getConnectionErrorMessage(conn).map { String(cString: $0) } ?? ""
+        return message.isEmpty ? fallback : message
+    }
 
-            var results: [[String: SQLDataType]] = []
-            var columnNames: [String] = []
+    /// Run `operation` with the DB-Library handle on `executor`, after any command
+    /// already running on this connection. Cancelling the calling task cancels the
+    /// in-flight command and throws `CancellationError`.
+    func runBlocking<T: Sendable>(
+        _ operation: @escaping @Sendable (OpaquePointer) throws -> T
+    ) async throws -> T {
+        await beginCommand()
+        defer { endCommand() }
+        let connRaw = try await liveConnection()
+        return try await runOnSession(connRaw, operation)
+    }
 
-            if rowCount > 0 {
-                let firstRow = cRows[0]
-                for j in 0..<Int(firstRow.columnCount) {
-                    if let colName = firstRow.columnNames?[j] {
-                        columnNames.append(String(cString: colName))
-                    }
-                }
+    /// Run `operation` on the handle `connRaw` without queueing behind other
+    /// commands. The caller must already hold the command queue.
+    nonisolated func runOnSession<T: Sendable>(
+        _ connRaw: Int,
+        _ operation: @escaping @Sendable (OpaquePointer) throws -> T
+    ) async throws -> T {
+        clearCancelRequest(OpaquePointer(bitPattern: connRaw)!)
+        do {
+            return try await withTaskCancellationHandler {
+                try await Task.detached(executorPreference: executor, priority: .userInitiated) {
+                    try operation(OpaquePointer(bitPattern: connRaw)!)
+                }.value
+            } onCancel: {
+                requestCancel(OpaquePointer(bitPattern: connRaw)!)
             }
+        } catch {
+            if Task.isCancelled { throw CancellationError() }
+            throw error
+        }
+    }
 
-            for i in 0..<Int(rowCount) {
-                let row = cRows[i]
-                if columnNames.isEmpty {
-                    for j in 0..<Int(row.columnCount) {
-                        if let cName = row.columnNames?[j] {
-                            columnNames.append(String(cString: cName))
-                        }
-                    }
-                }
+    /// Run `queryString` on `conn` and collect every row it returns.
+    static func fetchResult(
+        _ conn: OpaquePointer,
+        queryString: String,
+        encoding: String.Encoding
+    ) throws -> SQLResult {
+        try withFetchedRows(conn, queryString: queryString) { conn, cRows, rowCount in
+            var result = SQLResult(
+                fetched: cRows,
+                rowCount: rowCount,
+                affectedRows: Int(dbcount(conn)),
+                encoding: encoding
+            )
+            if rowCount > 0 { result.schema = ResultSchema.current(conn) }
+            return result
+        }
+    }
 
-                var dict: [String: SQLDataType] = [:]
-                for j in 0..<Int(row.columnCount) {
-                    guard
-                        let namePtr = row.columnNames?[j],
-                        let valPtr = row.columnValues?[j]
-                    else { continue }
-
-                    let key = String(cString: namePtr)
-                    let value = determineSQLType(
-                        valPtr,
-                        columnType: Int(row.columnTypes?[j] ?? 0)
-                    )
-                    dict[key] = value
-                }
-                results.append(dict)
-            }
+    /// Run `queryString` on the DB-Library handle `conn` and pass the fetched C rows
+    /// to `body`. The rows are freed when `body` returns.
+    static func withFetchedRows<T>(
+        _ conn: OpaquePointer,
+        queryString: String,
+        _ body: (OpaquePointer, UnsafeMutablePointer<RowData>, Int) throws -> T
+    ) throws -> T {
+        if executeQuery(conn, queryString) != 0 {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: lastErrorMessage(conn)
+            )
+        }
 
-            let affectedRows = Int(dbcount(conn))
-            return SQLResult(
-                columns: columnNames,
-                rows: results,
-                affectedRows: affectedRows
+        var rowCount: Int32 = 0
+        guard let cRows = fetchResultsWithType(conn, &rowCount) else {
+            throw TDSConnectionError.queryExecutionFailed(
+                reason: lastErrorMessage(conn)
             )
-        }.value
+        }
+        defer { freeFetchedResults(cRows, rowCount) }
+        return try body(conn, cRows, Int(rowCount))
     }
 
     @available(*, deprecated, renamed: "close()")
@@ -184,161 +306,491 @@ public actor TDSConnection {
     }
 
     /// Close the database connection.
+    ///
+    /// A command still running (a streaming query, a buffered result or a keepalive
+    /// ping) may be using the session on another thread, so it is asked to cancel
+    /// and the session is freed when it ends. Commands queued behind it fail with
+    /// `TDSConnectionError.notConnected`.
     public func close() {
-        if let connection = connection {
-            closeConnection(connection)
+        guard !isClosed else { return }
+        isClosed = true
+        messageRing.finish()
+        keepaliveTask?.cancel()
+        keepaliveTask = nil
+        if let standby, !isProbingStandby {
+            closeConnection(standby)
+            self.standby = nil
+        }
+        if isBusy {
+            if let connection { requestCancel(connection) }
+        } else {
+            releaseSession()
+        }
+    }
+
+    /// Free the session handle. Only call while no command is running.
+    private func releaseSession() {
+        if let connection {
             self.connection = nil
+            closeConnection(connection)
         }
     }
 
     /// Execute the given SQL query and return an async sequence of row dictionaries.
-    /// Rows are yielded one by one as they are mapped, and the sequence finishes
-    /// when all rows have been produced or if an error occurs. Cancellation is supported.
-    public nonisolated func query(query: String) -> AsyncThrowingStream<
-        [String: SQLDataType], Error
-    > {
-        AsyncThrowingStream { continuation in
-            Task.detached(priority: .userInitiated) {
-                defer { continuation.finish() }
-
-                let maybeRaw = await self.rawConnection
-                guard let connRaw = maybeRaw else {
-                    continuation.finish(
-                        throwing: TDSConnectionError.notConnected
-                    )
-                    return
-                }
-                let conn = OpaquePointer(bitPattern: connRaw)!
-                guard executeQuery(conn, query) == 0 else {
-                    let msg =
-                        getLastTdsErrorMessage().map { String(cString: $0) }
-                        ?? "Query failed"
-                    continuation.finish(
-                        throwing: TDSConnectionError.queryExecutionFailed(
-                            reason: msg
-                        )
-                    )
-                    return
-                }
-
-                var rowCount: Int32 = 0
-                guard let cRows = fetchResultsWithType(conn, &rowCount) else {
-                    let msg =
-                        getLastTdsErrorMessage().map { String(cString: $0) }
-                        ?? "Query failed"
-                    continuation.finish(
-                        throwing: TDSConnectionError.queryExecutionFailed(
-                            reason: msg
-                        )
-                    )
-                    return
-                }
-                defer { freeFetchedResults(cRows, rowCount) }
-
-                var columnNames: [String] = []
-                if rowCount > 0 {
-                    let firstRow = cRows[0]
-                    for j in 0..<Int(firstRow.columnCount) {
-                        if let cName = firstRow.columnNames?[j] {
-                            columnNames.append(String(cString: cName))
-                        }
-                    }
-                }
-
-                for i in 0..<Int(rowCount) {
-                    if Task.isCancelled { break }
-                    let row = cRows[i]
-                    if columnNames.isEmpty {
-                        for j in 0..<Int(row.columnCount) {
-                            if let cName = row.columnNames?[j] {
-                                columnNames.append(String(cString: cName))
-                            }
-                        }
-                    }
-
-                    var dict: [String: SQLDataType] = [:]
-                    for j in 0..<Int(row.columnCount) {
-                        guard
-                            let namePtr = row.columnNames?[j],
-                            let valPtr = row.columnValues?[j]
-                        else { continue }
-
-                        let key = String(cString: namePtr)
-                        let value = determineSQLType(
-                            valPtr,
-                            columnType: Int(row.columnTypes?[j] ?? 0)
-                        )
-                        dict[key] = value
-                    }
-                    continuation.yield(dict)
-                }
-            }
-        }
+    ///
+    /// Rows are fetched one at a time on `executor`, at most `bufferSize` (default
+    /// `streamBufferSize`) ahead of the consumer. When the buffer is full, fetching
+    /// pauses until the consumer catches up, so memory is bounded by the buffer
+    /// rather than the result size. Cancelling the consuming task, or dropping the
+    /// sequence before the end, cancels the query. The connection stays busy with
+    /// this query until the sequence ends: other commands on it wait, so do not
+    /// issue them from inside the loop.
+    public nonisolated func query(
+        query: String,
+        bufferSize: Int? = nil
+    ) -> AsyncThrowingStream<[String: SQLDataType], Error> {
+        rowStream(query, bufferSize: bufferSize) { $0 }
     }
 
     /// Alias for `query(query:)` to emphasize streaming semantics.
-    public nonisolated func streamingQuery(queryString: String) -> AsyncThrowingStream<
-        [String: SQLDataType], Error
-    > {
-        query(query: queryString)
+    public nonisolated func streamingQuery(
+        queryString: String,
+        bufferSize: Int? = nil
+    ) -> AsyncThrowingStream<[String: SQLDataType], Error> {
+        query(query: queryString, bufferSize: bufferSize)
     }
 
     /// Stream rows through a mapping closure that transforms each raw row dictionary into `T`.
+    /// `map` runs on the fetching thread, so only mapped values are buffered.
     public nonisolated func query<T: Sendable>(
         queryString: String,
+        bufferSize: Int? = nil,
         map: @Sendable @escaping ([String: SQLDataType]) throws -> T
     )
         -> AsyncThrowingStream<T, Error>
     {
-        let base = query(query: queryString)
-        return AsyncThrowingStream<T, Error> { continuation in
-            Task.detached(priority: .userInitiated) {
-                defer { continuation.finish() }
-                do {
-                    for try await row in base {
-                        if Task.isCancelled { break }
-                        let mapped = try map(row)
-                        continuation.yield(mapped)
-                    }
-                } catch {
-                    continuation.finish(throwing: error)
-                }
-            }
-        }
+        rowStream(queryString, bufferSize: bufferSize, transform: map)
     }
 
     /// Stream rows directly into `Decodable` models. Column names must match model properties.
     public nonisolated func query<T: Decodable & Sendable>(
         queryString: String,
-        as type: T.Type
+        as type: T.Type,
+        bufferSize: Int? = nil
     )
         -> AsyncThrowingStream<T, Error>
     {
-        let base = query(query: queryString)
-        return AsyncThrowingStream<T, Error> { continuation in
-            Task.detached(priority: .userInitiated) {
-                defer { continuation.finish() }
-                let decoder = JSONDecoder()
-                for try await row in base {
-                    if Task.isCancelled { break }
-                    do {
-                        let jsonDict = row.reduce(into: [String: Any]()) {
-                            acc,
-                            kv in
-                            acc[kv.key] = kv.value.jsonValue
-                        }
-                        let data = try JSONSerialization.data(
-                            withJSONObject: jsonDict,
-                            options: []
-                        )
-                        let model = try decoder.decode(T.self, from: data)
-                        continuation.yield(model)
-                    } catch {
-                        continuation.finish(throwing: error)
-                        return
-                    }
+        rowStream(queryString, bufferSize: bufferSize) { row in
+            let jsonDict = row.reduce(into: [String: Any]()) { acc, kv in
+                acc[kv.key] = kv.value.jsonValue
+            }
+            let data = try JSONSerialization.data(withJSONObject: jsonDict, options: [])
+            return try JSONDecoder().decode(T.self, from: data)
+        }
+    }
+
+    /// Run `queryString` and feed its rows, passed through `transform`, into a
+    /// bounded buffer. The producer suspends between `dbnextrow` calls while the
+    /// buffer is full. A throwing `transform` cancels the query and ends the stream
+    /// with its error.
+    nonisolated func rowStream<T: Sendable>(
+        _ queryString: String,
+        bufferSize: Int?,
+        transform: @escaping @Sendable ([String: SQLDataType]) throws -> T
+    ) -> AsyncThrowingStream<T, Error> {
+        let buffer = BoundedStreamBuffer<T>(capacity: max(1, bufferSize ?? streamBufferSize))
+        let encoding = textEncoding
+
+        Task.detached(executorPreference: executor, priority: .userInitiated) {
+            await self.beginCommand()
+            do {
+                let connRaw = try await self.liveConnection()
+                await TDSConnection.produceRows(
+                    OpaquePointer(bitPattern: connRaw)!,
+                    queryString: queryString,
+                    encoding: encoding,
+                    into: buffer,
+                    transform: transform
+                )
+            } catch {
+                buffer.finish(throwing: error)
+            }
+            await self.endCommand()
+        }
+
+        return buffer.stream
+    }
+
+    private static func produceRows<T: Sendable>(
+        _ conn: OpaquePointer,
+        queryString: String,
+        encoding: String.Encoding,
+        into buffer: BoundedStreamBuffer<T>,
+        transform: @Sendable ([String: SQLDataType]) throws -> T
+    ) async {
+        let connRaw = Int(bitPattern: conn)
+        clearCancelRequest(conn)
+        buffer.onCancel {
+            requestCancel(OpaquePointer(bitPattern: connRaw)!)
+        }
+        guard executeQuery(conn, queryString) == 0 else {
+            buffer.finish(
+                throwing: TDSConnectionError.queryExecutionFailed(
+                    reason: TDSConnection.lastErrorMessage(conn, or: "Query failed")
+                )
+            )
+            return
+        }
+
+        // Rows arrive without names; take them from the schema of each result set.
+        var names: [String] = []
+        var resultSet = 0
+        var row = RowData()
+        while true {
+            let status = fetchNextRow(conn, &row)
+            if status == 0 {
+                buffer.finish()
+                return
+            }
+            if status < 0 {
+                // Also reached when the consumer cancelled; the stream has
+                // already ended then and the error goes unseen.
+                buffer.finish(
+                    throwing: TDSConnectionError.queryExecutionFailed(
+                        reason: TDSConnection.lastErrorMessage(conn, or: "Query failed")
+                    )
+                )
+                return
+            }
+
+            if Int(resultSetOrdinal(conn)) != resultSet {
+                resultSet = Int(resultSetOrdinal(conn))
+                names = ResultSchema.current(conn)?.names ?? []
+            }
+
+            let element: T
+            do {
+                defer { freeRowContents(&row) }
+                element = try transform(row.dictionary(names: names, encoding: encoding))
+            } catch {
+                dbcancel(conn)
+                buffer.finish(throwing: error)
+                return
+            }
+            guard await buffer.send(element) else {
+                // The consumer went away; discard the rest of the results.
+                dbcancel(conn)
+                return
+            }
+        }
+    }
+}
+
+// MARK: - Command queue, keepalive and reconnect
+
+extension TDSConnection {
+    /// Parameters needed to log in again.
+    struct Login: Sendable {
+        var server: String
+        var username: String
+        var password: String
+        var database: String
+        var timeout: Int
+        var charset: String?
+    }
+
+    /// Log in and return the DB-Library handle. Blocks for up to the login timeout.
+    static func open(_ login: Login) throws -> OpaquePointer {
+        let dbInit = initializeDBLibrary()
+        if dbInit != 0 {
+            let msg =
+                getLastTdsErrorMessage().map { String(cString: $0) }
+                ?? "DB init failed"
+            throw TDSConnectionError.connectionFailed(reason: msg)
+        }
+        guard
+            let connection = connectToDatabase(
+                login.server,
+                login.username,
+                login.password,
+                login.database,
+                Int32(login.timeout),
+                login.charset
+            )
+        else {
+            let msg =
+                getLastTdsErrorMessage().map { String(cString: $0) }
+                ?? "Connection failed"
+            throw TDSConnectionError.connectionFailed(reason: msg)
+        }
+        return connection
+    }
+
+    /// Whether the session has failed. DB-Library only notices when I/O on the
+    /// session fails, so a dropped idle session reads as alive until the next
+    /// command or `ping()`. A closed connection is not dead.
+    public var isDead: Bool {
+        guard let connection else { return false }
+        return isConnectionDead(connection) != 0
+    }
+
+    /// Send a trivial batch to check the session. Returns `false` if it failed; the
+    /// session is then reopened in the background when a `reconnectPolicy` is set,
+    /// so the next command does not pay for the failure.
+    @discardableResult
+    public func ping() async -> Bool {
+        do {
+            _ = try await execute(queryString: "SELECT 1")
+            return true
+        } catch {
+            if reconnectPolicy != nil, isDead {
+                Task { try? await self.reconnect() }
+            }
+            return false
+        }
+    }
+
+    /// Execute a query that is safe to run more than once. If it fails because the
+    /// session died, the session is reopened and the query retried. Logins and
+    /// sends share the `maxAttempts` of `reconnectPolicy`, with its backoff before
+    /// each retry, so a server that stays down costs at most `maxAttempts` logins.
+    /// Without a policy, or with `idempotent: false`, this is
+    /// `execute(queryString:)`.
+    public func execute(queryString: String, idempotent: Bool) async throws -> SQLResult {
+        guard idempotent, let policy = reconnectPolicy else {
+            return try await execute(queryString: queryString)
+        }
+        let encoding = textEncoding
+        await beginCommand()
+        defer { endCommand() }
+        var attempt = 0
+        while true {
+            do {
+                guard !isClosed else { throw TDSConnectionError.notConnected }
+                if connection == nil || isDead {
+                    try await reopen(attempts: attempt..<attempt + 1)
+                }
+                guard let connRaw = rawConnection else { throw TDSConnectionError.notConnected }
+                return try await runOnSession(connRaw) { conn in
+                    try TDSConnection.fetchResult(conn, queryString: queryString, encoding: encoding)
                 }
+            } catch {
+                attempt += 1
+                let lostSession = connection == nil || isDead
+                guard !(error is CancellationError), !isClosed, lostSession, attempt < policy.maxAttempts
+                else {
+                    throw error
+                }
+            }
+        }
+    }
+
+    /// Replace the session with the standby, or with a newly opened one, retrying
+    /// with the backoff of `reconnectPolicy`. Waits for the running command first.
+    public func reconnect() async throws {
+        await beginCommand()
+        defer { endCommand() }
+        try await reopen()
+    }
+
+    // MARK: Command queue
+
+    func beginCommand() async {
+        if isBusy {
+            await withCheckedContinuation { commandWaiters.append($0) }
+        } else {
+            isBusy = true
+        }
+    }
+
+    func endCommand() {
+        lastActivity = .now
+        if commandWaiters.isEmpty {
+            isBusy = false
+            // close() left the session to the command that was running.
+            if isClosed { releaseSession() }
+        } else {
+            // Hand the connection straight to the next command.
+            commandWaiters.removeFirst().resume()
+        }
+    }
+
+    /// The handle to run the current command on, reopening a dead session first
+    /// when a policy allows. Call between `beginCommand()` and `endCommand()`.
+    func liveConnection() async throws -> Int {
+        guard !isClosed else { throw TDSConnectionError.notConnected }
+        if reconnectPolicy != nil, isDead {
+            try await reopen()
+        }
+        guard let connRaw = rawConnection else {
+            throw TDSConnectionError.notConnected
+        }
+        return connRaw
+    }
+
+    // MARK: Reconnect
+
+    /// Reopen the session, logging in at most once per entry of `attempts` (by
+    /// default all of the policy's) with the policy's backoff before each.
+    private func reopen(attempts: Range<Int>? = nil) async throws {
+        guard !isClosed else { throw TDSConnectionError.notConnected }
+        if let old = connection {
+            connection = nil
+            closeConnection(old)
+        }
+        if let spare = standby, !isProbingStandby {
+            standby = nil
+            if isConnectionDead(spare) == 0 {
+                connection = spare
+                refillStandby()
+                return
+            }
+            closeConnection(spare)
+        }
+
+        let policy = reconnectPolicy ?? ReconnectPolicy(maxAttempts: 1)
+        var lastError: Error = TDSConnectionError.notConnected
+        for attempt in attempts ?? 0..<policy.maxAttempts {
+            try await Task.sleep(for: policy.backoff(before: attempt))
+            let opened: OpaquePointer
+            do {
+                opened = try await openSession()
+            } catch {
+                lastError = error
+                continue
+            }
+            if isClosed {
+                closeConnection(opened)
+                throw TDSConnectionError.notConnected
             }
+            connection = opened
+            refillStandby()
+            return
+        }
+        throw lastError
+    }
+
+    /// Log in on `executor`, off the calling thread.
+    private func openSession() async throws -> OpaquePointer {
+        let login = login
+        let raw = try await Task.detached(executorPreference: executor) {
+            Int(bitPattern: try TDSConnection.open(login))
+        }.value
+        return OpaquePointer(bitPattern: raw)!
+    }
+
+    private func refillStandby() {
+        guard keepsStandbyConnection, standby == nil, !isOpeningStandby, !isClosed else {
+            return
+        }
+        isOpeningStandby = true
+        Task {
+            let opened = try? await self.openSession()
+            self.installStandby(opened)
+        }
+    }
+
+    private func installStandby(_ opened: OpaquePointer?) {
+        isOpeningStandby = false
+        guard let opened else { return }
+        if isClosed || standby != nil {
+            closeConnection(opened)
+        } else {
+            standby = opened
+        }
+    }
+
+    // MARK: Keepalive
+
+    private func startMaintenance(keepaliveInterval: Duration?) {
+        guard !isClosed else { return }
+        refillStandby()
+        guard let interval = keepaliveInterval else { return }
+        keepaliveTask = Task { [weak self] in
+            while !Task.isCancelled {
+                try? await Task.sleep(for: interval)
+                guard let self else { return }
+                await self.keepalive(interval: interval)
+            }
+        }
+    }
+
+    /// Ping an idle session and the standby, replacing whichever has died.
+    private func keepalive(interval: Duration) async {
+        guard !isClosed else { return }
+        if !isBusy, ContinuousClock.now - lastActivity >= interval {
+            await ping()
+        }
+        await probeStandby()
+    }
+
+    private func probeStandby() async {
+        guard let spare = standby, !isProbingStandby else {
+            refillStandby()
+            return
+        }
+        isProbingStandby = true
+        let raw = Int(bitPattern: spare)
+        let alive = await Task.detached(executorPreference: executor) {
+            let conn = OpaquePointer(bitPattern: raw)!
+            let answered = (try? TDSConnection.withFetchedRows(conn, queryString: "SELECT 1") {
+                _, _, _ in
+            }) != nil
+            return answered && isConnectionDead(conn) == 0
+        }.value
+        isProbingStandby = false
+        if isClosed || !alive {
+            standby = nil
+            closeConnection(spare)
+            refillStandby()
+        }
+    }
+}
+
+extension SQLResult {
+    /// Build a result from rows returned by the C fetch helpers. Only the first row
+    /// of each result set carries column names; later rows reuse them. `columns`
+    /// are those of the first row.
+    init(
+        fetched cRows: UnsafeMutablePointer<RowData>?,
+        rowCount: Int,
+        affectedRows: Int,
+        encoding: String.Encoding
+    ) {
+        var results: [[String: SQLDataType]] = []
+        var columnNames: [String] = []
+
+        if let cRows, rowCount > 0 {
+            columnNames = cRows[0].columnNameList ?? []
+
+            var names = columnNames
+            results.reserveCapacity(rowCount)
+            for i in 0..<rowCount {
+                let row = cRows[i]
+                if let rowNames = row.columnNameList { names = rowNames }
+                results.append(row.dictionary(names: names, encoding: encoding))
+            }
+        }
+
+        self.init(columns: columnNames, rows: results, affectedRows: affectedRows)
+    }
+}
+
+extension String.Encoding {
+    /// Map a FreeTDS/iconv charset name to the encoding used to decode fetched text.
+    /// Unknown or missing names fall back to UTF-8.
+    init(tdsCharset name: String?) {
+        switch name?.uppercased() {
+        case "ISO-8859-1", "ISO_8859-1", "LATIN1", "ISO-8859-1//TRANSLIT":
+            self = .isoLatin1
+        case "CP1252", "WINDOWS-1252":
+            self = .windowsCP1252
+        case "ASCII", "US-ASCII":
+            self = .ascii
+        case "UCS-2LE", "UTF-16LE":
+            self = .utf16LittleEndian
+        default:
+            self = .utf8
         }
     }
 }
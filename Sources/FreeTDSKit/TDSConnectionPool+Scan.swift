@@ -0,0 +1,253 @@
+//
+//  TDSConnectionPool+Scan.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+/// Progress of one partition of `TDSConnectionPool.scan`.
+public struct ScanProgress: Sendable {
+    /// Index of the partition, in key order.
+    public let partition: Int
+    /// Total number of partitions in the scan.
+    public let partitionCount: Int
+    /// Rows read from this partition so far.
+    public let rowsRead: Int
+    /// Whether this partition has been read completely.
+    public let isFinished: Bool
+}
+
+extension TDSConnectionPool {
+
+    /// Read `table` as `partitions` key ranges in parallel, one leased connection per
+    /// range, and merge the rows into a single stream.
+    ///
+    /// Ranges are split on an integer `keyColumn` (any integer type, or `decimal` or
+    /// `numeric` with scale 0), either at `splitPoints` or evenly between the
+    /// column's `MIN` and `MAX`; other key types throw. Each range is a half-open
+    /// `key >= a AND key < b` predicate, so boundaries never overlap. Rows with a
+    /// NULL key are not returned. `table`, `keyColumn` and `columns` are inserted into
+    /// the SQL verbatim.
+    ///
+    /// Unordered scans yield rows as any partition produces them. Ordered scans sort
+    /// each partition by key and yield partitions in key order. The partitions after
+    /// the current one, up to `maxConnections` in all, keep reading in the meantime,
+    /// buffering up to `bufferSize` rows each before they pause; the merged stream also holds at most `bufferSize` rows ahead of the
+    /// consumer. `progress` is called every `progressInterval` rows per partition
+    /// and once when each partition finishes.
+    public nonisolated func scan(
+        table: String,
+        keyColumn: String,
+        columns: [String] = ["*"],
+        partitions: Int,
+        splitPoints: [Int64]? = nil,
+        ordered: Bool = false,
+        bufferSize: Int = 256,
+        progressInterval: Int = 10_000,
+        progress: (@Sendable (ScanProgress) -> Void)? = nil
+    ) -> AsyncThrowingStream<[String: SQLDataType], Error> {
+        let output = BoundedStreamBuffer<[String: SQLDataType]>(capacity: max(1, bufferSize))
+        let task = Task {
+            do {
+                let points: [Int64]
+                if let splitPoints {
+                    points = Array(Set(splitPoints)).sorted()
+                } else if let computed = try await self.splitPoints(
+                    table: table, keyColumn: keyColumn, partitions: partitions
+                ) {
+                    points = computed
+                } else {
+                    // No non-NULL keys: nothing to scan.
+                    output.finish()
+                    return
+                }
+
+                let queries = TDSConnectionPool.partitionPredicates(
+                    keyColumn: keyColumn, splitPoints: points
+                ).map { predicate in
+                    "SELECT \(columns.joined(separator: ", ")) FROM \(table) WHERE \(predicate)"
+                        + (ordered ? " ORDER BY \(keyColumn)" : "")
+                }
+                let reader = PartitionReader(
+                    pool: self,
+                    partitionCount: queries.count,
+                    bufferSize: max(1, bufferSize),
+                    progressInterval: max(1, progressInterval),
+                    progress: progress
+                )
+                let emit: @Sendable ([String: SQLDataType]) async -> Bool = { await output.send($0) }
+                if ordered {
+                    try await reader.readInOrder(queries, emit)
+                } else {
+                    try await reader.readUnordered(queries, emit)
+                }
+                output.finish()
+            } catch {
+                output.finish(throwing: error)
+            }
+        }
+        output.onCancel { task.cancel() }
+        return output.stream
+    }
+
+    /// Evenly spaced split points between the key column's current `MIN` and `MAX`,
+    /// or `nil` when the table has no non-NULL keys.
+    nonisolated func splitPoints(
+        table: String,
+        keyColumn: String,
+        partitions: Int
+    ) async throws -> [Int64]? {
+        let bounds = try await withConnection { connection in
+            try await connection.execute(
+                queryString: "SELECT MIN(\(keyColumn)) AS Lo, MAX(\(keyColumn)) AS Hi FROM \(table)"
+            )
+        }
+        let scale = bounds.schema?["Lo"]?.scale ?? 0
+        guard
+            let lower = try TDSConnectionPool.splitKey(bounds[0, "Lo"] ?? .null, scale: scale, column: keyColumn),
+            let upper = try TDSConnectionPool.splitKey(bounds[0, "Hi"] ?? .null, scale: scale, column: keyColumn)
+        else {
+            return nil
+        }
+        return TDSConnectionPool.splitPoints(lower: lower, upper: upper, partitions: partitions)
+    }
+
+    /// `value` of key `column` as an `Int64`, or `nil` when it is NULL. Integer
+    /// types and `decimal`/`numeric` values with scale 0 convert; anything else
+    /// throws rather than scanning nothing.
+    static func splitKey(_ value: SQLDataType, scale: Int, column: String) throws -> Int64? {
+        switch value {
+        case .null: return nil
+        case .tinyInt(let v): return Int64(v)
+        case .smallInt(let v): return Int64(v)
+        case .integer(let v): return Int64(v)
+        case .bigInt(let v): return v
+        case .decimal(let d), .numeric(let d):
+            if scale == 0, let key = Int64(d.description) { return key }
+        default: break
+        }
+        throw TDSConnectionError.queryExecutionFailed(
+            reason: "Scan key \(column) must be an integer column, got \(value)"
+        )
+    }
+
+    /// `partitions - 1` ascending split points dividing `lower...upper` into ranges
+    /// of near-equal width. Fewer points are returned when the range is narrower than
+    /// the partition count.
+    static func splitPoints(lower: Int64, upper: Int64, partitions: Int) -> [Int64] {
+        guard partitions > 1, upper > lower else { return [] }
+        let span = Int128(upper) - Int128(lower) + 1
+        let parts = min(Int128(partitions), span)
+        return (1..<Int(parts)).map { i in
+            Int64(Int128(lower) + span * Int128(i) / parts)
+        }
+    }
+
+    /// One half-open range predicate per partition: below the first split point,
+    /// between consecutive points, and from the last point up.
+    static func partitionPredicates(keyColumn: String, splitPoints: [Int64]) -> [String] {
+        guard let first = splitPoints.first, let last = splitPoints.last else {
+            return ["\(keyColumn) IS NOT NULL"]
+        }
+        var predicates = ["\(keyColumn) < \(first)"]
+        for (lower, upper) in zip(splitPoints, splitPoints.dropFirst()) {
+            predicates.append("\(keyColumn) >= \(lower) AND \(keyColumn) < \(upper)")
+        }
+        predicates.append("\(keyColumn) >= \(last)")
+        return predicates
+    }
+}
+
+/// Runs the per-partition queries of a scan on leased connections.
+private struct PartitionReader: Sendable {
+    typealias Row = [String: SQLDataType]
+    /// Passes a row on, or returns `false` once the consumer has gone away.
+    typealias Emit = @Sendable (Row) async -> Bool
+
+    let pool: TDSConnectionPool
+    let partitionCount: Int
+    let bufferSize: Int
+    let progressInterval: Int
+    let progress: (@Sendable (ScanProgress) -> Void)?
+
+    func readUnordered(_ queries: [String], _ emit: @escaping Emit) async throws {
+        try await withThrowingTaskGroup(of: Void.self) { group in
+            for (index, query) in queries.enumerated() {
+                group.addTask {
+                    try await read(partition: index, query: query, emit)
+                }
+            }
+            try await group.waitForAll()
+        }
+    }
+
+    /// Partitions are started in key order, no more at once than the pool has
+    /// connections, and partition `i + window` only once partition `i` has been
+    /// drained. Otherwise later partitions could hold every lease while waiting
+    /// on their full buffers, and the partition the consumer needs next would
+    /// never get a connection.
+    func readInOrder(_ queries: [String], _ emit: @escaping Emit) async throws {
+        let buffers = queries.map { _ in BoundedStreamBuffer<Row>(capacity: bufferSize) }
+        let window = max(1, min(pool.maxConnections, queries.count))
+        try await withThrowingTaskGroup(of: Void.self) { group in
+            func start(_ index: Int) {
+                let buffer = buffers[index]
+                let query = queries[index]
+                group.addTask {
+                    do {
+                        try await read(partition: index, query: query) { await buffer.send($0) }
+                        buffer.finish()
+                    } catch {
+                        buffer.finish(throwing: error)
+                        throw error
+                    }
+                }
+            }
+            for index in 0..<window {
+                start(index)
+            }
+            do {
+                for (index, buffer) in buffers.enumerated() {
+                    for try await row in buffer.stream {
+                        guard await emit(row) else { throw CancellationError() }
+                    }
+                    if index + window < queries.count {
+                        start(index + window)
+                    }
+                }
+            } catch {
+                // Partitions waiting on a full buffer would otherwise never return.
+                buffers.forEach { $0.cancel() }
+                throw error
+            }
+            try await group.waitForAll()
+        }
+    }
+
+    private func read(partition: Int, query: String, _ emit: @escaping Emit) async throws {
+        try await pool.withConnection { connection in
+            var rowsRead = 0
+            for try await row in connection.query(query: query) {
+                guard await emit(row) else { throw CancellationError() }
+                rowsRead += 1
+                if rowsRead % progressInterval == 0 {
+                    report(partition: partition, rowsRead: rowsRead, isFinished: false)
+                }
+            }
+            // An abandoned stream ends quietly; surface cancellation instead.
+            try Task.checkCancellation()
+            report(partition: partition, rowsRead: rowsRead, isFinished: true)
+        }
+    }
+
+    private func report(partition: Int, rowsRead: Int, isFinished: Bool) {
+        progress?(
+            ScanProgress(
+                partition: partition,
+                partitionCount: partitionCount,
+                rowsRead: rowsRead,
+                isFinished: isFinished
+            )
+        )
+    }
+}
@@ -0,0 +1,246 @@
+//
+//  TDSConnectionPool.swift
+//  FreeTDSKit
+//
+
+import Foundation
+
+/// A bounded set of `TDSConnection`s opened on demand from one configuration.
+///
+/// A `TDSConnection` runs one command at a time, so independent queries issued
+/// through a single connection execute back to back. Leasing connections from a
+/// pool lets them run concurrently, and `execute(queries:maxConcurrency:)` fans a
+/// batch out so its latency tracks the slowest query rather than the sum.
+public actor TDSConnectionPool {
+    /// Configuration used to open new connections.
+    public nonisolated let configuration: ConnectionConfiguration
+    /// Upper bound on open connections; further leases wait for a release.
+    public nonisolated let maxConnections: Int
+    /// Whether returned connections are reset with `TDSConnection.resetSession()`
+    /// before their next lease, so no session state carries over between leases.
+    public nonisolated let resetsSessions: Bool
+
+    private var idle: [TDSConnection] = []
+    private var openCount = 0
+    private var waiters: [(id: UInt64, continuation: CheckedContinuation<TDSConnection, Error>)] = []
+    private var nextWaiterID: UInt64 = 0
+    private var isClosed = false
+
+    public init(
+        configuration: ConnectionConfiguration,
+        maxConnections: Int = 8,
+        resetsSessions: Bool = false
+    ) {
+        precondition(maxConnections > 0, "TDSConnectionPool needs at least one connection")
+        self.configuration = configuration
+        self.maxConnections = maxConnections
+        self.resetsSessions = resetsSessions
+    }
+
+    /// Lease a connection for the duration of `body`, opening one if the pool has
+    /// room and waiting for a release otherwise.
+    public nonisolated func withConnection<T>(
+        isolation: isolated (any Actor)? = #isolation,
+        _ body: (TDSConnection) async throws -> T
+    ) async throws -> T {
+        let connection = try await acquire()
+        do {
+            let result = try await body(connection)
+            await recycle(connection)
+            return result
+        } catch {
+            await recycle(connection)
+            throw error
+        }
+    }
+
+    /// Run `queries` concurrently on leased connections and return their results in
+    /// input order. At most `maxConcurrency` (default `maxConnections`) run at once.
+    /// The first failure, or cancelling the caller, cancels every query still in
+    /// flight.
+    public nonisolated func execute(
+        queries: [String],
+        maxConcurrency: Int? = nil
+    ) async throws -> [SQLResult] {
+        var results = [SQLResult?](repeating: nil, count: queries.count)
+        try await fanOut(queries: queries, maxConcurrency: maxConcurrency) { index, result in
+            results[index] = result
+        }
+        return results.map { $0! }
+    }
+
+    /// Like `execute(queries:maxConcurrency:)`, but yields each result, tagged with
+    /// its query's index, as soon as that query completes. Ending iteration early
+    /// cancels the remaining queries.
+    public nonisolated func executeStream(
+        queries: [String],
+        maxConcurrency: Int? = nil
+    ) -> AsyncThrowingStream<(index: Int, result: SQLResult), Error> {
+        AsyncThrowingStream { continuation in
+            let task = Task {
+                do {
+                    try await self.fanOut(queries: queries, maxConcurrency: maxConcurrency) {
+                        index, result in
+                        continuation.yield((index, result))
+                    }
+                    continuation.finish()
+                } catch {
+                    continuation.finish(throwing: error)
+                }
+            }
+            continuation.onTermination = { _ in task.cancel() }
+        }
+    }
+
+    /// Open connections ahead of demand, concurrently, until `count` (default
+    /// `maxConnections`) are open. Leases then skip the login round-trips.
+    public func warmUp(_ count: Int? = nil) async throws {
+        if isClosed { throw TDSConnectionError.notConnected }
+        let needed = min(count ?? maxConnections, maxConnections) - openCount
+        guard needed > 0 else { return }
+        openCount += needed
+        let opened: [TDSConnection]
+        do {
+            opened = try await TDSConnection.connect(configuration: configuration, count: needed)
+        } catch {
+            openCount -= needed
+            wakeWaiterToOpen()
+            throw error
+        }
+        for connection in opened {
+            await release(connection)
+        }
+    }
+
+    /// Close idle connections and fail pending leases. Leased connections are closed
+    /// as they are returned.
+    public func close() async {
+        isClosed = true
+        let pending = waiters
+        waiters.removeAll()
+        for waiter in pending {
+            waiter.continuation.resume(throwing: TDSConnectionError.notConnected)
+        }
+        let connections = idle
+        idle.removeAll()
+        openCount -= connections.count
+        for connection in connections {
+            await connection.close()
+        }
+    }
+
+    // MARK: - Leasing
+
+    func acquire() async throws -> TDSConnection {
+        try Task.checkCancellation()
+        if isClosed { throw TDSConnectionError.notConnected }
+        if let connection = idle.popLast() {
+            return connection
+        }
+        if openCount < maxConnections {
+            openCount += 1
+            do {
+                return try await TDSConnection.connect(configuration: configuration)
+            } catch {
+                openCount -= 1
+                wakeWaiterToOpen()
+                throw error
+            }
+        }
+
+        nextWaiterID += 1
+        let id = nextWaiterID
+        return try await withTaskCancellationHandler {
+            try await withCheckedThrowingContinuation { continuation in
+                waiters.append((id, continuation))
+            }
+        } onCancel: {
+            Task { await self.cancelWaiter(id) }
+        }
+    }
+
+    /// Return a leased connection, first resetting its session if the pool does
+    /// that. A connection whose reset fails is closed rather than reused.
+    private nonisolated func recycle(_ connection: TDSConnection) async {
+        if resetsSessions {
+            do {
+                // Not tied to the caller, so a cancelled lease still gets reset.
+                try await Task { try await connection.resetSession() }.value
+            } catch {
+                await discard(connection)
+                return
+            }
+        }
+        await release(connection)
+    }
+
+    private func discard(_ connection: TDSConnection) async {
+        openCount -= 1
+        await connection.close()
+        wakeWaiterToOpen()
+    }
+
+    func release(_ connection: TDSConnection) async {
+        if isClosed {
+            openCount -= 1
+            await connection.close()
+        } else if connection.reconnectPolicy == nil, await connection.isDead {
+            // A dead session cannot serve another lease; free its slot.
+            await discard(connection)
+        } else if !waiters.isEmpty {
+            waiters.removeFirst().continuation.resume(returning: connection)
+        } else {
+            idle.append(connection)
+        }
+    }
+
+    private func cancelWaiter(_ id: UInt64) {
+        guard let index = waiters.firstIndex(where: { $0.id == id }) else { return }
+        waiters.remove(at: index).continuation.resume(throwing: CancellationError())
+    }
+
+    /// A failed open frees a slot; let the oldest waiter retry opening it.
+    private func wakeWaiterToOpen() {
+        guard !waiters.isEmpty else { return }
+        let waiter = waiters.removeFirst()
+        Task {
+            do {
+                waiter.continuation.resume(returning: try await self.acquire())
+            } catch {
+                waiter.continuation.resume(throwing: error)
+            }
+        }
+    }
+
+    // MARK: - Fan-out
+
+    private nonisolated func fanOut(
+        queries: [String],
+        maxConcurrency: Int?,
+        isolation: isolated (any Actor)? = #isolation,
+        _ onResult: (Int, SQLResult) -> Void
+    ) async throws {
+        guard !queries.isEmpty else { return }
+        let limit = max(1, min(maxConcurrency ?? maxConnections, queries.count))
+        try await withThrowingTaskGroup(of: (Int, SQLResult).self) { group in
+            var next = 0
+            while next < queries.count {
+                if next >= limit, let finished = try await group.next() {
+                    onResult(finished.0, finished.1)
+                }
+                let index = next
+                let query = queries[index]
+                next += 1
+                group.addTask {
+                    let result = try await self.withConnection { connection in
+                        try await connection.execute(queryString: query)
+                    }
+                    return (index, result)
+                }
+            }
+            while let finished = try await group.next() {
+                onResult(finished.0, finished.1)
+            }
+        }
+    }
+}
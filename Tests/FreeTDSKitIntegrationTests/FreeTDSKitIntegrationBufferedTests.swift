@@ -0,0 +1,62 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationBufferedTests: FreeTDSKitIntegrationTestCase {
+
+    private static let numbers = """
+        SELECT TOP (5000) ROW_NUMBER() OVER (ORDER BY (SELECT NULL)) AS N,
+               CONCAT('row ', ROW_NUMBER() OVER (ORDER BY (SELECT NULL))) AS Label
+        FROM sys.all_objects a CROSS JOIN sys.all_objects b
+        """
+
+    func testRandomAccessWithinWindow() async throws {
+        let dbConnection = try makeConnection()
+        try await dbConnection.withBufferedResult(queryString: Self.numbers, windowSize: 500) { result in
+            XCTAssertEqual(result.columns, ["N", "Label"])
+            let n = try await result.value(row: 399, column: "N")
+            XCTAssertEqual(n?.int, 400)
+            // Back within the window.
+            let label = try await result.value(row: 10, column: "Label")
+            XCTAssertEqual(label?.string, "row 11")
+            let row = try await result.row(250)
+            XCTAssertEqual(row?["N"]?.int, 251)
+            XCTAssertEqual(result.window, 0..<400)
+            XCTAssertNil(result.rowCount)
+        }
+        await dbConnection.close()
+    }
+
+    func testWindowSlidesForward() async throws {
+        let dbConnection = try makeConnection()
+        try await dbConnection.withBufferedResult(queryString: Self.numbers, windowSize: 100) { result in
+            let n = try await result.value(row: 1_000, column: "N")
+            XCTAssertEqual(n?.int, 1_001)
+            XCTAssertEqual(result.window, 901..<1_001)
+            do {
+                _ = try await result.value(row: 0, column: "N")
+                XCTFail("Row 0 should have left the window")
+            } catch TDSConnectionError.queryExecutionFailed {
+            }
+        }
+        await dbConnection.close()
+    }
+
+    func testReadingPastEndReportsRowCount() async throws {
+        let dbConnection = try makeConnection()
+        try await dbConnection.withBufferedResult(queryString: "SELECT Id FROM \(testTable)") { result in
+            let missing = try await result.row(10)
+            XCTAssertNil(missing)
+            XCTAssertEqual(result.rowCount, 2)
+            let last = try await result.value(row: 1, column: "Id")
+            XCTAssertEqual(last?.int, 2)
+        }
+        // The connection is usable again afterwards.
+        let after = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(after[0, "One"]?.int, 1)
+        await dbConnection.close()
+    }
+}
+
+#endif
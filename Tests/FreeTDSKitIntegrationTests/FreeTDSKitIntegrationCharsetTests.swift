@@ -0,0 +1,72 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+/// Client charset negotiation and an NVARCHAR-heavy read benchmark per charset.
+final class FreeTDSKitIntegrationCharsetTests: FreeTDSKitIntegrationTestCase {
+
+    private let sample = "Grüße – naïve café ✓"
+
+    private func makeConnection(charset: String?) throws -> TDSConnection {
+        try TDSConnection(
+            server: connectionString,
+            username: username,
+            password: password,
+            database: database,
+            charset: charset
+        )
+    }
+
+    func testDefaultCharsetIsUTF8() async throws {
+        let connection = try makeConnection()
+        XCTAssertEqual(connection.clientCharset?.uppercased(), "UTF-8")
+        await connection.close()
+    }
+
+    func testNonASCIINVarCharRoundTripsAsUTF8() async throws {
+        let connection = try makeConnection(charset: "UTF-8")
+        let result = try await connection.execute(
+            queryString: "SELECT CAST(N'\(sample)' AS NVARCHAR(50)) AS Value"
+        )
+        XCTAssertEqual(result.rows.first?["Value"]?.string, sample)
+        await connection.close()
+    }
+
+    func testLatin1CharsetDecodesRepresentableText() async throws {
+        let connection = try makeConnection(charset: "ISO-8859-1")
+        let result = try await connection.execute(
+            queryString: "SELECT CAST(N'Grüße café' AS NVARCHAR(50)) AS Value"
+        )
+        XCTAssertEqual(result.rows.first?["Value"]?.string, "Grüße café")
+        await connection.close()
+    }
+
+    /// Reads 20k rows of four NVARCHAR(200) columns under each charset and prints
+    /// the median wall time, for comparing conversion cost between settings.
+    func testBenchmarkNVarCharReadsPerCharset() async throws {
+        let query = """
+            SELECT TOP 20000
+                REPLICATE(N'ü', 200) AS A, REPLICATE(N'é', 200) AS B,
+                REPLICATE(N'x', 200) AS C, REPLICATE(N'✓', 200) AS D
+            FROM sys.all_objects a CROSS JOIN sys.all_objects b
+            """
+        let clock = ContinuousClock()
+        for charset in ["UTF-8", "ISO-8859-1", nil] as [String?] {
+            let connection = try makeConnection(charset: charset)
+            var samples: [Duration] = []
+            for _ in 0..<5 {
+                let elapsed = try await clock.measure {
+                    let result = try await connection.execute(queryString: query)
+                    XCTAssertEqual(result.rows.count, 20_000)
+                }
+                samples.append(elapsed)
+            }
+            let median = samples.sorted()[samples.count / 2]
+            print("NVARCHAR read, charset \(charset ?? "freetds.conf default"): \(median)")
+            await connection.close()
+        }
+    }
+}
+
+#endif
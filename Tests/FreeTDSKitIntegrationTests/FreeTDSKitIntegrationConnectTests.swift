@@ -0,0 +1,79 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationConnectTests: FreeTDSKitIntegrationTestCase {
+
+    private var configuration: ConnectionConfiguration {
+        ConnectionConfiguration(
+            host: server,
+            port: Int(port) ?? 1433,
+            username: username,
+            password: password,
+            database: database
+        )
+    }
+
+    func testAsyncConnect() async throws {
+        let dbConnection = try await TDSConnection.connect(configuration: configuration)
+        let result = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(result[0, "One"]?.int, 1)
+        await dbConnection.close()
+    }
+
+    func testAsyncConnectReportsLoginFailure() async throws {
+        var configuration = configuration
+        configuration.password = "wrong password"
+        do {
+            _ = try await TDSConnection.connect(configuration: configuration)
+            XCTFail("Expected login to fail")
+        } catch TDSConnectionError.connectionFailed {
+        }
+    }
+
+    /// A login to an address that never answers is abandoned as soon as the
+    /// caller is cancelled, well before the login timeout.
+    func testCancellingConnectReturnsPromptly() async throws {
+        var configuration = configuration
+        configuration.host = "10.255.255.1"
+        configuration.timeout = 10
+        let attempt = Task {
+            try await TDSConnection.connect(configuration: configuration)
+        }
+        try await Task.sleep(for: .milliseconds(200))
+        let clock = ContinuousClock()
+        let start = clock.now
+        attempt.cancel()
+        do {
+            _ = try await attempt.value
+            XCTFail("Expected cancellation")
+        } catch is CancellationError {
+        }
+        XCTAssertLessThan(clock.now - start, .seconds(1))
+    }
+
+    func testConnectManyOpensDistinctSessions() async throws {
+        let connections = try await TDSConnection.connect(configuration: configuration, count: 4)
+        XCTAssertEqual(connections.count, 4)
+        var spids: Set<Int> = []
+        for connection in connections {
+            let result = try await connection.execute(queryString: "SELECT @@SPID AS Spid")
+            spids.insert(try XCTUnwrap(result[0, "Spid"]?.int))
+            await connection.close()
+        }
+        XCTAssertEqual(spids.count, 4)
+    }
+
+    func testPoolWarmUpOpensConnectionsAhead() async throws {
+        let pool = TDSConnectionPool(configuration: configuration, maxConnections: 3)
+        try await pool.warmUp()
+        let elapsed = try await ContinuousClock().measure {
+            _ = try await pool.execute(queries: Array(repeating: "SELECT 1 AS N", count: 3))
+        }
+        print("Fan-out on a warm pool took \(elapsed)")
+        await pool.close()
+    }
+}
+
+#endif
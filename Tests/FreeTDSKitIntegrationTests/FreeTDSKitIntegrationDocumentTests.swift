@@ -0,0 +1,61 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationDocumentTests: FreeTDSKitIntegrationTestCase {
+
+    /// Long enough that the server splits it over several rows.
+    private static let objectsJSON = "SELECT TOP 500 object_id, name FROM sys.all_objects ORDER BY object_id FOR JSON PATH"
+
+    func testForJSONIsReassembledIntoOneDocument() async throws {
+        let dbConnection = try makeConnection()
+        let data = try await dbConnection.fetchDocument(queryString: Self.objectsJSON)
+        let objects = try XCTUnwrap(JSONSerialization.jsonObject(with: data) as? [[String: Any]])
+        XCTAssertEqual(objects.count, 500)
+
+        let text = try await dbConnection.fetchDocumentString(queryString: Self.objectsJSON)
+        XCTAssertEqual(Data(text.utf8), data)
+        await dbConnection.close()
+    }
+
+    func testDocumentChunksConcatenateToTheDocument() async throws {
+        let dbConnection = try makeConnection()
+        var chunks: [Data] = []
+        for try await chunk in dbConnection.documentChunks(queryString: Self.objectsJSON) {
+            chunks.append(chunk)
+        }
+        XCTAssertGreaterThan(chunks.count, 1)
+        let whole = try await dbConnection.fetchDocument(queryString: Self.objectsJSON)
+        XCTAssertEqual(chunks.reduce(Data(), +), whole)
+        await dbConnection.close()
+    }
+
+    func testForXML() async throws {
+        let dbConnection = try makeConnection()
+        let xml = try await dbConnection.fetchDocumentString(
+            queryString: "SELECT Id FROM \(testTable) ORDER BY Id FOR XML PATH('row')"
+        )
+        XCTAssertEqual(xml, "<row><Id>1</Id></row><row><Id>2</Id></row>")
+        await dbConnection.close()
+    }
+
+    func testOtherResultShapesAreRejected() async throws {
+        let dbConnection = try makeConnection()
+        do {
+            _ = try await dbConnection.fetchDocument(queryString: "SELECT 1 AS A, 2 AS B")
+            XCTFail("Expected a two-column result to be rejected")
+        } catch {}
+        let empty = try await dbConnection.fetchDocument(
+            queryString: "SELECT Id FROM \(testTable) WHERE Id < 0 FOR JSON PATH"
+        )
+        XCTAssertTrue(empty.isEmpty)
+
+        // The session is usable again afterwards.
+        let result = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(result[0, "One"]?.int, 1)
+        await dbConnection.close()
+    }
+}
+
+#endif
@@ -49,6 +49,34 @@ final class FreeTDSKitIntegrationExecuteTests: FreeTDSKitIntegrationTestCase {
         XCTAssertGreaterThanOrEqual(result.affectedRows, 1, "Expected at least one row to be deleted")
         await connection.close()
     }
+
+    func testConcurrentFailuresReportTheirOwnErrors() async throws {
+        let first = try makeConnection()
+        let second = try makeConnection()
+        func failures(on connection: TDSConnection, table: String) async -> [String] {
+            var reasons: [String] = []
+            for _ in 0..<10 {
+                do {
+                    _ = try await connection.execute(queryString: "SELECT * FROM \(table)")
+                } catch TDSConnectionError.queryExecutionFailed(let reason) {
+                    reasons.append(reason)
+                } catch {
+                    reasons.append("\(error)")
+                }
+            }
+            return reasons
+        }
+        async let firstReasons = failures(on: first, table: "NoSuchTableFirst")
+        async let secondReasons = failures(on: second, table: "NoSuchTableSecond")
+        for reason in await firstReasons {
+            XCTAssertTrue(reason.contains("NoSuchTableFirst"), reason)
+        }
+        for reason in await secondReasons {
+            XCTAssertTrue(reason.contains("NoSuchTableSecond"), reason)
+        }
+        await first.close()
+        await second.close()
+    }
 }
 
 #endif
@@ -0,0 +1,58 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+/// Benchmarks cooperative-pool latency while slow queries are in flight.
+final class FreeTDSKitIntegrationExecutorTests: FreeTDSKitIntegrationTestCase {
+
+    /// Runs twice as many 2-second `WAITFOR` queries as there are CPU cores while a
+    /// probe task measures how late 10ms sleeps wake up on the cooperative pool.
+    /// With blocking calls on the dedicated executor the probe stays on time; on the
+    /// cooperative pool it stalled until the queries finished.
+    func testBenchmarkCooperativePoolLatencyUnderSlowQueries() async throws {
+        let concurrency = ProcessInfo.processInfo.activeProcessorCount * 2
+        let executor = TDSBlockingExecutor(threadCount: concurrency)
+        let connections = try (0..<concurrency).map { _ in
+            try TDSConnection(
+                server: connectionString,
+                username: username,
+                password: password,
+                database: database,
+                executor: executor
+            )
+        }
+
+        let queries = Task {
+            try await withThrowingTaskGroup(of: Void.self) { group in
+                for connection in connections {
+                    group.addTask {
+                        _ = try await connection.execute(queryString: "WAITFOR DELAY '00:00:02'")
+                    }
+                }
+                try await group.waitForAll()
+            }
+        }
+
+        let clock = ContinuousClock()
+        var lateness: [Duration] = []
+        for _ in 0..<50 {
+            let start = clock.now
+            try await Task.sleep(for: .milliseconds(10))
+            lateness.append(clock.now - start - .milliseconds(10))
+        }
+        try await queries.value
+
+        lateness.sort()
+        let p50 = lateness[lateness.count / 2]
+        let p99 = lateness[lateness.count * 99 / 100]
+        print("Cooperative pool probe lateness with \(concurrency) slow queries: p50 \(p50), p99 \(p99)")
+        XCTAssertLessThan(p99, .milliseconds(500))
+
+        for connection in connections {
+            await connection.close()
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+/// Integration tests for the bulk export paths (CSV, NDJSON, JSON, Arrow IPC).
+final class FreeTDSKitIntegrationExportTests: FreeTDSKitIntegrationTestCase {
+
+    func testCSVExportWritesHeaderAndRows() async throws {
+        let connection = try makeConnection()
+        let data = try await connection.export(
+            queryString: "SELECT Id, VarCharColumn, BinaryColumn FROM \(testTable) ORDER BY Id",
+            format: .csv
+        )
+        let text = try XCTUnwrap(String(data: data, encoding: .utf8))
+        let lines = text.components(separatedBy: "\r\n").filter { !$0.isEmpty }
+        XCTAssertEqual(lines.first, "Id,VarCharColumn,BinaryColumn")
+        XCTAssertEqual(lines.count, 3)
+        XCTAssertTrue(lines[1].hasPrefix("1,VariableChar,0x0102030405060708090A"))
+        await connection.close()
+    }
+
+    func testNDJSONExportProducesOneObjectPerRow() async throws {
+        let connection = try makeConnection()
+        let data = try await connection.export(
+            queryString: "SELECT Id, NVarCharColumn, VarBinaryColumn, BitColumn FROM \(testTable) ORDER BY Id",
+            format: .ndjson
+        )
+        let lines = data.split(separator: UInt8(ascii: "\n"))
+        XCTAssertEqual(lines.count, 2)
+        let second = try JSONSerialization.jsonObject(with: Data(lines[1])) as? [String: Any]
+        XCTAssertEqual(second?["NVarCharColumn"] as? String, "AnotherVar")
+        XCTAssertTrue(second?["VarBinaryColumn"] is NSNull)
+        XCTAssertEqual(second?["BitColumn"] as? Bool, false)
+        await connection.close()
+    }
+
+    func testJSONExportIsOneArray() async throws {
+        let connection = try makeConnection()
+        let data = try await connection.export(
+            queryString: "SELECT Id, NVarCharColumn FROM \(testTable) ORDER BY Id",
+            format: .json
+        )
+        let rows = try JSONSerialization.jsonObject(with: data) as? [[String: Any]]
+        XCTAssertEqual(rows?.compactMap { $0["Id"] as? Int }, [1, 2])
+        XCTAssertEqual(rows?.last?["NVarCharColumn"] as? String, "AnotherVar")
+
+        let empty = try await connection.export(
+            queryString: "SELECT Id FROM \(testTable) WHERE Id < 0",
+            format: .json
+        )
+        XCTAssertEqual(String(decoding: empty, as: UTF8.self), "[]")
+        await connection.close()
+    }
+
+    func testJSONExportStreamsInChunks() async throws {
+        let connection = try makeConnection()
+        var chunks: [Data] = []
+        for try await chunk in connection.exportStream(
+            queryString: "SELECT * FROM \(testTable) ORDER BY Id",
+            chunkSize: 16
+        ) {
+            chunks.append(chunk)
+        }
+        XCTAssertGreaterThan(chunks.count, 1)
+        let rows = try JSONSerialization.jsonObject(with: chunks.reduce(Data(), +)) as? [[String: Any]]
+        XCTAssertEqual(rows?.count, 2)
+
+        // The connection is free again once the stream ends.
+        let result = try await connection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(result[0, "One"]?.int, 1)
+        await connection.close()
+    }
+
+    func testExportToFileDescriptor() async throws {
+        let connection = try makeConnection()
+        let url = FileManager.default.temporaryDirectory
+            .appendingPathComponent("freetdskit-export-\(UUID().uuidString).csv")
+        FileManager.default.createFile(atPath: url.path, contents: nil)
+        let handle = try FileHandle(forWritingTo: url)
+        let rows = try await connection.export(
+            queryString: "SELECT * FROM \(testTable)",
+            format: .csv,
+            to: handle,
+            chunkSize: 64
+        )
+        try handle.close()
+        XCTAssertEqual(rows, 2)
+        let attributes = try FileManager.default.attributesOfItem(atPath: url.path)
+        XCTAssertGreaterThan(attributes[.size] as? Int ?? 0, 0)
+        try? FileManager.default.removeItem(at: url)
+        await connection.close()
+    }
+
+    func testArrowExportToMemory() async throws {
+        let connection = try makeConnection()
+        let data = try await connection.exportArrow(
+            queryString: "SELECT Id, DecimalColumn, VarCharColumn FROM \(testTable)",
+            format: .file
+        )
+        XCTAssertEqual(Array(data.prefix(6)), Array("ARROW1".utf8))
+        XCTAssertEqual(Array(data.suffix(6)), Array("ARROW1".utf8))
+        await connection.close()
+    }
+
+    func testArrowExportWritesTimestampValues() async throws {
+        let connection = try makeConnection()
+        let query = """
+            SELECT CAST('2024-12-28T14:45:30.003' AS DATETIME) AS At,
+                   CAST('2024-12-28T14:45:00' AS SMALLDATETIME) AS Minute
+            """
+        let result = try await connection.execute(queryString: query)
+        XCTAssertEqual(result[0, "At"]?.dateTime?.microsecondsSinceEpoch, 1_735_397_130_003_000)
+        XCTAssertEqual(result[0, "Minute"]?.dateTime?.microsecondsSinceEpoch, 1_735_397_100_000_000)
+
+        let data = try await connection.exportArrow(queryString: query)
+        for micros: Int64 in [1_735_397_130_003_000, 1_735_397_100_000_000] {
+            let bytes = withUnsafeBytes(of: micros.littleEndian) { Data($0) }
+            XCTAssertNotNil(data.range(of: bytes), "\(micros) is missing from the record batch")
+        }
+        await connection.close()
+    }
+
+    func testArrowExportWritesOneRowPerBatch() async throws {
+        let connection = try makeConnection()
+        let url = FileManager.default.temporaryDirectory
+            .appendingPathComponent("export-\(UUID().uuidString).arrow")
+        let rows = try await connection.exportArrow(
+            queryString: "SELECT Id, CAST(NULL AS DATE) AS Missing FROM \(testTable) ORDER BY Id",
+            to: url,
+            batchSize: 1
+        )
+        XCTAssertEqual(rows, 2)
+        let data = try Data(contentsOf: url)
+        XCTAssertEqual(Array(data.prefix(6)), Array("ARROW1".utf8))
+        try? FileManager.default.removeItem(at: url)
+        await connection.close()
+    }
+}
+
+#endif
@@ -0,0 +1,52 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationMessageTests: FreeTDSKitIntegrationTestCase {
+
+    func testProgressArrivesWhileQueryRuns() async throws {
+        let dbConnection = try makeConnection()
+        let progress = Task {
+            var received: [(ServerMessage, ContinuousClock.Instant)] = []
+            for await message in dbConnection.serverMessages() {
+                received.append((message, .now))
+                if message.text == "done" { break }
+            }
+            return received
+        }
+        // Give the iterator time to subscribe.
+        try await Task.sleep(for: .milliseconds(100))
+
+        _ = try await dbConnection.execute(queryString: """
+            RAISERROR ('step 1', 0, 1) WITH NOWAIT;
+            WAITFOR DELAY '00:00:01';
+            PRINT 'done';
+            """)
+        let finished = ContinuousClock.now
+        let received = await progress.value
+
+        XCTAssertEqual(received.map(\.0.text), ["step 1", "done"])
+        XCTAssertEqual(received[0].0.severity, 0)
+        XCTAssertEqual(received[0].0.number, 50_000)
+        // The first message was delivered during the WAITFOR, not after it.
+        XCTAssertLessThan(received[0].1, finished - .milliseconds(500))
+        await dbConnection.close()
+    }
+
+    func testSequenceEndsOnClose() async throws {
+        let dbConnection = try makeConnection()
+        let messages = Task {
+            var count = 0
+            for await _ in dbConnection.serverMessages() { count += 1 }
+            return count
+        }
+        try await Task.sleep(for: .milliseconds(100))
+        _ = try await dbConnection.execute(queryString: "PRINT 'hello'")
+        await dbConnection.close()
+        let count = await messages.value
+        XCTAssertEqual(count, 1)
+    }
+}
+
+#endif
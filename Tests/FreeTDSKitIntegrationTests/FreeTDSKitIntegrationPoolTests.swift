@@ -0,0 +1,131 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+/// Integration tests for pooled connections and query fan-out.
+final class FreeTDSKitIntegrationPoolTests: FreeTDSKitIntegrationTestCase {
+
+    private func makePool(maxConnections: Int = 4) -> TDSConnectionPool {
+        var configuration = ConnectionConfiguration()
+        configuration.host = server
+        configuration.port = Int(port) ?? 1433
+        configuration.username = username
+        configuration.password = password
+        configuration.database = database
+        return TDSConnectionPool(configuration: configuration, maxConnections: maxConnections)
+    }
+
+    func testFanOutReturnsResultsInInputOrder() async throws {
+        let pool = makePool()
+        let queries = (1...6).map { "WAITFOR DELAY '00:00:00.\(7 - $0)00'; SELECT \($0) AS N" }
+        let results = try await pool.execute(queries: queries)
+        XCTAssertEqual(results.map { $0[0, "N"]?.int }, [1, 2, 3, 4, 5, 6])
+        await pool.close()
+    }
+
+    func testFanOutLatencyTracksSlowestQuery() async throws {
+        let pool = makePool(maxConnections: 4)
+        let queries = Array(repeating: "WAITFOR DELAY '00:00:01'; SELECT 1 AS N", count: 4)
+        let elapsed = try await ContinuousClock().measure {
+            _ = try await pool.execute(queries: queries)
+        }
+        XCTAssertLessThan(elapsed, .seconds(3))
+        await pool.close()
+    }
+
+    func testStreamYieldsEachQueryOnce() async throws {
+        let pool = makePool(maxConnections: 2)
+        var seen: [Int] = []
+        for try await (index, result) in pool.executeStream(
+            queries: (0..<5).map { "SELECT \($0) AS N" }
+        ) {
+            XCTAssertEqual(result[0, "N"]?.int, index)
+            seen.append(index)
+        }
+        XCTAssertEqual(seen.sorted(), [0, 1, 2, 3, 4])
+        await pool.close()
+    }
+
+    func testPartitionedScanReadsEveryRowOnce() async throws {
+        let pool = makePool(maxConnections: 2)
+        let finished = Counter()
+        var ids: [Int] = []
+        for try await row in pool.scan(
+            table: testTable,
+            keyColumn: "Id",
+            columns: ["Id", "VarCharColumn"],
+            partitions: 2,
+            ordered: true,
+            progress: { if $0.isFinished { finished.increment() } }
+        ) {
+            ids.append(try XCTUnwrap(row["Id"]?.int))
+        }
+        XCTAssertEqual(ids, [1, 2])
+        XCTAssertEqual(finished.value, 2)
+        await pool.close()
+    }
+
+    func testOrderedScanWithMorePartitionsThanConnections() async throws {
+        let pool = makePool(maxConnections: 2)
+        let numbers = "(SELECT TOP 200 ROW_NUMBER() OVER (ORDER BY object_id) AS N FROM sys.all_objects) AS Numbers"
+        var keys: [Int] = []
+        for try await row in pool.scan(
+            table: numbers,
+            keyColumn: "N",
+            partitions: 6,
+            ordered: true,
+            bufferSize: 1
+        ) {
+            keys.append(try XCTUnwrap(row["N"]?.int))
+        }
+        XCTAssertEqual(keys, Array(1...200))
+        await pool.close()
+    }
+
+    func testPartitionedScanWithSplitPoints() async throws {
+        let pool = makePool(maxConnections: 3)
+        var count = 0
+        for try await _ in pool.scan(
+            table: testTable, keyColumn: "Id", partitions: 3, splitPoints: [2, 1]
+        ) {
+            count += 1
+        }
+        XCTAssertEqual(count, 2)
+        await pool.close()
+    }
+
+    func testCancellationStopsInFlightQueries() async throws {
+        let pool = makePool(maxConnections: 3)
+        let task = Task {
+            try await pool.execute(queries: Array(repeating: "WAITFOR DELAY '00:00:30'", count: 3))
+        }
+        try await Task.sleep(for: .milliseconds(500))
+        let clock = ContinuousClock()
+        let start = clock.now
+        task.cancel()
+        do {
+            _ = try await task.value
+            XCTFail("Expected cancellation")
+        } catch {
+            XCTAssertTrue(error is CancellationError, "\(error)")
+        }
+        XCTAssertLessThan(clock.now - start, .seconds(5))
+
+        // Connections returned to the pool remain usable.
+        let results = try await pool.execute(queries: ["SELECT 1 AS N"])
+        XCTAssertEqual(results.first?[0, "N"]?.int, 1)
+        await pool.close()
+    }
+}
+
+private final class Counter: @unchecked Sendable {
+    private let lock = NSLock()
+    private var count = 0
+
+    var value: Int { lock.withLock { count } }
+
+    func increment() { lock.withLock { count += 1 } }
+}
+
+#endif
@@ -0,0 +1,60 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+/// Integration tests for RPC stored procedure calls.
+final class FreeTDSKitIntegrationProcedureTests: FreeTDSKitIntegrationTestCase {
+
+    func testCallProcedureReturnsRowsStatusAndOutputs() async throws {
+        let connection = try makeConnection()
+        let result = try await connection.callProcedure(
+            name: "dbo.ProcedureCallTest",
+            parameters: [
+                .input("@Input", .integer(2)),
+                .input("@Label", .nvarchar("Grüße")),
+                .output("@Doubled", .integer(0)),
+                .output("@Echo", .nvarchar("")),
+            ]
+        )
+        XCTAssertEqual(result.resultSets.count, 1)
+        XCTAssertEqual(result.resultSets.first?.rows.count, 2)
+        XCTAssertEqual(result.resultSets.first?[0, "VarCharColumn"]?.string, "VariableChar")
+        XCTAssertEqual(result.returnStatus, 7)
+        XCTAssertEqual(result.outputParameters["@Doubled"]?.int, 4)
+        XCTAssertEqual(result.outputParameters["@Echo"]?.string, "Grüße")
+        await connection.close()
+    }
+
+    func testNVarCharParameterKeepsCharactersOutsideTheCodepage() async throws {
+        let connection = try makeConnection()
+        let label = "日本語 😀"
+        let result = try await connection.callProcedure(
+            name: "dbo.ProcedureCallTest",
+            parameters: [
+                .input("@Input", .integer(0)),
+                .input("@Label", .nvarchar(label)),
+                .output("@Doubled", .integer(0)),
+                .output("@Echo", .nvarchar("")),
+            ]
+        )
+        XCTAssertEqual(result.outputParameters["@Echo"]?.string, label)
+        await connection.close()
+    }
+
+    func testCallMissingProcedureThrows() async throws {
+        let connection = try makeConnection()
+        do {
+            _ = try await connection.callProcedure(name: "dbo.NoSuchProcedure")
+            XCTFail("Expected the call to fail")
+        } catch TDSConnectionError.queryExecutionFailed(let reason) {
+            XCTAssertFalse(reason.isEmpty)
+        }
+        // The connection stays usable after a failed call.
+        let check = try await connection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(check[0, "One"]?.int, 1)
+        await connection.close()
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationReconnectTests: FreeTDSKitIntegrationTestCase {
+
+    private func makeResilientConnection(standby: Bool = false) throws -> TDSConnection {
+        try TDSConnection(
+            server: connectionString,
+            username: username,
+            password: password,
+            database: database,
+            reconnectPolicy: ReconnectPolicy(maxAttempts: 3, initialBackoff: .milliseconds(20)),
+            keepsStandbyConnection: standby
+        )
+    }
+
+    /// Kill `connection`'s session from a second connection, as a failover would.
+    private func killSession(of connection: TDSConnection) async throws {
+        let spid = try await connection.execute(queryString: "SELECT @@SPID AS Spid")[0, "Spid"]?.int
+        let killer = try makeConnection()
+        _ = try await killer.execute(queryString: "KILL \(try XCTUnwrap(spid))")
+        await killer.close()
+    }
+
+    func testPingDetectsKilledSession() async throws {
+        let dbConnection = try makeConnection()
+        let alive = await dbConnection.ping()
+        XCTAssertTrue(alive)
+
+        try await killSession(of: dbConnection)
+        let stillAlive = await dbConnection.ping()
+        XCTAssertFalse(stillAlive)
+        let dead = await dbConnection.isDead
+        XCTAssertTrue(dead)
+        await dbConnection.close()
+    }
+
+    func testIdempotentReadReconnectsAfterKilledSession() async throws {
+        let dbConnection = try makeResilientConnection()
+        try await killSession(of: dbConnection)
+
+        let result = try await dbConnection.execute(
+            queryString: "SELECT COUNT(*) AS N FROM \(testTable)",
+            idempotent: true
+        )
+        XCTAssertEqual(result[0, "N"]?.int, 2)
+        let dead = await dbConnection.isDead
+        XCTAssertFalse(dead)
+        await dbConnection.close()
+    }
+
+    /// With a standby session ready, recovery skips the login round-trips.
+    func testStandbyReplacesKilledSession() async throws {
+        let dbConnection = try makeResilientConnection(standby: true)
+        // Let the standby finish logging in.
+        try await Task.sleep(for: .milliseconds(500))
+        let before = try await dbConnection.execute(queryString: "SELECT @@SPID AS Spid")[0, "Spid"]?.int
+        try await killSession(of: dbConnection)
+
+        let clock = ContinuousClock()
+        var after: Int?
+        let elapsed = try await clock.measure {
+            after = try await dbConnection.execute(
+                queryString: "SELECT @@SPID AS Spid",
+                idempotent: true
+            )[0, "Spid"]?.int
+        }
+        XCTAssertNotNil(after)
+        XCTAssertNotEqual(before, after)
+        print("Recovery with standby took \(elapsed)")
+        await dbConnection.close()
+    }
+
+    func testKeepaliveReconnectsIdleConnection() async throws {
+        let dbConnection = try TDSConnection(
+            server: connectionString,
+            username: username,
+            password: password,
+            database: database,
+            keepaliveInterval: .milliseconds(200),
+            reconnectPolicy: ReconnectPolicy()
+        )
+        try await killSession(of: dbConnection)
+        try await Task.sleep(for: .seconds(1))
+
+        // The probe already reopened the session, so a plain execute succeeds.
+        let result = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(result[0, "One"]?.int, 1)
+        await dbConnection.close()
+    }
+}
+
+#endif
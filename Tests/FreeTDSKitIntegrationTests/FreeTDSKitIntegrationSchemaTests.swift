@@ -0,0 +1,63 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationSchemaTests: FreeTDSKitIntegrationTestCase {
+
+    func testExecuteAttachesColumnMetadata() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: "SELECT Id, DecimalColumn, VarBinaryColumn FROM \(testTable) ORDER BY Id"
+        )
+        let schema = try XCTUnwrap(result.schema)
+        XCTAssertEqual(schema.names, result.columns)
+
+        let id = try XCTUnwrap(schema["Id"])
+        XCTAssertTrue(id.isIdentity)
+        XCTAssertFalse(id.isNullable)
+        XCTAssertEqual(id.typeName, "int")
+
+        let decimal = try XCTUnwrap(schema["DecimalColumn"])
+        XCTAssertEqual(decimal.precision, 10)
+        XCTAssertEqual(decimal.scale, 2)
+
+        let binary = try XCTUnwrap(schema["VarBinaryColumn"])
+        XCTAssertTrue(binary.isNullable)
+        XCTAssertEqual(binary.maxLength, 50)
+        await dbConnection.close()
+    }
+
+    func testDecimalValuesKeepTheColumnScale() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: "SELECT CAST(12.3 AS DECIMAL(10, 3)) AS Price, CAST(-0.5 AS MONEY) AS Fee"
+        )
+        XCTAssertEqual(result[0, "Price"]?.decimal, Decimal(string: "12.300"))
+        XCTAssertEqual(result[0, "Fee"]?.decimal, Decimal(string: "-0.50"))
+
+        let price = try XCTUnwrap(result.scaledDecimalColumn("Price"))
+        XCTAssertEqual(price.scale, 3)
+        XCTAssertEqual(price.units[0], 12_300)
+        await dbConnection.close()
+    }
+
+    func testLaterRowsAndResultSetsKeepTheirNames() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: "SELECT Id FROM \(testTable) ORDER BY Id; SELECT 7 AS Seven"
+        )
+        XCTAssertEqual(result.columns, ["Id"])
+        XCTAssertEqual(result.compactMap { $0["Id"]?.int }, [1, 2])
+        XCTAssertEqual(result[2, "Seven"]?.int, 7)
+
+        var streamed: [[String: SQLDataType]] = []
+        for try await row in dbConnection.query(query: "SELECT Id FROM \(testTable); SELECT 7 AS Seven") {
+            streamed.append(row)
+        }
+        XCTAssertEqual(streamed.map { $0.keys.sorted() }, [["Id"], ["Id"], ["Seven"]])
+        await dbConnection.close()
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationSessionTests: FreeTDSKitIntegrationTestCase {
+
+    func testResetDropsSessionState() async throws {
+        let dbConnection = try makeConnection()
+        let spid = try await dbConnection.execute(queryString: "SELECT @@SPID AS Spid")[0, "Spid"]?.int
+        _ = try await dbConnection.execute(queryString: """
+            CREATE TABLE #Leftover (Id INT);
+            SET LOCK_TIMEOUT 1234;
+            BEGIN TRANSACTION;
+            USE master;
+            """)
+
+        try await dbConnection.resetSession()
+
+        let state = try await dbConnection.execute(queryString: """
+            SELECT OBJECT_ID('tempdb..#Leftover') AS TempTable,
+                   @@TRANCOUNT AS TranCount,
+                   @@LOCK_TIMEOUT AS LockTimeout,
+                   DB_NAME() AS DatabaseName,
+                   @@SPID AS Spid
+            """)
+        XCTAssertNil(state[0, "TempTable"]?.int)
+        XCTAssertEqual(state[0, "TranCount"]?.int, 0)
+        XCTAssertEqual(state[0, "LockTimeout"]?.int, -1)
+        XCTAssertEqual(state[0, "DatabaseName"]?.string, database)
+        // Same session: no new login happened.
+        XCTAssertEqual(state[0, "Spid"]?.int, spid)
+        await dbConnection.close()
+    }
+
+    func testPoolResetsSessionsBetweenLeases() async throws {
+        let configuration = ConnectionConfiguration(
+            host: server,
+            port: Int(port) ?? 1433,
+            username: username,
+            password: password,
+            database: database
+        )
+        let pool = TDSConnectionPool(configuration: configuration, maxConnections: 1, resetsSessions: true)
+        try await pool.withConnection { connection in
+            _ = try await connection.execute(queryString: "CREATE TABLE #TenantA (Id INT)")
+        }
+        let leftover = try await pool.withConnection { connection in
+            try await connection.execute(
+                queryString: "SELECT OBJECT_ID('tempdb..#TenantA') AS TempTable"
+            )
+        }
+        XCTAssertNil(leftover[0, "TempTable"]?.int)
+        await pool.close()
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationSpillTests: FreeTDSKitIntegrationTestCase {
+
+    private static let numbers = """
+        SELECT TOP (20000) ROW_NUMBER() OVER (ORDER BY (SELECT NULL)) AS N,
+               REPLICATE('x', 100) AS Padding
+        FROM sys.all_objects a CROSS JOIN sys.all_objects b
+        """
+
+    func testLargeResultSpillsPastThreshold() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(queryString: Self.numbers, spillThreshold: 64 * 1024)
+        XCTAssertTrue(result.isSpilled)
+        XCTAssertEqual(result.count, 20_000)
+        XCTAssertEqual(result.columns, ["N", "Padding"])
+        XCTAssertEqual(result[0, "N"]?.int, 1)
+        XCTAssertEqual(result[19_999, "N"]?.int, 20_000)
+        XCTAssertEqual(result[12_345, "Padding"]?.string?.count, 100)
+
+        var expected = 1
+        for row in result {
+            XCTAssertEqual(row["N"]?.int, expected)
+            expected += 1
+        }
+        XCTAssertEqual(expected, 20_001)
+        await dbConnection.close()
+    }
+
+    func testSmallResultStaysInMemory() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: "SELECT Id FROM \(testTable) ORDER BY Id",
+            spillThreshold: 1 << 20
+        )
+        XCTAssertFalse(result.isSpilled)
+        XCTAssertEqual(result.compactMap { $0["Id"]?.int }, [1, 2])
+        await dbConnection.close()
+    }
+
+    func testOnlyFirstResultSetIsKept() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: Self.numbers + "; SELECT 'x' AS Other",
+            spillThreshold: 64 * 1024
+        )
+        XCTAssertTrue(result.isSpilled)
+        XCTAssertEqual(result.count, 20_000)
+        XCTAssertEqual(result.columns, ["N", "Padding"])
+        XCTAssertEqual(result[19_999, "N"]?.int, 20_000)
+        // The connection is ready for the next command.
+        let check = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertEqual(check[0, "One"]?.int, 1)
+        await dbConnection.close()
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationStatisticsTests: FreeTDSKitIntegrationTestCase {
+
+    func testStatisticsAreAttachedToResult() async throws {
+        let dbConnection = try makeConnection()
+        let result = try await dbConnection.execute(
+            queryString: "SELECT Id FROM \(testTable) ORDER BY Id",
+            collectStatistics: true
+        )
+        XCTAssertEqual(result.compactMap { $0["Id"]?.int }, [1, 2])
+        let statistics = try XCTUnwrap(result.statistics)
+        let table = try XCTUnwrap(statistics.tables.first { $0.table == testTable })
+        XCTAssertGreaterThan(table.logicalReads, 0)
+        XCTAssertFalse(statistics.messages.isEmpty)
+        await dbConnection.close()
+    }
+
+    func testStatisticsCoverOnlyTheirOwnQuery() async throws {
+        let dbConnection = try makeConnection()
+        _ = try await dbConnection.execute(queryString: "SELECT * FROM \(testTable)", collectStatistics: true)
+        let plain = try await dbConnection.execute(queryString: "SELECT 1 AS One")
+        XCTAssertNil(plain.statistics)
+        let next = try await dbConnection.execute(queryString: "SELECT 2 AS Two", collectStatistics: true)
+        XCTAssertEqual(next.statistics?.tables, [])
+        await dbConnection.close()
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+import Synchronization
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationStreamingTests: FreeTDSKitIntegrationTestCase {
+
+    private static let largeQuery = """
+        SELECT TOP (100000) ROW_NUMBER() OVER (ORDER BY (SELECT NULL)) AS N
+        FROM sys.all_objects a CROSS JOIN sys.all_objects b
+        """
+
+    /// A slow consumer holds the producer at most `bufferSize` rows ahead. `map` runs
+    /// on the producer, so it counts the rows fetched so far.
+    func testSlowConsumerBoundsRowsFetchedAhead() async throws {
+        let dbConnection = try makeConnection()
+        let bufferSize = 32
+        let fetched = Fetched()
+        var consumed = 0
+        var maxAhead = 0
+
+        for try await n in dbConnection.query(
+            queryString: Self.largeQuery,
+            bufferSize: bufferSize,
+            map: { row in
+                fetched.increment()
+                return row["N"]?.int ?? -1
+            }
+        ) {
+            consumed += 1
+            XCTAssertEqual(n, consumed)
+            maxAhead = max(maxAhead, fetched.value - consumed)
+            if consumed % 1000 == 0 {
+                try await Task.sleep(for: .milliseconds(1))
+            }
+        }
+
+        XCTAssertEqual(consumed, 100_000)
+        // The buffer plus the row being handed over.
+        XCTAssertLessThanOrEqual(maxAhead, bufferSize + 1)
+        await dbConnection.close()
+    }
+
+    /// Closing while a stream is reading leaves the session to the stream until it
+    /// ends, and later commands fail instead of touching the freed handle.
+    func testCloseDuringStreamWaitsForTheStream() async throws {
+        let dbConnection = try makeConnection()
+        var consumed = 0
+        do {
+            for try await _ in dbConnection.query(query: Self.largeQuery, bufferSize: 8) {
+                consumed += 1
+                if consumed == 10 {
+                    await dbConnection.close()
+                }
+            }
+        } catch TDSConnectionError.queryExecutionFailed {
+            // The close cancelled the query.
+        }
+        XCTAssertGreaterThanOrEqual(consumed, 10)
+        do {
+            _ = try await dbConnection.execute(queryString: "SELECT 1")
+            XCTFail("Expected the closed connection to refuse commands")
+        } catch TDSConnectionError.notConnected {
+        }
+    }
+
+    func testConfigurationSetsDefaultBufferSize() async throws {
+        var configuration = ConnectionConfiguration(
+            host: server,
+            port: Int(port) ?? 1433,
+            username: username,
+            password: password,
+            database: database
+        )
+        configuration.streamBufferSize = 8
+        let dbConnection = try TDSConnection(configuration: configuration)
+        XCTAssertEqual(dbConnection.streamBufferSize, 8)
+
+        var count = 0
+        for try await _ in dbConnection.query(query: "SELECT * FROM \(testTable)") {
+            count += 1
+        }
+        XCTAssertEqual(count, 2)
+        await dbConnection.close()
+    }
+}
+
+private final class Fetched: Sendable {
+    private let count = Mutex(0)
+
+    var value: Int { count.withLock { $0 } }
+
+    func increment() {
+        count.withLock { $0 += 1 }
+    }
+}
+
+#endif
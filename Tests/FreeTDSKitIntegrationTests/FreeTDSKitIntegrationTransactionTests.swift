@@ -0,0 +1,206 @@
+import XCTest
+@testable import FreeTDSKit
+
+#if !INTEGRATION_TESTS
+
+final class FreeTDSKitIntegrationTransactionTests: FreeTDSKitIntegrationTestCase {
+
+    private struct Abort: Error {}
+
+    private let table = "##TransactionTest"
+
+    private func makeTableConnection() async throws -> TDSConnection {
+        let dbConnection = try makeConnection()
+        _ = try await dbConnection.execute(queryString: """
+            IF OBJECT_ID('tempdb..\(table)') IS NOT NULL DROP TABLE \(table);
+            CREATE TABLE \(table) (Id INT PRIMARY KEY);
+            """)
+        return dbConnection
+    }
+
+    private func ids(_ connection: TDSConnection) async throws -> [Int] {
+        try await connection.execute(queryString: "SELECT Id FROM \(table) ORDER BY Id")
+            .rows.compactMap { $0["Id"]?.int }
+    }
+
+    func testCommitOnReturn() async throws {
+        let dbConnection = try await makeTableConnection()
+        try await dbConnection.withTransaction { tx in
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (2)")
+        }
+        let committed = try await ids(dbConnection)
+        XCTAssertEqual(committed, [1, 2])
+        let tranCount = try await dbConnection.execute(queryString: "SELECT @@TRANCOUNT AS N")
+        XCTAssertEqual(tranCount[0, "N"]?.int, 0)
+        await dbConnection.close()
+    }
+
+    func testRollbackOnThrow() async throws {
+        let dbConnection = try await makeTableConnection()
+        do {
+            try await dbConnection.withTransaction { tx in
+                _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+                throw Abort()
+            }
+            XCTFail("Expected the transaction body to throw")
+        } catch is Abort {
+        }
+        let remaining = try await ids(dbConnection)
+        XCTAssertEqual(remaining, [])
+        await dbConnection.close()
+    }
+
+    func testCommitAfterLastStatement() async throws {
+        let dbConnection = try await makeTableConnection()
+        try await dbConnection.withTransaction(isolationLevel: .serializable) { tx in
+            try await tx.commit(after: "INSERT INTO \(table) VALUES (7)")
+            XCTAssertTrue(tx.isFinished)
+        }
+        let committed = try await ids(dbConnection)
+        XCTAssertEqual(committed, [7])
+        // The isolation level does not outlive the transaction.
+        let level = try await dbConnection.execute(queryString: """
+            SELECT transaction_isolation_level AS Level
+            FROM sys.dm_exec_sessions WHERE session_id = @@SPID
+            """)
+        XCTAssertEqual(level[0, "Level"]?.int, 2)
+        await dbConnection.close()
+    }
+
+    func testFailedCommitAfterRollsBack() async throws {
+        let dbConnection = try await makeTableConnection()
+        do {
+            try await dbConnection.withTransaction { tx in
+                _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+                // Duplicate key.
+                try await tx.commit(after: "INSERT INTO \(table) VALUES (1)")
+            }
+            XCTFail("Expected a primary key violation")
+        } catch TDSConnectionError.queryExecutionFailed {
+        }
+        let remaining = try await ids(dbConnection)
+        XCTAssertEqual(remaining, [])
+        await dbConnection.close()
+    }
+
+    func testSavepointRollsBackPartOfTransaction() async throws {
+        let dbConnection = try await makeTableConnection()
+        try await dbConnection.withTransaction { tx in
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+            do {
+                try await tx.withSavepoint("second") {
+                    _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (2)")
+                    throw Abort()
+                }
+            } catch is Abort {
+            }
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (3)")
+        }
+        let committed = try await ids(dbConnection)
+        XCTAssertEqual(committed, [1, 3])
+        await dbConnection.close()
+    }
+
+    func testSavepointRollbackBeforeCommitIsKept() async throws {
+        let dbConnection = try makeConnection()
+        let marker = "Savepoint \(UUID().uuidString)"
+        try await dbConnection.withTransaction { tx in
+            _ = try await tx.execute(queryString: "SELECT 1 AS Started")
+            do {
+                try await tx.withSavepoint("insert") {
+                    _ = try await tx.execute(
+                        queryString: "INSERT INTO UpdateTableTest (Text) VALUES ('\(marker)')"
+                    )
+                    throw Abort()
+                }
+            } catch is Abort {
+            }
+            // The rollback to the savepoint is still queued when the commit is sent.
+        }
+        let rows = try await dbConnection.execute(
+            queryString: "SELECT COUNT(*) AS N FROM UpdateTableTest WHERE Text = '\(marker)'"
+        )
+        XCTAssertEqual(rows[0, "N"]?.int, 0)
+        await dbConnection.close()
+    }
+
+    func testFailedFirstStatementStillBeginsTheTransaction() async throws {
+        let dbConnection = try await makeTableConnection()
+        do {
+            try await dbConnection.withTransaction { tx in
+                do {
+                    try await tx.withSavepoint("first") {
+                        // Fails to compile, so the BEGIN TRANSACTION sent with it never runs.
+                        _ = try await tx.execute(queryString: "SELECT NoSuchColumn FROM \(table)")
+                    }
+                    XCTFail("Expected an invalid column error")
+                } catch TDSConnectionError.queryExecutionFailed {
+                }
+                _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+                let depth = try await tx.execute(queryString: "SELECT @@TRANCOUNT AS N")
+                XCTAssertEqual(depth[0, "N"]?.int, 1)
+                throw Abort()
+            }
+            XCTFail("Expected the transaction body to throw")
+        } catch is Abort {
+        }
+        let remaining = try await ids(dbConnection)
+        XCTAssertEqual(remaining, [])
+        await dbConnection.close()
+    }
+
+    func testStatementsFailOnceTheServerRollsBack() async throws {
+        let dbConnection = try await makeTableConnection()
+        do {
+            try await dbConnection.withTransaction { tx in
+                _ = try await tx.execute(queryString: "SET XACT_ABORT ON; INSERT INTO \(table) VALUES (1)")
+                do {
+                    // Duplicate key; XACT_ABORT rolls the whole transaction back.
+                    _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+                    XCTFail("Expected a primary key violation")
+                } catch TDSConnectionError.queryExecutionFailed {
+                }
+                _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (2)")
+            }
+            XCTFail("Expected the transaction to fail")
+        } catch TDSConnectionError.queryExecutionFailed {
+        }
+        let remaining = try await ids(dbConnection)
+        XCTAssertEqual(remaining, [])
+        await dbConnection.close()
+    }
+
+    func testIsolationLevelIsRestoredAfterTransaction() async throws {
+        let dbConnection = try await makeTableConnection()
+        _ = try await dbConnection.execute(queryString: "SET TRANSACTION ISOLATION LEVEL SERIALIZABLE")
+        try await dbConnection.withTransaction(isolationLevel: .readUncommitted) { tx in
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+        }
+        let level = try await dbConnection.execute(queryString: """
+            SELECT CAST(transaction_isolation_level AS INT) AS Level
+            FROM sys.dm_exec_sessions WHERE session_id = @@SPID
+            """)
+        XCTAssertEqual(level[0, "Level"]?.int, 4)
+        await dbConnection.close()
+    }
+
+    func testOtherCommandsWaitForTransaction() async throws {
+        let dbConnection = try await makeTableConnection()
+        let outside = try await dbConnection.withTransaction { tx in
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (1)")
+            let outside = Task {
+                try await dbConnection.execute(queryString: "SELECT @@TRANCOUNT AS N")
+            }
+            try await Task.sleep(for: .milliseconds(100))
+            _ = try await tx.execute(queryString: "INSERT INTO \(table) VALUES (2)")
+            return outside
+        }
+        // Queued behind the transaction, so it ran after the commit.
+        let tranCount = try await outside.value
+        XCTAssertEqual(tranCount[0, "N"]?.int, 0)
+        await dbConnection.close()
+    }
+}
+
+#endif
@@ -94,3 +94,20 @@ BEGIN
     );
 END
 GO
+
+-- Stored procedure used by the RPC call tests: one result set, two output parameters
+-- and a return status.
+CREATE OR ALTER PROCEDURE dbo.ProcedureCallTest
+    @Input INT,
+    @Label NVARCHAR(50),
+    @Doubled INT OUTPUT,
+    @Echo NVARCHAR(50) OUTPUT
+AS
+BEGIN
+    SET NOCOUNT ON;
+    SELECT Id, VarCharColumn FROM dbo.DataTypeTest WHERE Id <= @Input ORDER BY Id;
+    SET @Doubled = @Input * 2;
+    SET @Echo = @Label;
+    RETURN 7;
+END
+GO
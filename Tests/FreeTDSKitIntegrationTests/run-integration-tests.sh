@@ -92,7 +92,7 @@ if sqlcmd_run -d master -Q "SET NOCOUNT ON; SELECT name FROM sys.databases WHERE
 fi
 
 SCHEMA_READY=false
-if [ "$DB_EXISTS" = true ] && sqlcmd_run -d "$FREETDSKIT_SQL_DB" -Q "SET NOCOUNT ON; SELECT CASE WHEN OBJECT_ID(N'dbo.DataTypeTest', N'U') IS NOT NULL AND OBJECT_ID(N'dbo.UpdateTableTest', N'U') IS NOT NULL THEN 1 ELSE 0 END" -h -1 | grep -q "^1$"; then
+if [ "$DB_EXISTS" = true ] && sqlcmd_run -d "$FREETDSKIT_SQL_DB" -Q "SET NOCOUNT ON; SELECT CASE WHEN OBJECT_ID(N'dbo.DataTypeTest', N'U') IS NOT NULL AND OBJECT_ID(N'dbo.UpdateTableTest', N'U') IS NOT NULL AND OBJECT_ID(N'dbo.ProcedureCallTest', N'P') IS NOT NULL THEN 1 ELSE 0 END" -h -1 | grep -q "^1$"; then
     SCHEMA_READY=true
 fi
 
@@ -0,0 +1,148 @@
+//
+//  ArrowIPCWriterTests.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Arrow IPC Writer Tests") struct ArrowIPCWriterTests {
+
+    private let result = SQLResult(
+        columns: ["Id", "Name", "Price", "Payload"],
+        rows: [
+            ["Id": .integer(1), "Name": .varchar("one"), "Price": .money(Decimal(string: "1.25")!),
+             "Payload": .varbinary(Data([0x00, 0x01]))],
+            ["Id": .integer(2), "Name": .null, "Price": .money(Decimal(string: "-3.5")!),
+             "Payload": .null],
+        ],
+        affectedRows: 2
+    )
+
+    @Test
+    func fileFormatHasMagicAndFooter() {
+        let data = [UInt8](result.arrowIPCData(format: .file))
+        #expect(Array(data.prefix(6)) == Array("ARROW1".utf8))
+        #expect(Array(data.suffix(6)) == Array("ARROW1".utf8))
+
+        let footerLength = data[data.count - 10..<data.count - 6].enumerated().reduce(0) {
+            $0 | Int($1.element) << ($1.offset * 8)
+        }
+        #expect(footerLength > 0)
+        #expect(footerLength < data.count)
+    }
+
+    @Test
+    func streamFormatStartsWithSchemaAndEndsWithEOS() {
+        let data = [UInt8](result.arrowIPCData(format: .stream, batchSize: 1))
+        #expect(Array(data.prefix(4)) == [0xFF, 0xFF, 0xFF, 0xFF])
+        #expect(Array(data.suffix(8)) == [0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0])
+        #expect(data.count % 8 == 0)
+    }
+
+    @Test
+    func typesAreInferredFromColumnValues() {
+        #expect(ArrowType(inferringFrom: [.null, .integer(4)]) == .int(bitWidth: 32, signed: true))
+        #expect(ArrowType(inferringFrom: [.money(1)]) == .decimal128(precision: 38, scale: 4))
+        #expect(ArrowType(inferringFrom: [.decimal(Decimal(string: "1.234567")!)])
+                == .decimal128(precision: 38, scale: 6))
+        #expect(ArrowType(inferringFrom: [.varbinary(Data())]) == .binary)
+        #expect(ArrowType(inferringFrom: [.null]) == .utf8)
+    }
+
+    @Test
+    func utf8ColumnBuildsOffsetsAndValidity() {
+        let encoded = ArrowEncodedColumn([.varchar("ab"), .null, .varchar("c")], as: .utf8)
+        #expect(encoded.nullCount == 1)
+        #expect(encoded.buffers[0] == [0b101])
+        #expect(encoded.buffers[1] == [0, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0])
+        #expect(encoded.buffers[2] == Array("abc".utf8))
+    }
+
+    @Test
+    func decimalsScaleToInt128() {
+        #expect(Decimal(string: "1.25")!.scaledInt128(scale: 4) == 12_500)
+        #expect(Decimal(string: "-3.5")!.scaledInt128(scale: 2) == -350)
+        #expect(Decimal(string: "12345678901234567890.12")!.scaledInt128(scale: 2)
+                == Int128("1234567890123456789012"))
+    }
+
+    @Test
+    func datesMapToDaysSinceEpoch() {
+        #expect(TDSDate(day: 1, month: 1, year: 1970).daysSinceUnixEpoch == 0)
+        #expect(TDSDate(day: 28, month: 12, year: 2024).daysSinceUnixEpoch == 20_085)
+        #expect(TDSDate(day: 1, month: 1, year: 1753).daysSinceUnixEpoch == -79_257)
+    }
+
+    @Test
+    func columnBuilderReadsFetchedCells() {
+        let columns = [
+            ResultSchema.Column(name: "Id", typeCode: SYBINT4),
+            ResultSchema.Column(name: "Price", typeCode: SYBDECIMAL, precision: 10, scale: 3),
+            ResultSchema.Column(name: "At", typeCode: SYBDATETIME),
+            ResultSchema.Column(name: "Name", typeCode: SYBVARCHAR),
+        ]
+        var builders = columns.map { ArrowColumnBuilder(column: $0, encoding: .utf8, capacity: 2) }
+        let rows: [[String?]] = [
+            ["42", "-12.3", "2024-12-28 14:45:30.0030000", "ab"],
+            [nil, "0.0005", nil, "c"],
+        ]
+        for cells in rows {
+            withRow(zip(columns, cells).map { ($0.typeCode, $1) }) { row in
+                for j in builders.indices { builders[j].append(row, at: j) }
+            }
+        }
+        let encoded = builders.indices.map { builders[$0].finish() }
+
+        #expect(encoded[0].nullCount == 1)
+        #expect(encoded[0].buffers[0] == [0b01])
+        #expect(encoded[0].buffers[1] == [42, 0, 0, 0, 0, 0, 0, 0])
+        // Scale 3: -12.3 is -12300 and 0.0005 rounds to 1.
+        #expect(encoded[1].buffers[1] == littleEndian(Int128(-12_300)) + littleEndian(Int128(1)))
+        #expect(encoded[2].buffers[1] == littleEndian(Int64(1_735_397_130_003_000)) + littleEndian(Int64(0)))
+        #expect(encoded[3].nullCount == 0)
+        #expect(encoded[3].buffers[0].isEmpty)
+        #expect(encoded[3].buffers[1] == [0, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0])
+        #expect(encoded[3].buffers[2] == Array("abc".utf8))
+    }
+
+    /// Run `body` on a row filled the way the shim fills one, with cells as text.
+    /// A `nil` cell is NULL.
+    private func withRow(_ cells: [(type: Int, text: String?)], _ body: (RowData) -> Void) {
+        var values = cells.map { $0.text.flatMap { strdup($0) } }
+        defer { values.forEach { free($0) } }
+        var types = cells.map { Int32($0.type) }
+        var lengths = cells.map { Int32($0.text?.utf8.count ?? 0) }
+        var bitmap = [UInt8](repeating: 0, count: (cells.count + 7) / 8)
+        for (j, cell) in cells.enumerated() where cell.text == nil {
+            bitmap[j >> 3] |= 1 << UInt8(j & 7)
+        }
+        values.withUnsafeMutableBufferPointer { valuesPtr in
+            types.withUnsafeMutableBufferPointer { typesPtr in
+                lengths.withUnsafeMutableBufferPointer { lengthsPtr in
+                    bitmap.withUnsafeMutableBufferPointer { bitmapPtr in
+                        body(
+                            RowData(
+                                columnNames: nil,
+                                columnValues: valuesPtr.baseAddress,
+                                columnTypes: typesPtr.baseAddress,
+                                columnLengths: lengthsPtr.baseAddress,
+                                nullBitmap: bitmapPtr.baseAddress,
+                                columnCount: Int32(cells.count)
+                            )
+                        )
+                    }
+                }
+            }
+        }
+    }
+
+    private func littleEndian<T: FixedWidthInteger>(_ value: T) -> [UInt8] {
+        var bytes: [UInt8] = []
+        appendLittleEndian(value, to: &bytes)
+        return bytes
+    }
+}
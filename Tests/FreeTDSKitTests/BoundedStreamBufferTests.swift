@@ -0,0 +1,148 @@
+//
+//  BoundedStreamBufferTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Synchronization
+import Testing
+
+@testable import FreeTDSKit
+
+private final class Counter: Sendable {
+    private let storage = Mutex(0)
+
+    var value: Int { storage.withLock { $0 } }
+
+    func increment() {
+        storage.withLock { $0 += 1 }
+    }
+}
+
+@Suite("Bounded Stream Buffer Tests") struct BoundedStreamBufferTests {
+
+    @Test
+    func deliversElementsInOrder() async throws {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 3)
+        Task {
+            for i in 0..<20 {
+                _ = await buffer.send(i)
+            }
+            buffer.finish()
+        }
+        var received: [Int] = []
+        for try await value in buffer.stream {
+            received.append(value)
+        }
+        #expect(received == Array(0..<20))
+    }
+
+    @Test
+    func producerSuspendsWhenFull() async throws {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 2)
+        let sent = Counter()
+        let stream = buffer.stream
+        Task {
+            for i in 0..<5 {
+                guard await buffer.send(i) else { return }
+                sent.increment()
+            }
+            buffer.finish()
+        }
+        try await Task.sleep(for: .milliseconds(100))
+        #expect(sent.value == 2)
+        #expect(buffer.count == 2)
+
+        var received: [Int] = []
+        for try await value in stream {
+            received.append(value)
+        }
+        #expect(received == [0, 1, 2, 3, 4])
+        #expect(sent.value == 5)
+    }
+
+    @Test
+    func severalProducersShareTheBuffer() async throws {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 2)
+        let stream = buffer.stream
+        Task {
+            await withTaskGroup(of: Void.self) { group in
+                for producer in 0..<4 {
+                    group.addTask {
+                        for i in 0..<25 {
+                            _ = await buffer.send(producer * 100 + i)
+                        }
+                    }
+                }
+            }
+            buffer.finish()
+        }
+        var received: [Int] = []
+        for try await value in stream {
+            #expect(buffer.count <= 2)
+            received.append(value)
+        }
+        #expect(received.count == 100)
+        #expect(Set(received).count == 100)
+    }
+
+    @Test
+    func failureFollowsBufferedElements() async {
+        struct Failure: Error {}
+        let buffer = BoundedStreamBuffer<Int>(capacity: 4)
+        _ = await buffer.send(1)
+        _ = await buffer.send(2)
+        buffer.finish(throwing: Failure())
+
+        var received: [Int] = []
+        await #expect(throws: Failure.self) {
+            for try await value in buffer.stream {
+                received.append(value)
+            }
+        }
+        #expect(received == [1, 2])
+    }
+
+    @Test
+    func droppingStreamCancelsProducer() async {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 1)
+        let cancelled = Counter()
+        buffer.onCancel { cancelled.increment() }
+        do {
+            var iterator = buffer.stream.makeAsyncIterator()
+            _ = await buffer.send(1)
+            _ = try? await iterator.next()
+        }
+        #expect(cancelled.value == 1)
+        #expect(buffer.isCancelled)
+        #expect(await buffer.send(2) == false)
+    }
+
+    @Test
+    func cancellingConsumerEndsIteration() async throws {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 1)
+        let cancelled = Counter()
+        buffer.onCancel { cancelled.increment() }
+        let stream = buffer.stream
+        let consumer = Task {
+            var count = 0
+            for try await _ in stream { count += 1 }
+            return count
+        }
+        try await Task.sleep(for: .milliseconds(50))
+        consumer.cancel()
+        #expect(try await consumer.value == 0)
+        #expect(cancelled.value == 1)
+    }
+
+    @Test
+    func finishedProducerIsNotCancelled() async throws {
+        let buffer = BoundedStreamBuffer<Int>(capacity: 2)
+        let cancelled = Counter()
+        buffer.onCancel { cancelled.increment() }
+        _ = await buffer.send(1)
+        buffer.finish()
+        for try await _ in buffer.stream {}
+        #expect(cancelled.value == 0)
+    }
+}
@@ -0,0 +1,58 @@
+//
+//  PartitionedScanTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Partitioned Scan Tests") struct PartitionedScanTests {
+
+    @Test
+    func splitPointsDivideRangeEvenly() {
+        #expect(TDSConnectionPool.splitPoints(lower: 1, upper: 100, partitions: 4) == [26, 51, 76])
+        #expect(TDSConnectionPool.splitPoints(lower: -10, upper: 9, partitions: 2) == [0])
+    }
+
+    @Test
+    func splitPointsHandleNarrowAndExtremeRanges() {
+        #expect(TDSConnectionPool.splitPoints(lower: 5, upper: 5, partitions: 8) == [])
+        #expect(TDSConnectionPool.splitPoints(lower: 1, upper: 3, partitions: 8) == [2, 3])
+        let wide = TDSConnectionPool.splitPoints(lower: .min, upper: .max, partitions: 2)
+        #expect(wide == [0])
+    }
+
+    @Test
+    func predicatesAreHalfOpenAndCoverEveryKey() {
+        #expect(
+            TDSConnectionPool.partitionPredicates(keyColumn: "Id", splitPoints: [10, 20])
+                == ["Id < 10", "Id >= 10 AND Id < 20", "Id >= 20"]
+        )
+        #expect(
+            TDSConnectionPool.partitionPredicates(keyColumn: "Id", splitPoints: [])
+                == ["Id IS NOT NULL"]
+        )
+    }
+
+    @Test
+    func splitKeysAcceptEveryIntegerType() throws {
+        #expect(try TDSConnectionPool.splitKey(.tinyInt(7), scale: 0, column: "K") == 7)
+        #expect(try TDSConnectionPool.splitKey(.smallInt(-7), scale: 0, column: "K") == -7)
+        #expect(try TDSConnectionPool.splitKey(.integer(70_000), scale: 0, column: "K") == 70_000)
+        #expect(try TDSConnectionPool.splitKey(.bigInt(.max), scale: 0, column: "K") == .max)
+        #expect(try TDSConnectionPool.splitKey(.decimal(Decimal(string: "123456789012")!), scale: 0, column: "K") == 123_456_789_012)
+        #expect(try TDSConnectionPool.splitKey(.null, scale: 0, column: "K") == nil)
+    }
+
+    @Test
+    func nonIntegerSplitKeysThrow() {
+        #expect(throws: TDSConnectionError.self) {
+            try TDSConnectionPool.splitKey(.varchar("a"), scale: 0, column: "K")
+        }
+        #expect(throws: TDSConnectionError.self) {
+            try TDSConnectionPool.splitKey(.decimal(Decimal(string: "1.5")!), scale: 1, column: "K")
+        }
+    }
+}
@@ -0,0 +1,58 @@
+//
+//  ProcedureParameterTests.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Procedure Parameter Tests") struct ProcedureParameterTests {
+
+    @Test
+    func integersAreSentNatively() {
+        let wire = ProcedureParameter.input("@Id", .integer(42)).wireValue
+        #expect(wire.type == Int32(SYBINT8))
+        #expect(wire.bytes == withUnsafeBytes(of: Int64(42)) { Array($0) })
+        #expect(wire.maxLength == -1)
+    }
+
+    @Test
+    func nullHasNoBytes() {
+        let wire = ProcedureParameter.output("@Out", .null).wireValue
+        #expect(wire.bytes == nil)
+        #expect(wire.maxLength == 8000)
+    }
+
+    @Test
+    func temporalValuesAreSentAsISOText() {
+        let value = SQLDataType.datetimeoffset(
+            TDSDateTimeOffset(
+                date: TDSDate(day: 28, month: 12, year: 2024),
+                time: TDSTime(hour: 12, minute: 34, second: 56),
+                fractionalSecond: 1_234_567,
+                offset: -480
+            )
+        )
+        let wire = ProcedureParameter.input("@At", value).wireValue
+        #expect(wire.type == Int32(SYBVARCHAR))
+        #expect(wire.bytes == Array("2024-12-28T12:34:56.1234567-08:00".utf8))
+    }
+
+    @Test
+    func unicodeStringsAreSentAsNVarChar() {
+        #expect(ProcedureParameter.input("@Label", .nvarchar("日本")).wireValue.type == Int32(SYBNVARCHAR))
+        #expect(ProcedureParameter.input("@Label", .nchar("日本")).wireValue.type == Int32(SYBNVARCHAR))
+        #expect(ProcedureParameter.input("@Label", .varchar("abc")).wireValue.type == Int32(SYBVARCHAR))
+    }
+
+    @Test
+    func namesGainAnAtPrefix() {
+        let names = TDSConnection.withRPCParameters([.input("Id", .integer(1)), .input("@Name", .varchar("x"))]) {
+            params in params.map { String(cString: $0.name) }
+        }
+        #expect(names == ["@Id", "@Name"])
+    }
+}
@@ -0,0 +1,56 @@
+//
+//  QueryStatisticsTests.swift
+//  FreeTDSKit
+//
+
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Query Statistics Tests") struct QueryStatisticsTests {
+
+    private static let messages: [(number: Int, text: String)] = [
+        (3613, "SQL Server parse and compile time: \n   CPU time = 15 ms, elapsed time = 21 ms."),
+        (3615, "Table 'Orders'. Scan count 1, logical reads 120, physical reads 3, page server reads 0, "
+            + "read-ahead reads 40, page server read-ahead reads 0, lob logical reads 2, lob physical reads 0, "
+            + "lob page server reads 0, lob read-ahead reads 0, lob page server read-ahead reads 0."),
+        (3615, "Table 'Worktable'. Scan count 0, logical reads 0, physical reads 0, read-ahead reads 0, "
+            + "lob logical reads 0, lob physical reads 0, lob read-ahead reads 0."),
+        (3612, " SQL Server Execution Times:\n   CPU time = 31 ms,  elapsed time = 45 ms."),
+        (3612, " SQL Server Execution Times:\n   CPU time = 0 ms,  elapsed time = 2 ms."),
+        (0, "Progress: 50%"),
+    ]
+
+    @Test
+    func parsesTableReads() {
+        let statistics = QueryStatistics(messages: Self.messages)
+        #expect(statistics.tables.map(\.table) == ["Orders", "Worktable"])
+        let orders = statistics.tables[0]
+        #expect(orders.scanCount == 1)
+        #expect(orders.logicalReads == 120)
+        #expect(orders.physicalReads == 3)
+        #expect(orders.readAheadReads == 40)
+        #expect(orders.lobLogicalReads == 2)
+        #expect(orders.counters["page server reads"] == 0)
+        #expect(statistics.logicalReads == 120)
+        #expect(statistics.physicalReads == 43)
+    }
+
+    @Test
+    func sumsTimes() {
+        let statistics = QueryStatistics(messages: Self.messages)
+        #expect(statistics.compileCPUTime == .milliseconds(15))
+        #expect(statistics.compileElapsedTime == .milliseconds(21))
+        #expect(statistics.executionCPUTime == .milliseconds(31))
+        #expect(statistics.executionElapsedTime == .milliseconds(47))
+        #expect(statistics.messages.count == Self.messages.count)
+    }
+
+    @Test
+    func tableNamesMayContainQuotes() {
+        let io = QueryStatistics.TableIO(message: "Table 'O'Brien'. Scan count 2, logical reads 5.")
+        #expect(io?.table == "O'Brien")
+        #expect(io?.logicalReads == 5)
+        #expect(QueryStatistics.TableIO(message: "Something else") == nil)
+    }
+}
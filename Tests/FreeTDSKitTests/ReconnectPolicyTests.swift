@@ -0,0 +1,41 @@
+//
+//  ReconnectPolicyTests.swift
+//  FreeTDSKit
+//
+
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Reconnect Policy Tests") struct ReconnectPolicyTests {
+
+    @Test
+    func firstAttemptIsImmediate() {
+        let policy = ReconnectPolicy()
+        #expect(policy.backoff(before: 0) == .zero)
+    }
+
+    @Test
+    func backoffGrowsByMultiplier() {
+        let policy = ReconnectPolicy(initialBackoff: .milliseconds(100), multiplier: 2)
+        #expect(policy.backoff(before: 1) == .milliseconds(100))
+        #expect(policy.backoff(before: 2) == .milliseconds(200))
+        #expect(policy.backoff(before: 3) == .milliseconds(400))
+    }
+
+    @Test
+    func backoffIsCappedAtMaximum() {
+        let policy = ReconnectPolicy(
+            initialBackoff: .milliseconds(100),
+            maxBackoff: .milliseconds(250),
+            multiplier: 2
+        )
+        #expect(policy.backoff(before: 3) == .milliseconds(250))
+        #expect(policy.backoff(before: 50) == .milliseconds(250))
+    }
+
+    @Test
+    func atLeastOneAttempt() {
+        #expect(ReconnectPolicy(maxAttempts: 0).maxAttempts == 1)
+    }
+}
@@ -0,0 +1,67 @@
+//
+//  ResultSchemaTests.swift
+//  FreeTDSKit
+//
+
+import CFreeTDS
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Result Schema Tests") struct ResultSchemaTests {
+
+    private let schema = ResultSchema(columns: [
+        .init(name: "Id", typeCode: SYBINT4, maxLength: 4, isNullable: false, isIdentity: true),
+        .init(name: "Price", typeCode: SYBDECIMAL, maxLength: 17, precision: 10, scale: 3),
+        .init(name: "Label", typeCode: SYBVARCHAR, maxLength: 50, isVariableLength: true),
+    ])
+
+    @Test
+    func looksUpColumnsByName() {
+        #expect(schema.names == ["Id", "Price", "Label"])
+        #expect(schema.index(of: "Price") == 1)
+        #expect(schema.index(of: "Missing") == nil)
+        #expect(schema["Id"]?.isIdentity == true)
+    }
+
+    @Test
+    func namesTypesWithTheirPrecision() {
+        #expect(schema.columns.map(\.typeName) == ["int", "decimal(10,3)", "varchar"])
+        #expect(ResultSchema.Column(name: "X", typeCode: 9999).typeName == "type 9999")
+    }
+
+    @Test
+    func fixesArrowTypesForEveryColumn() {
+        #expect(schema.columns.map(\.arrowType) == [
+            .int(bitWidth: 32, signed: true), .decimal128(precision: 10, scale: 3), .utf8,
+        ])
+        #expect(ResultSchema.Column(name: "M", typeCode: SYBMONEY).arrowType == .decimal128(precision: 19, scale: 4))
+        #expect(ResultSchema.Column(name: "B", typeCode: SYBBIT).arrowType == .bool)
+        #expect(ResultSchema.Column(name: "F", typeCode: SYBFLT8).arrowType == .double)
+        #expect(ResultSchema.Column(name: "D", typeCode: 40).arrowType == .date32)
+        #expect(ResultSchema.Column(name: "T", typeCode: SYBDATETIME).arrowType == .timestampMicros(timezone: nil))
+        #expect(ResultSchema.Column(name: "U", typeCode: 36).arrowType == .fixedSizeBinary(16))
+        #expect(ResultSchema.Column(name: "V", typeCode: SYBVARBINARY).arrowType == .binary)
+    }
+
+    @Test
+    func schemaTypesOverrideInferenceInArrowOutput() {
+        var result = SQLResult(
+            columns: ["Id", "Price", "Label"],
+            rows: [["Id": .null, "Price": .decimal(Decimal(string: "1.5")!), "Label": .varchar("a")]],
+            affectedRows: 1
+        )
+        result.schema = schema
+        var writer = ArrowIPCWriter(format: .stream)
+        var batch = ArrowColumnBatch(columnCount: 3, capacity: 1)
+        for (j, name) in result.columns.enumerated() {
+            batch.columns[j].append(result[0, name] ?? .null)
+        }
+        batch.rowCount = 1
+        batch.flush(into: &writer, names: result.columns, types: schema.columns.map(\.arrowType))
+        #expect(writer.fields?.map(\.type) == [
+            .int(bitWidth: 32, signed: true), .decimal128(precision: 10, scale: 3), .utf8,
+        ])
+    }
+}
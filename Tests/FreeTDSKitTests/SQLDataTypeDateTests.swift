@@ -115,6 +115,20 @@ import XCTest
         }
     }
 
+    @Test
+    func determineDateTimeWithMilliseconds() {
+        let cString: [CChar] = "2024-12-28 14:45:30.0030000".cString(using: .utf8)!
+        let sqlType = determineSQLType(cString, columnType: 61)
+
+        if case let .datetime(value) = sqlType {
+            #expect(value.second == 30)
+            #expect(value.fractionalSecond == 30_000)
+            #expect(value.microsecondsSinceEpoch == 1_735_397_130_003_000)
+        } else {
+            Issue.record("Expected SQLDataType.datetime")
+        }
+    }
+
     @Test
     func determineDateTime2() {
         let cString: [CChar] = "2024-12-28 14:45:30.123456".cString(
@@ -26,6 +26,31 @@ import XCTest
         }
     }
 
+    @Test("Test raw uniqueidentifier bytes", arguments: [
+        (
+            [0x7F, 0x42, 0x4E, 0x35, 0x42, 0xF0, 0x5B, 0x44,
+             0xA9, 0xF0, 0xE1, 0x95, 0x40, 0xE0, 0x36, 0xB9] as [UInt8],
+            "354E427F-F042-445B-A9F0-E19540E036B9"
+        ),
+        (
+            [0xFF, 0x19, 0x96, 0x6F, 0x86, 0x8B, 0x11, 0xD0,
+             0xB4, 0x2D, 0x00, 0xC0, 0x4F, 0xC9, 0x64, 0xFF] as [UInt8],
+            "6F9619FF-8B86-D011-B42D-00C04FC964FF"
+        ),
+        (
+            [UInt8](repeating: 0, count: 16),
+            "00000000-0000-0000-0000-000000000000"
+        ),
+    ])
+    func uniqueIdentifierFromRawBytes(bytes: [UInt8], expected: String) {
+        let raw = bytes.map { CChar(bitPattern: $0) }
+        let sqlType = determineSQLType(raw, length: raw.count, columnType: 36)
+        if case let .uniqueidentifier(value) = sqlType {
+            #expect(value == UUID(uuidString: expected))
+        } else {
+            Issue.record("Expected SQLDataType.uniqueidentifier")
+        }
+    }
 
     @Test
     func determineMoney() {
@@ -73,6 +98,90 @@ import XCTest
         }
     }
 
+    @Test("Test binary data with embedded zero bytes")
+    func binaryDataWithZeroBytes() {
+        let testData: [UInt8] = [0x01, 0x00, 0x02, 0x00]
+        let bytes = testData.map { CChar(bitPattern: $0) }
+        let sqlType = determineSQLType(bytes, length: bytes.count, columnType: SYBBINARY)
+        if case let .binary(value) = sqlType {
+            #expect(value == Data(testData))
+        } else {
+            Issue.record("Expected SQLDataType.binary")
+        }
+    }
+
+    @Test("Test explicit length bounds text values")
+    func explicitLengthText() {
+        let bytes: [CChar] = "héllo world".cString(using: .utf8)!
+        let sqlType = determineSQLType(bytes, length: 6, columnType: SYBVARCHAR)
+        if case let .varchar(value) = sqlType {
+            #expect(value == "héllo")
+        } else {
+            Issue.record("Expected SQLDataType.varchar")
+        }
+    }
+
+    @Test("Test NULL bitmap distinguishes NULL from empty values")
+    func nullBitmap() {
+        var empty: [CChar] = [0]
+        var bitmap: [UInt8] = [0b0000_0001]
+        var types: [Int32] = [Int32(SYBVARCHAR), Int32(SYBVARCHAR), Int32(SYBVARBINARY)]
+        var lengths: [Int32] = [0, 0, 0]
+        empty.withUnsafeMutableBufferPointer { emptyPtr in
+            var values: [UnsafeMutablePointer<CChar>?] = [nil, emptyPtr.baseAddress, emptyPtr.baseAddress]
+            bitmap.withUnsafeMutableBufferPointer { bitmapPtr in
+                types.withUnsafeMutableBufferPointer { typesPtr in
+                    lengths.withUnsafeMutableBufferPointer { lengthsPtr in
+                        values.withUnsafeMutableBufferPointer { valuesPtr in
+                            let row = RowData(
+                                columnNames: nil,
+                                columnValues: valuesPtr.baseAddress,
+                                columnTypes: typesPtr.baseAddress,
+                                columnLengths: lengthsPtr.baseAddress,
+                                nullBitmap: bitmapPtr.baseAddress,
+                                columnCount: 3
+                            )
+                            #expect(row.isNull(at: 0))
+                            #expect(!row.isNull(at: 1))
+                            guard case .null = row.value(at: 0) else {
+                                Issue.record("Expected SQLDataType.null")
+                                return
+                            }
+                            guard case .varchar("") = row.value(at: 1) else {
+                                Issue.record("Expected empty SQLDataType.varchar")
+                                return
+                            }
+                            guard case .binary(let data) = row.value(at: 2), data.isEmpty else {
+                                Issue.record("Expected empty SQLDataType.binary")
+                                return
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    @Test("Test text decoded in a non-UTF-8 client charset")
+    func latin1Text() {
+        let bytes: [CChar] = [0x63, 0x61, 0x66, CChar(bitPattern: 0xE9)]  // "café" in ISO-8859-1
+        let sqlType = determineSQLType(
+            bytes, length: bytes.count, columnType: SYBNVARCHAR, encoding: .isoLatin1)
+        if case let .nvarchar(value) = sqlType {
+            #expect(value == "café")
+        } else {
+            Issue.record("Expected SQLDataType.nvarchar")
+        }
+    }
+
+    @Test("Test charset names map to string encodings")
+    func charsetEncodings() {
+        #expect(String.Encoding(tdsCharset: "UTF-8") == .utf8)
+        #expect(String.Encoding(tdsCharset: "iso-8859-1") == .isoLatin1)
+        #expect(String.Encoding(tdsCharset: "CP1252") == .windowsCP1252)
+        #expect(String.Encoding(tdsCharset: nil) == .utf8)
+    }
+
     @Test("Test decimal precision")
     func decimalPrecision() {
         let cString: [CChar] = "123456.789".cString(using: .utf8)!
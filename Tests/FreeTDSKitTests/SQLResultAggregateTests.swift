@@ -0,0 +1,112 @@
+//
+//  SQLResultAggregateTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("SQLResult Aggregate Tests") struct SQLResultAggregateTests {
+
+    /// 21 rows, so there are two whole SIMD blocks and a tail. Every third row is NULL.
+    private let result = SQLResult(
+        columns: ["N", "Price", "Label"],
+        rows: (0..<21).map { i -> [String: SQLDataType] in
+            i % 3 == 0
+                ? ["N": .null, "Price": .null, "Label": .varchar("x")]
+                : ["N": .integer(i - 10), "Price": .money(Decimal(i) + Decimal(string: "0.0125")!),
+                   "Label": .varchar("x")]
+        },
+        affectedRows: 21
+    )
+
+    private var expected: [Int] {
+        (0..<21).filter { $0 % 3 != 0 }.map { $0 - 10 }
+    }
+
+    @Test
+    func integerAggregatesSkipNulls() {
+        let column = result.integerColumn("N")
+        #expect(column.count == 21)
+        #expect(column.nonNullCount == 14)
+        #expect(column[0] == nil)
+        #expect(column[1] == -9)
+        #expect(column.sum() == Int64(expected.reduce(0, +)))
+        #expect(column.min() == Int64(expected.min()!))
+        #expect(column.max() == Int64(expected.max()!))
+        #expect(column.mean() == Double(expected.reduce(0, +)) / 14)
+    }
+
+    @Test
+    func doubleAggregatesConvertNumericCells() {
+        let column = result.doubleColumn("N")
+        #expect(column.sum() == Double(expected.reduce(0, +)))
+        #expect(column.min() == -9)
+        #expect(column.max() == 10)
+        #expect(result.doubleColumn("Label").nonNullCount == 0)
+        #expect(result.doubleColumn("Label").mean() == nil)
+        #expect(result.doubleColumn("Label").sum() == 0)
+    }
+
+    @Test
+    func wholeBlocksWithoutNullsUseTheFastPath() {
+        let dense = SQLResult(
+            columns: ["V"],
+            rows: (0..<16).map { ["V": .double(Double($0) * 0.5)] },
+            affectedRows: 16
+        )
+        let column = dense.doubleColumn("V")
+        #expect(column.validity.isEmpty)
+        #expect(column.sum() == 60)
+        #expect(column.min() == 0)
+        #expect(column.max() == 7.5)
+    }
+
+    @Test
+    func integerSumReportsOverflow() {
+        let big = SQLResult(
+            columns: ["V"],
+            rows: Array(repeating: ["V": .bigInt(Int64.max / 2)], count: 9),
+            affectedRows: 9
+        )
+        #expect(big.integerColumn("V").sum() == nil)
+        #expect(big.integerColumn("V").mean() == Double(Int64.max / 2))
+    }
+
+    @Test
+    func integerSumDoesNotDependOnRowOrder() {
+        func sum(_ values: [Int64]) -> Int64? {
+            SQLResult(
+                columns: ["V"],
+                rows: values.map { ["V": .bigInt($0)] },
+                affectedRows: values.count
+            ).integerColumn("V").sum()
+        }
+        // Lane 0 overflows on Int64.max + 1, but the total is 1.
+        let lanes: [Int64] = [Int64.max] + Array(repeating: 0, count: 7) + [1] + Array(repeating: 0, count: 7)
+        #expect(sum(lanes + [-Int64.max]) == 1)
+        #expect(sum([-Int64.max] + lanes) == 1)
+        // Likewise in the scalar tail.
+        #expect(sum([Int64.max, 1, -Int64.max]) == 1)
+        #expect(sum([Int64.min, -1, Int64.max, 1]) == -1)
+    }
+
+    @Test
+    func decimalSumsAreExact() throws {
+        let column = try #require(result.scaledDecimalColumn("Price"))
+        #expect(column.scale == 4)
+        #expect(column.units[1] == 10_125)
+        let total = expected.reduce(Decimal(0)) { $0 + Decimal($1 + 10) + Decimal(string: "0.0125")! }
+        #expect(column.sum() == total)
+        #expect(column.min() == Decimal(string: "1.0125"))
+        #expect(column.max() == Decimal(string: "20.0125"))
+    }
+
+    @Test
+    func decimalColumnRejectsValuesFinerThanTheScale() {
+        #expect(result.scaledDecimalColumn("Price", scale: 2) == nil)
+        #expect(result.scaledDecimalColumn("Price", scale: 6)?.units[1] == 1_012_500)
+    }
+}
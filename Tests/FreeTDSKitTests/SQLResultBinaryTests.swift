@@ -0,0 +1,124 @@
+//
+//  SQLResultBinaryTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("SQLResult Binary Format Tests") struct SQLResultBinaryTests {
+
+    private static let date = TDSDate(day: 5, month: 1, year: 2024)
+    private static let time = TDSTime(hour: 23, minute: 59, second: 58)
+    private static let dateTime = TDSDateTime(date: date, hour: 13, minute: 4, second: 5, fractionalSecond: 1_234_567)
+
+    /// One of every `SQLDataType` case, with edge values where they matter.
+    private static let everyCase: [SQLDataType] = [
+        .uniqueidentifier(UUID(uuidString: "6F9619FF-8B86-D011-B42D-00C04FC964FF")!),
+        .char("fixed  "),
+        .varchar(""),
+        .nchar("ünïcødé"),
+        .nvarchar("emoji 🚀"),
+        .text(String(repeating: "long ", count: 1_000)),
+        .numeric(Decimal(string: "-12345678901234567890.123456789")!),
+        .decimal(Decimal(string: "0.0000000001")!),
+        .money(.nan),
+        .integer(.min),
+        .smallInt(.max),
+        .bigInt(.min),
+        .tinyInt(255),
+        .float(-.infinity),
+        .real(.leastNonzeroMagnitude),
+        .double(.pi),
+        .date(date),
+        .time(time),
+        .datetime(dateTime),
+        .smalldatetime(TDSDateTime(date: date, hour: 0, minute: 0, second: 0, fractionalSecond: 0)),
+        .datetime2(TDSDateTime(date: TDSDate(day: 31, month: 12, year: 9999), hour: 1, minute: 2, second: 3, fractionalSecond: 9_999_999)),
+        .datetimeoffset(TDSDateTimeOffset(date: date, time: time, fractionalSecond: 42, offset: -330)),
+        .bit(true),
+        .binary(Data([0x00, 0xFF, 0x10])),
+        .varbinary(Data()),
+        .spatial(SQLDataType.WKTString(value: "POINT (1 2)")),
+        .null,
+    ]
+
+    @Test
+    func everyCaseRoundTrips() throws {
+        let columns = Self.everyCase.indices.map { "C\($0)" }
+        var row: [String: SQLDataType] = [:]
+        for (name, value) in zip(columns, Self.everyCase) { row[name] = value }
+        let result = SQLResult(columns: columns, rows: [row, row], affectedRows: 7)
+
+        let encoded = result.binaryEncoded()
+        let decoded = try SQLResult(binaryEncoded: encoded)
+        #expect(decoded.columns == columns)
+        #expect(decoded.affectedRows == 7)
+        #expect(decoded.count == 2)
+        // Byte-identical re-encoding means every case, payload and tag survived.
+        #expect(decoded.binaryEncoded() == encoded)
+        for (index, name) in columns.enumerated() {
+            #expect(BinaryValueTag(decoded[1, name]!) == BinaryValueTag(Self.everyCase[index]))
+        }
+
+        #expect(decoded[0, "C6"]?.decimal == Decimal(string: "-12345678901234567890.123456789"))
+        #expect(decoded[0, "C8"]?.decimal?.isNaN == true)
+        #expect(decoded[0, "C9"]?.int == Int.min)
+        #expect(decoded[0, "C16"]?.date == Self.date)
+        #expect(decoded[0, "C18"]?.dateTime == Self.dateTime)
+        #expect(decoded[0, "C21"]?.dateTimeOffset?.offset == -330)
+        #expect(decoded[0, "C4"]?.string == "emoji 🚀")
+    }
+
+    @Test
+    func uniformColumnsKeepNullsAndMissingCells() throws {
+        let result = SQLResult(
+            columns: ["Id", "Name", "Mixed"],
+            rows: [
+                ["Id": .integer(1), "Name": .nvarchar("a"), "Mixed": .integer(1)],
+                ["Id": .integer(2), "Name": .null, "Mixed": .varchar("x")],
+                ["Id": .integer(3), "Mixed": .null],
+            ],
+            affectedRows: 3
+        )
+        let decoded = try SQLResult(binaryEncoded: result.binaryEncoded())
+        #expect(decoded.compactMap { $0["Id"]?.int } == [1, 2, 3])
+        guard case .null = decoded[1, "Name"] else {
+            Issue.record("Expected SQLDataType.null")
+            return
+        }
+        #expect(decoded[2, "Name"] == nil)
+        #expect(decoded[1, "Mixed"]?.string == "x")
+    }
+
+    @Test
+    func emptyResultRoundTrips() throws {
+        let decoded = try SQLResult(binaryEncoded: SQLResult(columns: [], rows: [], affectedRows: 12).binaryEncoded())
+        #expect(decoded.columns.isEmpty)
+        #expect(decoded.count == 0)
+        #expect(decoded.affectedRows == 12)
+    }
+
+    @Test
+    func rejectsMalformedData() {
+        let encoded = SQLResult(
+            columns: ["Id"],
+            rows: [["Id": .varchar("value")]],
+            affectedRows: 1
+        ).binaryEncoded()
+
+        #expect(throws: BinaryDecodingError.self) {
+            try SQLResult(binaryEncoded: encoded.dropLast())
+        }
+        #expect(throws: BinaryDecodingError.self) {
+            try SQLResult(binaryEncoded: Data("JSON".utf8) + encoded.dropFirst(4))
+        }
+        var newer = encoded
+        newer[4] = SQLResult.binaryFormatVersion + 1
+        #expect(throws: BinaryDecodingError.self) {
+            try SQLResult(binaryEncoded: newer)
+        }
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  SQLResultCacheTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("SQLResultCache Tests") struct SQLResultCacheTests {
+
+    private func makeResult(_ name: String, rows: Int = 1) -> SQLResult {
+        SQLResult(
+            columns: ["Id", "Name"],
+            rows: (0..<rows).map { ["Id": .integer($0), "Name": .varchar(name)] },
+            affectedRows: rows
+        )
+    }
+
+    @Test
+    func keyNormalizesWhitespaceOutsideLiterals() {
+        let a = SQLResultCache.Key(sql: "SELECT  *\n FROM   Currency;")
+        let b = SQLResultCache.Key(sql: "SELECT * FROM Currency")
+        let c = SQLResultCache.Key(sql: "SELECT * FROM Currency WHERE Code = 'U  S'")
+        #expect(a == b)
+        #expect(c.sql.hasSuffix("'U  S'"))
+    }
+
+    @Test
+    func keyKeepsTheLineThatEndsALineComment() {
+        let filtered = SQLResultCache.Key(sql: "SELECT * FROM t -- x\nWHERE id = 1")
+        let commentedOut = SQLResultCache.Key(sql: "SELECT * FROM t -- x WHERE id = 1")
+        #expect(filtered != commentedOut)
+        #expect(filtered == SQLResultCache.Key(sql: "SELECT * FROM t WHERE id = 1"))
+        #expect(commentedOut == SQLResultCache.Key(sql: "SELECT * FROM t"))
+    }
+
+    @Test
+    func quotesInCommentsOpenNoLiteral() {
+        let a = SQLResultCache.Key(sql: "SELECT  Id -- don't\nFROM   t /* it's */ WHERE Code = 'U  S'")
+        let b = SQLResultCache.Key(sql: "SELECT Id FROM t WHERE Code = 'U  S'")
+        #expect(a == b)
+        #expect(SQLResultCache.Key(sql: "SELECT 1 /* a /* b */ 'c' */").sql == "SELECT 1")
+    }
+
+    @Test
+    func keysForDifferentDatabasesDiffer() {
+        let cache = SQLResultCache()
+        let sales = SQLResultCache.Key(sql: "SELECT * FROM Currency", scope: "db1/Sales")
+        let archive = SQLResultCache.Key(sql: "SELECT * FROM Currency", scope: "db1/Archive")
+        cache.insert(makeResult("sales"), forKey: sales)
+        #expect(sales != archive)
+        #expect(cache.value(forKey: archive) == nil)
+        #expect(cache.value(forKey: sales) != nil)
+    }
+
+    @Test
+    func hitAndMissAreCounted() {
+        let cache = SQLResultCache()
+        let key = SQLResultCache.Key(sql: "SELECT 1")
+        #expect(cache.value(forKey: key) == nil)
+        cache.insert(makeResult("a"), forKey: key)
+        #expect(cache.value(forKey: key)?[0, "Name"]?.string == "a")
+
+        let metrics = cache.metrics
+        #expect(metrics.hits == 1)
+        #expect(metrics.misses == 1)
+        #expect(metrics.entryCount == 1)
+        #expect(metrics.totalBytes > 0)
+    }
+
+    @Test
+    func expiredEntriesAreDropped() {
+        let cache = SQLResultCache()
+        let key = SQLResultCache.Key(sql: "SELECT 1")
+        cache.insert(makeResult("a"), forKey: key, ttl: .zero)
+        #expect(cache.value(forKey: key) == nil)
+        #expect(cache.metrics.expirations == 1)
+        #expect(cache.metrics.entryCount == 0)
+    }
+
+    @Test
+    func leastRecentlyUsedIsEvictedFirst() {
+        let one = makeResult("one")
+        let budget = one.estimatedByteCount * 2
+        let cache = SQLResultCache(maxBytes: budget)
+        let k1 = SQLResultCache.Key(sql: "SELECT 1")
+        let k2 = SQLResultCache.Key(sql: "SELECT 2")
+        let k3 = SQLResultCache.Key(sql: "SELECT 3")
+
+        cache.insert(one, forKey: k1)
+        cache.insert(makeResult("two"), forKey: k2)
+        _ = cache.value(forKey: k1)  // k2 is now least recently used
+        cache.insert(makeResult("six"), forKey: k3)
+
+        #expect(cache.value(forKey: k1) != nil)
+        #expect(cache.value(forKey: k2) == nil)
+        #expect(cache.value(forKey: k3) != nil)
+        #expect(cache.metrics.evictions == 1)
+        #expect(cache.metrics.totalBytes <= budget)
+    }
+
+    @Test
+    func oversizedResultsAreNotCached() {
+        let cache = SQLResultCache(maxBytes: 16)
+        let key = SQLResultCache.Key(sql: "SELECT 1")
+        cache.insert(makeResult("big", rows: 10), forKey: key)
+        #expect(cache.value(forKey: key) == nil)
+        #expect(cache.metrics.insertions == 0)
+    }
+
+    @Test
+    func invalidateByKeyAndTag() {
+        let cache = SQLResultCache()
+        let k1 = SQLResultCache.Key(sql: "SELECT * FROM Currency")
+        let k2 = SQLResultCache.Key(sql: "SELECT * FROM Config")
+        let k3 = SQLResultCache.Key(sql: "SELECT * FROM Config", parameters: ["eu"])
+        cache.insert(makeResult("c"), forKey: k1, tags: ["currency"])
+        cache.insert(makeResult("g"), forKey: k2, tags: ["config"])
+        cache.insert(makeResult("e"), forKey: k3, tags: ["config"])
+
+        cache.invalidate(key: k1)
+        #expect(cache.value(forKey: k1) == nil)
+
+        cache.invalidate(tag: "config")
+        #expect(cache.value(forKey: k2) == nil)
+        #expect(cache.value(forKey: k3) == nil)
+        #expect(cache.metrics.invalidations == 3)
+        #expect(cache.metrics.entryCount == 0)
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  ServerMessageRingTests.swift
+//  FreeTDSKit
+//
+
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Server Message Ring Tests") struct ServerMessageRingTests {
+
+    private static func message(_ n: Int) -> ServerMessage {
+        ServerMessage(number: 50_000, severity: 0, state: 1, procedure: nil, line: n, text: "step \(n)")
+    }
+
+    @Test
+    func deliversInOrderUntilFinished() async {
+        let ring = ServerMessageRing()
+        let messages = ServerMessages(ring: ring)
+        var iterator = messages.makeAsyncIterator()
+        for n in 1...3 { ring.push(Self.message(n)) }
+        ring.finish()
+
+        var lines: [Int] = []
+        while let message = await iterator.next() {
+            lines.append(message.line)
+        }
+        #expect(lines == [1, 2, 3])
+    }
+
+    @Test
+    func wakesParkedConsumer() async {
+        let ring = ServerMessageRing()
+        let consumer = Task {
+            var texts: [String] = []
+            for await message in ServerMessages(ring: ring) {
+                texts.append(message.text)
+            }
+            return texts
+        }
+        while !ring.isListening { await Task.yield() }
+        for n in 1...100 {
+            ring.push(Self.message(n))
+            if n % 10 == 0 { try? await Task.sleep(for: .milliseconds(1)) }
+        }
+        ring.finish()
+        let texts = await consumer.value
+        #expect(texts.count + ring.droppedCount == 100)
+        #expect(texts.first == "step 1")
+    }
+
+    @Test
+    func dropsWhenFullAndWithoutListener() async {
+        let ring = ServerMessageRing()
+        ring.push(Self.message(0))
+        let messages = ServerMessages(ring: ring)
+        var iterator = messages.makeAsyncIterator()
+        for n in 1...(ServerMessageRing.capacity + 5) { ring.push(Self.message(n)) }
+        ring.finish()
+
+        var count = 0
+        while let message = await iterator.next() {
+            count += 1
+            #expect(message.line != 0)
+        }
+        #expect(count == ServerMessageRing.capacity)
+        #expect(messages.droppedCount == 5)
+    }
+
+    @Test
+    func onlyOneIteratorAtATime() async {
+        let ring = ServerMessageRing()
+        let messages = ServerMessages(ring: ring)
+        var first = messages.makeAsyncIterator()
+        var second = messages.makeAsyncIterator()
+        ring.push(Self.message(1))
+        ring.finish()
+        #expect(await second.next() == nil)
+        #expect(await first.next()?.line == 1)
+    }
+
+    @Test
+    func cancellationEndsIteration() async {
+        let ring = ServerMessageRing()
+        let consumer = Task {
+            var iterator = ServerMessages(ring: ring).makeAsyncIterator()
+            return await iterator.next()
+        }
+        while !ring.isListening { await Task.yield() }
+        consumer.cancel()
+        #expect(await consumer.value == nil)
+    }
+}
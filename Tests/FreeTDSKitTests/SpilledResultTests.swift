@@ -0,0 +1,81 @@
+//
+//  SpilledResultTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Spilled Result Tests") struct SpilledResultTests {
+
+    private static let columns = ["Id", "Name", "Amount", "Note"]
+
+    private static func row(_ i: Int) -> [String: SQLDataType] {
+        var row: [String: SQLDataType] = [
+            "Id": .integer(i),
+            "Name": .nvarchar("row \(i) ✓"),
+            "Amount": .money(Decimal(i) / 100),
+        ]
+        // Every third row has a NULL note, every fifth none at all.
+        if i % 5 != 0 { row["Note"] = i % 3 == 0 ? .null : .varbinary(Data([UInt8(i & 0xFF)])) }
+        return row
+    }
+
+    private static func spilledResult(stored: Int, spilled: Int) throws -> SQLResult {
+        let writer = try SpillFileWriter(directory: FileManager.default.temporaryDirectory, columns: columns)
+        for i in stored..<(stored + spilled) {
+            try writer.append(row(i))
+        }
+        return SQLResult(
+            columns: columns,
+            storedRows: (0..<stored).map(row),
+            spilledRows: try writer.finish(),
+            affectedRows: stored + spilled
+        )
+    }
+
+    @Test
+    func subscriptsReachSpilledRows() throws {
+        let result = try Self.spilledResult(stored: 10, spilled: 500)
+        #expect(result.isSpilled)
+        #expect(result.count == 510)
+        #expect(result[9, "Id"]?.int == 9)
+        #expect(result[10, "Id"]?.int == 10)
+        #expect(result[137, "Name"]?.string == "row 137 ✓")
+        #expect(result[137, column: 2]?.decimal == Decimal(137) / 100)
+        #expect(result[509, "Id"]?.int == 509)
+        #expect(result[510, "Id"] == nil)
+        #expect(result[-1, "Id"] == nil)
+        #expect(result[0, "Missing"] == nil)
+    }
+
+    @Test
+    func nullAndMissingCellsSurvive() throws {
+        let result = try Self.spilledResult(stored: 0, spilled: 100)
+        guard case .null = result[33, "Note"] else {
+            Issue.record("Expected SQLDataType.null")
+            return
+        }
+        #expect(result[35, "Note"] == nil)
+        #expect(result[34, "Note"]?.binary == Data([34]))
+    }
+
+    @Test
+    func iterationCoversStoredAndSpilledRows() throws {
+        let result = try Self.spilledResult(stored: 7, spilled: 300)
+        let ids = result.compactMap { $0["Id"]?.int }
+        #expect(ids == Array(0..<307))
+        #expect(result.rows.count == 307)
+        #expect(result.rows[200]["Name"]?.string == "row 200 ✓")
+    }
+
+    @Test
+    func emptySpillFile() throws {
+        let result = try Self.spilledResult(stored: 3, spilled: 0)
+        #expect(result.count == 3)
+        #expect(Array(result).count == 3)
+        #expect(result[3, "Id"] == nil)
+    }
+}
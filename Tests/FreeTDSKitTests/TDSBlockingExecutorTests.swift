@@ -0,0 +1,42 @@
+//
+//  TDSBlockingExecutorTests.swift
+//  FreeTDSKit
+//
+
+import Foundation
+import Testing
+
+@testable import FreeTDSKit
+
+private func currentThreadName() -> String? {
+    Thread.current.name
+}
+
+@Suite("Blocking Executor Tests") struct TDSBlockingExecutorTests {
+
+    @Test
+    func tasksRunOnPoolThreads() async {
+        let executor = TDSBlockingExecutor(threadCount: 2, name: "test.blocking")
+        let name = await Task.detached(executorPreference: executor) {
+            currentThreadName()
+        }.value
+        #expect(name?.hasPrefix("test.blocking.") == true)
+    }
+
+    @Test
+    func blockingWorkDoesNotExceedThreadCount() async {
+        let executor = TDSBlockingExecutor(threadCount: 2)
+        let clock = ContinuousClock()
+        let elapsed = await clock.measure {
+            await withTaskGroup(of: Void.self) { group in
+                for _ in 0..<4 {
+                    group.addTask(executorPreference: executor) {
+                        usleep(100_000)
+                    }
+                }
+            }
+        }
+        // Four 100ms blocking jobs on two threads need at least two rounds.
+        #expect(elapsed >= .milliseconds(200))
+    }
+}
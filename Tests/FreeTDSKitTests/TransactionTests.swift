@@ -0,0 +1,30 @@
+//
+//  TransactionTests.swift
+//  FreeTDSKit
+//
+
+import Testing
+
+@testable import FreeTDSKit
+
+@Suite("Transaction Tests") struct TransactionTests {
+
+    @Test
+    func savepointNamesAreBracketQuoted() {
+        #expect(TDSTransaction.quote("before_update") == "[before_update]")
+        #expect(TDSTransaction.quote("odd]name") == "[odd]]name]")
+    }
+
+    @Test
+    func isolationLevelsUseServerSyntax() {
+        #expect(TransactionIsolation.repeatableRead.rawValue == "REPEATABLE READ")
+        #expect(TransactionIsolation.snapshot.rawValue == "SNAPSHOT")
+    }
+
+    @Test
+    func sessionLevelsMapToIsolation() {
+        #expect(TransactionIsolation(sessionLevel: 2) == .readCommitted)
+        #expect(TransactionIsolation(sessionLevel: 5) == .snapshot)
+        #expect(TransactionIsolation(sessionLevel: 0) == nil)
+    }
+}